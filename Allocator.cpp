@@ -1,20 +1,54 @@
 #include "Allocator.h"
 #include "BuiltinManager.h"
+#include "Config.h"
+#include "GcThreadPool.h"
+#include <chrono>
+
+// gray objects of the current thread while marking in parallel
+thread_local GcMarkWorker *g_MarkWorker = nullptr;
 void Allocator::Init()
 {
-    m_FirstObject = nullptr;
     m_CurObjCount = 0;
-    m_MaxObjCount = STACK_COUNT;
+    m_HeapBytes = 0;
+    m_NextGcHeapBytes = Config::GetInstance()->GetGcMinHeapBytes();
+    m_YoungObjCount = 0;
+    m_YoungBytes = 0;
+    m_RememberedObjects.clear();
+    m_YoungStrings.clear();
+    m_IsMajorGcRequested = false;
+    m_GrayObjects.clear();
+    m_GcPhase = GcPhase::IDLE;
+    ResetGcCursor();
+    m_GcStats = GcStats();
+
+    m_OpenUpvalues = nullptr;
+    memset(m_OpenUpvalueSlots, 0, sizeof(UpvalueObject *) * STACK_COUNT);
 
     memset(m_ValueStack, 0, sizeof(Value) * STACK_COUNT);
     memset(m_CallFrameStack, 0, sizeof(CallFrame) * STACK_COUNT);
 
+    if (!m_StackRefPage)
+        m_StackRefPage = ObjectPool::AllocateUnmanagedPage(sizeof(RefObject));
+
     ResetStatus();
 }
 
 void Allocator::Destroy()
 {
+    const auto &statsPath = Config::GetInstance()->GetGcStatsPath();
+    if (!statsPath.empty())
+        WriteFile(statsPath, m_GcStats.ToJson());
+
     Gc(true);
+    GcThreadPool::GetInstance()->Destroy();
+    m_MarkWorkers.clear();
+    ObjectPool::GetInstance()->Destroy();
+
+    if (m_StackRefPage)
+    {
+        ObjectPool::FreeUnmanagedPage(m_StackRefPage);
+        m_StackRefPage = nullptr;
+    }
 }
 
 Allocator *Allocator::GetInstance()
@@ -27,9 +61,11 @@ void Allocator::ResetStatus()
 {
     m_StackTop = m_ValueStack;
     m_CallFrameTop = m_CallFrameStack;
+    m_StackRefCount = 0;
+    m_StackRefOverflowCount = 0;
 }
 
-RefObject *Allocator::AllocateIndexRefObject(Value *ptr, const Value &idxValue)
+static Value *GetIndexRefPointer(Value *ptr, const Value &idxValue)
 {
     if (IS_ARRAY_VALUE(*ptr))
     {
@@ -38,12 +74,123 @@ RefObject *Allocator::AllocateIndexRefObject(Value *ptr, const Value &idxValue)
         auto intIdx = TO_NUM_VALUE(idxValue);
         if (intIdx < 0 || intIdx >= TO_ARRAY_VALUE(*ptr)->len)
             ASSERT("Idx out of range.");
-        return ALLOCATE_OBJECT(RefObject, &(TO_ARRAY_VALUE(*ptr)->elements[(uint64_t)intIdx]));
+        return &(TO_ARRAY_VALUE(*ptr)->elements[(uint64_t)intIdx]);
     }
     else
         ASSERT("Invalid indexed reference type: %s not a array value.", ptr->Stringify().c_str());
 }
 
+static char *CopyChars(const char *chars, size_t len)
+{
+    char *result = new char[len + 1];
+    memcpy(result, chars, len);
+    result[len] = '\0';
+    return result;
+}
+
+StrObject *Allocator::AllocateStrObject(const char *chars, size_t len)
+{
+    return NewScriptStrObject(InternChars(chars, len));
+}
+
+StrObject *Allocator::TakeStrObject(char *chars, size_t len)
+{
+    return NewScriptStrObject(TakeInternedStrObject(chars, len));
+}
+
+StrObject *Allocator::TakeInternedStrObject(char *chars, size_t len)
+{
+    uint32_t hash = HashString(chars, len);
+    auto interned = FindInternedStrObject(chars, len, hash);
+    if (interned)
+    {
+        SAFE_DELETE_ARRAY(chars);
+        return interned;
+    }
+    return NewStrObject(m_Strings, chars, len, hash);
+}
+
+StrObject *Allocator::InternChars(const char *chars, size_t len)
+{
+    uint32_t hash = HashString(chars, len);
+    auto interned = FindInternedStrObject(chars, len, hash);
+    if (interned)
+        return interned;
+    return NewStrObject(m_Strings, CopyChars(chars, len), len, hash);
+}
+
+StrObject *Allocator::NewScriptStrObject(StrObject *interned)
+{
+    // nothing refers to a new interned string yet,it stays on the stack while the script string is allocated
+    Push(interned);
+    auto str = AllocateObject<StrObject>(interned);
+    Pop();
+    return str;
+}
+
+StrObject *Allocator::AllocateNameStrObject(const char *chars, size_t len)
+{
+    uint32_t hash = HashString(chars, len);
+    auto str = m_Names.FindString(chars, len, hash);
+    if (str)
+        return str;
+
+    return NewStrObject(m_Names, CopyChars(chars, len), len, hash);
+}
+
+StrObject *Allocator::NewStrObject(HashTable &table, char *chars, size_t len, uint32_t hash)
+{
+    auto str = AllocateObject<StrObject>(chars, len, hash);
+    table.Set(str, Value());
+    if (&table == &m_Strings)
+        m_YoungStrings.emplace_back(str);
+    return str;
+}
+
+StrObject *Allocator::FindInternedStrObject(const char *chars, size_t len, uint32_t hash)
+{
+    auto str = m_Strings.FindString(chars, len, hash);
+    // the table does not keep its strings alive,a white string found while marking is shaded before it is used again
+    if (str && m_GcPhase == GcPhase::MARK)
+        MarkObject(str);
+    return str;
+}
+
+void Allocator::RemoveUnmarkedYoungStrings()
+{
+    for (StrObject *str : m_YoungStrings)
+    {
+        // the end of an incremental marking may have removed the string already,an equal string interned since then must stay
+        if (!ObjectPool::IsMarked(str) && m_Strings.FindString(str->value, str->len, str->hash) == str)
+            m_Strings.Delete(str);
+    }
+    m_YoungStrings.clear();
+}
+
+RefObject *Allocator::AllocateIndexRefObject(Value *ptr, const Value &idxValue)
+{
+    return ALLOCATE_OBJECT(RefObject, GetIndexRefPointer(ptr, idxValue));
+}
+
+RefObject *Allocator::AllocateStackIndexRefObject(Value *ptr, const Value &idxValue)
+{
+    return AllocateStackRefObject(GetIndexRefPointer(ptr, idxValue));
+}
+
+ClosureObject *Allocator::AllocateClosureObject(FunctionObject *fn, UpvalueObject *const *upvalues, uint8_t upvalueCount)
+{
+    static_assert(sizeof(ClosureObject) + UPVALUE_COUNT * sizeof(UpvalueObject *) <= POOL_MAX_OBJECT_SIZE, "a closure with all upvalues must fit into an object pool slot");
+    return AllocateObjectWithTail<ClosureObject>(upvalueCount * sizeof(UpvalueObject *), fn, upvalues, upvalueCount);
+}
+
+StructObject *Allocator::AllocateStructObject(Shape *shape, const Value *fieldValues)
+{
+    auto fieldBytes = shape->GetFieldCount() * sizeof(Value);
+    if (sizeof(StructObject) + fieldBytes <= POOL_MAX_OBJECT_SIZE)
+        return AllocateObjectWithTail<StructObject>(fieldBytes, shape, fieldValues, true);
+    return AllocateObject<StructObject>(shape, fieldValues, false);
+}
+
 void Allocator::Push(const Value &value)
 {
 #ifndef NDEBUG
@@ -100,6 +247,11 @@ void Allocator::StackTopJump(size_t slotCount)
 UpvalueObject *Allocator::CaptureUpvalue(int16_t index, int16_t scopeDepth)
 {
     Value* local = (m_CallFrameStack + scopeDepth)->slot + index;
+    UpvalueObject *&openUpvalue = m_OpenUpvalueSlots[local - m_ValueStack];
+    if (openUpvalue != nullptr)
+        return openUpvalue;
+
+    // a new upvalue is usually captured from the top frame,so the walk stops early
     UpvalueObject *prevUpvalue = nullptr;
     UpvalueObject *upvalue = m_OpenUpvalues;
     while (upvalue != nullptr && upvalue->location > local)
@@ -108,9 +260,6 @@ UpvalueObject *Allocator::CaptureUpvalue(int16_t index, int16_t scopeDepth)
         upvalue = upvalue->nextUpvalue;
     }
 
-    if (upvalue != nullptr && upvalue->location == local)
-        return upvalue;
-
     auto createdUpvalue = ALLOCATE_OBJECT(UpvalueObject, local);
     createdUpvalue->nextUpvalue = upvalue;
 
@@ -119,6 +268,7 @@ UpvalueObject *Allocator::CaptureUpvalue(int16_t index, int16_t scopeDepth)
     else
         prevUpvalue->nextUpvalue = createdUpvalue;
 
+    openUpvalue = createdUpvalue;
     return createdUpvalue;
 }
 void Allocator::ClosedUpvalues(Value *last)
@@ -126,8 +276,10 @@ void Allocator::ClosedUpvalues(Value *last)
     while (m_OpenUpvalues != nullptr && m_OpenUpvalues->location >= last)
     {
         UpvalueObject *upvalue = m_OpenUpvalues;
+        m_OpenUpvalueSlots[upvalue->location - m_ValueStack] = nullptr;
         upvalue->closed = *upvalue->location;
         upvalue->location = &upvalue->closed;
+        WriteBarrier(upvalue, upvalue->closed);
         m_OpenUpvalues = upvalue->nextUpvalue;
     }
 }
@@ -152,59 +304,576 @@ void Allocator::EnableGC()
     m_IsGCEnabled = true;
 }
 
+void Allocator::AdjustObjectBytes(Object *owner, ptrdiff_t delta)
+{
+    size_t &bytes = ObjectPool::IsOld(owner) ? m_HeapBytes : m_YoungBytes;
+    if (delta < 0 && bytes < (size_t)-delta)
+        bytes = 0;
+    else
+        bytes += delta;
+}
+
+void Allocator::RequestMajorGc()
+{
+    m_IsMajorGcRequested = true;
+}
+
+void Allocator::PushGrayObject(Object *object)
+{
+    if (g_MarkWorker)
+        g_MarkWorker->grayObjects.emplace_back(object);
+    else
+        m_GrayObjects.emplace_back(object);
+}
+
+void Allocator::Barrier(Object *object)
+{
+    if (m_GcPhase == GcPhase::MARK)
+        MarkObject(object);
+    else
+        Remember(object);
+}
+
+void Allocator::Remember(Object *object)
+{
+    if (object->remembered)
+        return;
+    object->remembered = true;
+    m_RememberedObjects.emplace_back(object);
+}
+
+bool Allocator::IsRootSlot(Value *slot) const
+{
+    return (slot >= m_ValueStack && slot < m_ValueStack + STACK_COUNT) ||
+           (slot >= m_GlobalVariables && slot < m_GlobalVariables + STACK_COUNT);
+}
+
+void Allocator::MarkRoots()
+{
+    // mark all object which in stack and in context
+    for (Value *slot = m_ValueStack; slot < m_StackTop; ++slot)
+        slot->Mark();
+    for (Value &g : m_GlobalVariables)
+        g.Mark();
+    for (CallFrame *slot = m_CallFrameStack; slot < m_CallFrameTop; ++slot)
+        MarkObject(slot->closure);
+    for (UpvalueObject *upvalue = m_OpenUpvalues; upvalue != nullptr; upvalue = upvalue->nextUpvalue)
+        MarkObject(upvalue);
+
+    BuiltinManager::GetInstance()->GetBuiltinObjectTable().Mark();
+    m_Names.Mark();
+}
+
+size_t Allocator::TraceGrayObjects(size_t budget)
+{
+    size_t work = 0;
+    while (!m_GrayObjects.empty() && work < budget)
+    {
+        Object *object = m_GrayObjects.back();
+        m_GrayObjects.pop_back();
+        work += BlackenObject(object);
+    }
+    return work;
+}
+
+void Allocator::ParallelTraceGrayObjects(uint32_t threadCount)
+{
+    while (m_MarkWorkers.size() < threadCount)
+        m_MarkWorkers.emplace_back(std::make_unique<GcMarkWorker>());
+
+    // deal the roots out to the threads
+    for (size_t i = 0; i < m_GrayObjects.size(); ++i)
+        m_MarkWorkers[i % threadCount]->grayObjects.emplace_back(m_GrayObjects[i]);
+    m_GrayObjects.clear();
+
+    m_MarkThreadCount = threadCount;
+    m_IdleMarkThreadCount = 0;
+    m_IsParallelMarking = true;
+
+    GcThreadPool::GetInstance()->Run(threadCount, [this](uint32_t index)
+                                     { MarkWorkerLoop(index); });
+
+    m_IsParallelMarking = false;
+}
+
+void Allocator::MarkWorkerLoop(uint32_t index)
+{
+    GcMarkWorker *worker = m_MarkWorkers[index].get();
+    g_MarkWorker = worker;
+
+    while (true)
+    {
+        while (!worker->grayObjects.empty())
+        {
+            Object *object = worker->grayObjects.back();
+            worker->grayObjects.pop_back();
+            BlackenObject(object);
+
+            if (worker->grayObjects.size() >= GC_MARK_SHARE_COUNT && !worker->hasSharedObjects.load(std::memory_order_relaxed))
+                ShareGrayObjects(worker);
+        }
+
+        if (StealGrayObjects(index))
+            continue;
+
+        // marking is finished once all threads are idle,
+        // an idle thread only leaves the idle count to steal,so no gray object is left at that point
+        m_IdleMarkThreadCount.fetch_add(1);
+        bool isFinished = false;
+        while (true)
+        {
+            if (m_IdleMarkThreadCount.load() == m_MarkThreadCount)
+            {
+                isFinished = true;
+                break;
+            }
+
+            bool hasSharedObjects = false;
+            for (uint32_t i = 0; i < m_MarkThreadCount; ++i)
+                hasSharedObjects |= m_MarkWorkers[i]->hasSharedObjects.load(std::memory_order_relaxed);
+
+            if (hasSharedObjects)
+            {
+                m_IdleMarkThreadCount.fetch_sub(1);
+                if (StealGrayObjects(index))
+                    break;
+                m_IdleMarkThreadCount.fetch_add(1);
+            }
+
+            std::this_thread::yield();
+        }
+
+        if (isFinished)
+            break;
+    }
+
+    g_MarkWorker = nullptr;
+}
+
+void Allocator::ShareGrayObjects(GcMarkWorker *worker)
+{
+    std::lock_guard<std::mutex> lock(worker->sharedMutex);
+    if (!worker->sharedObjects.empty())
+        return;
+
+    // share the oldest half,the newest gray objects are the hottest in cache
+    auto half = worker->grayObjects.begin() + worker->grayObjects.size() / 2;
+    worker->sharedObjects.assign(worker->grayObjects.begin(), half);
+    worker->grayObjects.erase(worker->grayObjects.begin(), half);
+    worker->hasSharedObjects.store(true, std::memory_order_relaxed);
+}
+
+bool Allocator::StealGrayObjects(uint32_t index)
+{
+    GcMarkWorker *worker = m_MarkWorkers[index].get();
+
+    // take back the own shared objects first
+    for (uint32_t i = 0; i < m_MarkThreadCount; ++i)
+    {
+        GcMarkWorker *victim = m_MarkWorkers[(index + i) % m_MarkThreadCount].get();
+        if (!victim->hasSharedObjects.load(std::memory_order_relaxed))
+            continue;
+
+        std::lock_guard<std::mutex> lock(victim->sharedMutex);
+        if (victim->sharedObjects.empty())
+            continue;
+
+        worker->grayObjects.insert(worker->grayObjects.end(), victim->sharedObjects.begin(), victim->sharedObjects.end());
+        victim->sharedObjects.clear();
+        victim->hasSharedObjects.store(false, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void Allocator::ParallelSweepPages(uint32_t threadCount)
+{
+    auto pool = ObjectPool::GetInstance();
+    for (uint32_t i = 0; i < POOL_SIZE_CLASS_COUNT; ++i)
+        for (PoolPage *page = pool->GetPages(i); page; page = page->next)
+            m_SweepPages.emplace_back(page);
+
+    std::atomic<size_t> nextChunk{0};
+    std::atomic<size_t> freedCount{0};
+    std::atomic<size_t> freedBytes{0};
+    GcThreadPool::GetInstance()->Run(threadCount, [&](uint32_t)
+                                     {
+        size_t begin = 0;
+        size_t threadFreedCount = 0;
+        size_t threadFreedBytes = 0;
+        while ((begin = nextChunk.fetch_add(GC_SWEEP_CHUNK_COUNT)) < m_SweepPages.size())
+        {
+            size_t end = std::min(begin + GC_SWEEP_CHUNK_COUNT, m_SweepPages.size());
+            for (size_t i = begin; i < end; ++i)
+                threadFreedCount += SweepOldObjects(m_SweepPages[i], threadFreedBytes, true);
+        }
+        freedCount.fetch_add(threadFreedCount);
+        freedBytes.fetch_add(threadFreedBytes); });
+
+    for (Object *object : m_DeadObjects)
+        DeleteObject(object);
+
+    m_CurObjCount -= freedCount.load();
+    m_HeapBytes = m_HeapBytes > freedBytes.load() ? m_HeapBytes - freedBytes.load() : 0;
+
+    m_SweepPages.clear();
+    m_DeadObjects.clear();
+}
+
+size_t Allocator::SweepOldObjects(PoolPage *page, size_t &freedBytes, bool isParallel)
+{
+    size_t freedCount = 0;
+    for (size_t i = 0; i < POOL_BITMAP_WORD_COUNT; ++i)
+    {
+        uint64_t unreached = page->oldBits[i] & ~page->markBits[i];
+        if (unreached == 0)
+            continue;
+
+        page->oldBits[i] &= ~unreached;
+        ObjectPool::ForEachSlot(page, i, unreached, [&](void *slot)
+                                {
+            auto object = static_cast<Object *>(slot);
+            freedBytes += ObjectBytes(object);
+            freedCount++;
+
+            if (!isParallel)
+                DeleteObject(object);
+            else if (object->type == ObjectType::BUILTIN)
+            {
+                std::lock_guard<std::mutex> lock(m_DeadObjectMutex);
+                m_DeadObjects.emplace_back(object);
+            }
+            else
+            {
+                // the object pool is not thread safe,only the page of this thread is touched
+                DestroyObject(object);
+                ObjectPool::FreeSlot(page, object);
+            } });
+    }
+    return freedCount;
+}
+
+void Allocator::SweepYoungObjects()
+{
+    PoolPage *page = ObjectPool::GetInstance()->TakeYoungPages();
+    while (page)
+    {
+        PoolPage *next = page->nextYoung;
+        page->nextYoung = nullptr;
+        page->hasYoungObjects = false;
+
+        for (size_t i = 0; i < POOL_BITMAP_WORD_COUNT; ++i)
+        {
+            uint64_t young = page->youngBits[i];
+            if (young == 0)
+                continue;
+
+            // the survivors are promoted to the old generation with their mark bit kept
+            uint64_t promoted = young & page->markBits[i];
+            page->youngBits[i] = 0;
+            page->oldBits[i] |= promoted;
+
+            ObjectPool::ForEachSlot(page, i, promoted, [this](void *slot)
+                                    {
+                m_CurObjCount++;
+                m_HeapBytes += ObjectBytes(static_cast<Object *>(slot)); });
+            ObjectPool::ForEachSlot(page, i, young & ~promoted, [](void *slot)
+                                    { DeleteObject(static_cast<Object *>(slot)); });
+        }
+        page = next;
+    }
+
+    m_YoungObjCount = 0;
+    m_YoungBytes = 0;
+}
+
+PoolPage *Allocator::NextGcPage()
+{
+    auto pool = ObjectPool::GetInstance();
+    while (m_GcCursorPage == nullptr && m_GcCursorSizeClass < POOL_SIZE_CLASS_COUNT)
+        m_GcCursorPage = pool->GetPages(m_GcCursorSizeClass++);
+
+    PoolPage *page = m_GcCursorPage;
+    if (page)
+        m_GcCursorPage = page->next;
+    return page;
+}
+
+void Allocator::ResetGcCursor()
+{
+    m_GcCursorSizeClass = 0;
+    m_GcCursorPage = nullptr;
+}
+
+const GcStats &Allocator::GetGcStats() const
+{
+    return m_GcStats;
+}
+
+void Allocator::RecordGcEvent(const GcEvent &event)
+{
+    m_GcStats.RecordCollection(event);
+
+    if (Config::GetInstance()->IsGcLog())
+        std::cerr << "[gc] " << GcKindToString(event.kind) << ":collected " << event.freedObjectCount << " objects(" << event.freedBytes << " bytes) in "
+                  << event.pauseMs << "ms," << event.heapObjectCount << " objects(" << event.heapBytes << " bytes) remaining." << std::endl;
+}
+
 void Allocator::Gc(bool deleteAll)
 {
-    auto objNum = m_CurObjCount;
-    if (!deleteAll)
-    {
-        // mark all object which in stack and in context
-        for (Value *slot = m_ValueStack; slot < m_StackTop; ++slot)
-            slot->Mark();
-        for (Value &g : m_GlobalVariables)
-            g.Mark();
-        for (CallFrame *slot = m_CallFrameStack; slot < m_CallFrameTop; ++slot)
-            MarkObject(slot->closure);
-        for (UpvalueObject *upvalue = m_OpenUpvalues; upvalue != nullptr; upvalue = upvalue->nextUpvalue)
-            MarkObject(upvalue);
-      
-        BuiltinManager::GetInstance()->GetBuiltinObjectTable().Mark();
+    auto startTime = std::chrono::steady_clock::now();
+    auto objNum = m_CurObjCount + m_YoungObjCount;
+    auto bytes = m_HeapBytes + m_YoungBytes;
+    auto pool = ObjectPool::GetInstance();
+
+    if (deleteAll)
+    {
+        // delete all objects while exiting vm
+        for (uint32_t i = 0; i < POOL_SIZE_CLASS_COUNT; ++i)
+        {
+            for (PoolPage *page = pool->GetPages(i); page; page = page->next)
+            {
+                for (size_t j = 0; j < POOL_BITMAP_WORD_COUNT; ++j)
+                    ObjectPool::ForEachSlot(page, j, page->oldBits[j] | page->youngBits[j], [](void *slot)
+                                            { DeleteObject(static_cast<Object *>(slot)); });
+            }
+        }
+        for (PoolPage *page = pool->TakeYoungPages(); page; page = page->nextYoung)
+            page->hasYoungObjects = false;
+
+        m_CurObjCount = 0;
+        m_YoungObjCount = 0;
+        m_HeapBytes = 0;
+        m_YoungBytes = 0;
+        m_RememberedObjects.clear();
+        m_YoungStrings.clear();
+        m_IsMajorGcRequested = false;
+        m_GrayObjects.clear();
+        m_GcPhase = GcPhase::IDLE;
+        ResetGcCursor();
+        m_Strings.Clear();
+        m_Names.Clear();
+
+        if (Config::GetInstance()->IsGcLog())
+            std::cerr << "[gc] exit:collected " << objNum << " objects(" << bytes << " bytes)." << std::endl;
+        return;
+    }
+
+    // a minor collection only marks and sweeps young objects,
+    // old objects keep their mark bit so the marking stops at them.
+    // while the old generation is swept incrementally only minor collections run
+    bool isMajor = m_GcPhase != GcPhase::SWEEP && (m_IsMajorGcRequested || m_HeapBytes >= m_NextGcHeapBytes);
+
+    // the major collection is spread over the following allocations,a minor collection empties the young generation first.
+    // stores of jit compiled code bypass the write barrier,so a requested major collection stays stop-the-world
+    bool isIncremental = isMajor && !m_IsMajorGcRequested && Config::GetInstance()->IsIncrementalGc();
+    if (isIncremental)
+        isMajor = false;
+
+    if (isMajor)
+        pool->ClearMarks();
+
+    MarkRoots();
+
+    // young objects stored into old objects since the last collection
+    for (Object *object : m_RememberedObjects)
+    {
+        object->remembered = false;
+        if (!isMajor)
+            MarkObject(object);
+    }
+    m_RememberedObjects.clear();
+
+    uint32_t threadCount = Config::GetInstance()->GetGcThreadCount();
+    bool isParallel = isMajor && threadCount > 1 && m_CurObjCount >= GC_PARALLEL_MIN_OBJECT_COUNT;
+
+    if (isParallel)
+        ParallelTraceGrayObjects(threadCount);
+    else
+        TraceGrayObjects(SIZE_MAX);
+
+    // old strings keep their mark in a minor collection,only the young ones can be unmarked
+    if (isMajor)
+    {
+        m_Strings.RemoveUnmarkedKeys();
+        m_YoungStrings.clear();
     }
     else
+        RemoveUnmarkedYoungStrings();
+
+    if (isParallel)
+        ParallelSweepPages(threadCount);
+    else if (isMajor)
+    {
+        size_t freedBytes = 0;
+        for (uint32_t i = 0; i < POOL_SIZE_CLASS_COUNT; ++i)
+            for (PoolPage *page = pool->GetPages(i); page; page = page->next)
+                m_CurObjCount -= SweepOldObjects(page, freedBytes, false);
+        m_HeapBytes = m_HeapBytes > freedBytes ? m_HeapBytes - freedBytes : 0;
+    }
+
+    SweepYoungObjects();
+
+    // the incremental sweep walks the page lists,pages are released once it finished
+    if (m_GcPhase == GcPhase::IDLE)
+        pool->ReleaseEmptyPages();
+
+    if (isMajor)
     {
-        // unMark all objects while exiting vm
-        for (Value &slot : m_ValueStack)
-            slot.UnMark();
-        for (Value &g : m_GlobalVariables)
-            g.UnMark();
-        for (CallFrame &slot : m_CallFrameStack)
-            UnMarkObject(slot.closure);
-        for (UpvalueObject *upvalue = m_OpenUpvalues; upvalue != nullptr; upvalue = upvalue->nextUpvalue)
-            UnMarkObject(upvalue);
+        UpdateGcThreshold();
+        m_IsMajorGcRequested = false;
+    }
+
+    GcEvent event;
+    event.kind = isMajor ? GcKind::MAJOR : GcKind::MINOR;
+    event.pauseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    event.freedObjectCount = objNum - m_CurObjCount;
+    event.freedBytes = bytes > m_HeapBytes ? bytes - m_HeapBytes : 0;
+    event.heapObjectCount = m_CurObjCount;
+    event.heapBytes = m_HeapBytes;
+    m_GcStats.RecordPause(event.pauseMs);
+    RecordGcEvent(event);
 
-         BuiltinManager::GetInstance()->GetBuiltinObjectTable().UnMark();
+    if (isIncremental)
+    {
+        m_GcPhase = GcPhase::CLEAR;
+        ResetGcCursor();
+        m_GcCycleFreedCount = 0;
+        m_GcCycleFreedBytes = 0;
+        m_GcCycleMaxPauseMs = 0.0;
     }
+}
 
-    // sweep objects which is not reachable
-    Object **object = &m_FirstObject;
-    while (*object)
+void Allocator::GcStep()
+{
+    auto startTime = std::chrono::steady_clock::now();
+    size_t budget = Config::GetInstance()->GetGcStepBudget();
+    size_t work = 0;
+
+    // young objects allocated during the collection stay white in the young generation,
+    // minor collections are suspended until the marking finishes.
+    // clearing or sweeping a page costs one unit of work per bitmap word and per deleted object
+    while (work < budget && m_GcPhase != GcPhase::IDLE)
     {
-        if (!(*object)->marked)
+        switch (m_GcPhase)
+        {
+        case GcPhase::CLEAR:
         {
-            Object *unreached = *object;
-            *object = unreached->next;
+            PoolPage *page = nullptr;
+            while (work < budget && (page = NextGcPage()))
+            {
+                memset(page->markBits, 0, sizeof(page->markBits));
+                work += POOL_BITMAP_WORD_COUNT;
+            }
 
-            DeleteObject(unreached);
+            if (page == nullptr)
+            {
+                // objects remembered so far are reached again from the roots
+                for (Object *object : m_RememberedObjects)
+                    object->remembered = false;
+                m_RememberedObjects.clear();
 
-            m_CurObjCount--;
+                m_GcPhase = GcPhase::MARK;
+                MarkRoots();
+            }
+            break;
         }
-        else
+        case GcPhase::MARK:
         {
-            (*object)->marked = false;
-            object = &(*object)->next;
+            work += TraceGrayObjects(budget - work);
+            if (m_GrayObjects.empty())
+                FinishMark();
+            break;
         }
+        case GcPhase::SWEEP:
+        {
+            PoolPage *page = nullptr;
+            while (work < budget && (page = NextGcPage()))
+            {
+                size_t freedBytes = 0;
+                size_t freedCount = SweepOldObjects(page, freedBytes, false);
+
+                m_HeapBytes = m_HeapBytes > freedBytes ? m_HeapBytes - freedBytes : 0;
+                m_CurObjCount -= freedCount;
+                m_GcCycleFreedCount += freedCount;
+                m_GcCycleFreedBytes += freedBytes;
+                work += POOL_BITMAP_WORD_COUNT + freedCount;
+            }
+
+            if (page == nullptr)
+                FinishCycle();
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    auto pauseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    m_GcStats.incrementalStepCount++;
+    m_GcStats.RecordPause(pauseMs);
+    if (pauseMs > m_GcCycleMaxPauseMs)
+        m_GcCycleMaxPauseMs = pauseMs;
+
+    if (m_GcPhase == GcPhase::IDLE)
+    {
+        GcEvent event;
+        event.kind = GcKind::INCREMENTAL;
+        event.pauseMs = m_GcCycleMaxPauseMs;
+        event.freedObjectCount = m_GcCycleFreedCount;
+        event.freedBytes = m_GcCycleFreedBytes;
+        event.heapObjectCount = m_CurObjCount;
+        event.heapBytes = m_HeapBytes;
+        RecordGcEvent(event);
+    }
+}
+
+void Allocator::FinishMark()
+{
+    // stores of jit compiled code during the collection bypassed the write barrier,mark everything again
+    if (m_IsMajorGcRequested)
+    {
+        ObjectPool::GetInstance()->ClearMarks();
+        m_IsMajorGcRequested = false;
     }
 
-    m_MaxObjCount = m_CurObjCount == 0 ? STACK_COUNT : m_CurObjCount * 2;
+    // stack and global slots have no write barrier,rescan them atomically
+    MarkRoots();
+    TraceGrayObjects(SIZE_MAX);
 
-    std::cout << "Collected " << objNum - m_CurObjCount << " objects," << m_CurObjCount << " remaining." << std::endl;
-}
\ No newline at end of file
+    m_Strings.RemoveUnmarkedKeys();
+
+    for (Object *object : m_RememberedObjects)
+        object->remembered = false;
+    m_RememberedObjects.clear();
+
+    m_GcPhase = GcPhase::SWEEP;
+    ResetGcCursor();
+}
+
+void Allocator::UpdateGcThreshold()
+{
+    auto config = Config::GetInstance();
+
+    size_t maxHeapBytes = config->GetGcMaxHeapBytes();
+    if (maxHeapBytes != 0 && m_HeapBytes > maxHeapBytes)
+        ASSERT("Out of memory:%zu bytes are reachable after a major collection,the heap is capped at %zu bytes.", m_HeapBytes, maxHeapBytes);
+
+    auto nextGcHeapBytes = (size_t)((double)m_HeapBytes * config->GetGcGrowthFactor());
+    if (nextGcHeapBytes < config->GetGcMinHeapBytes())
+        nextGcHeapBytes = config->GetGcMinHeapBytes();
+    if (maxHeapBytes != 0 && nextGcHeapBytes > maxHeapBytes)
+        nextGcHeapBytes = maxHeapBytes;
+
+    m_NextGcHeapBytes = nextGcHeapBytes;
+}
+
+void Allocator::FinishCycle()
+{
+    m_GcPhase = GcPhase::IDLE;
+    ResetGcCursor();
+
+    ObjectPool::GetInstance()->ReleaseEmptyPages();
+
+    UpdateGcThreshold();
+}
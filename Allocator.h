@@ -2,6 +2,11 @@
 #include "Utils.h"
 #include "Value.h"
 #include "Object.h"
+#include "ObjectPool.h"
+#include "GcStats.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 struct CallFrame
 {
@@ -17,18 +22,41 @@ struct CallFrame
 #endif
     }
 
-    bool IsEnd()
-    {
-        if ((ip - closure->function->chunk.opCodeList.data()) < closure->function->chunk.opCodeList.size())
-            return false;
-        return true;
-    }
-
     ClosureObject *closure{nullptr};
-    int16_t *ip{nullptr};
+    uint8_t *ip{nullptr};
     Value *slot{nullptr};
 };
 
+// a minor collection runs once this many bytes were allocated since the last collection
+constexpr size_t NURSERY_BYTES = 512 * 1024;
+
+// a major collection marks and deletes objects on several threads once the old generation has this many objects
+constexpr size_t GC_PARALLEL_MIN_OBJECT_COUNT = 16 * 1024;
+// a marking thread shares half of its gray objects once it has this many
+constexpr size_t GC_MARK_SHARE_COUNT = 64;
+// pages swept by one thread at a time
+constexpr size_t GC_SWEEP_CHUNK_COUNT = 16;
+
+// gray objects of one parallel marking thread,
+// other threads steal the shared half when they run out of gray objects
+struct GcMarkWorker
+{
+    std::vector<Object *> grayObjects;
+
+    std::mutex sharedMutex;
+    std::vector<Object *> sharedObjects;
+    std::atomic<bool> hasSharedObjects{false};
+};
+
+// phases of an incremental major collection,each allocation advances the collection by one step
+enum class GcPhase
+{
+    IDLE,
+    CLEAR, // clear the mark bitmaps page by page
+    MARK,  // blacken gray objects
+    SWEEP, // delete unmarked old objects page by page
+};
+
 template <typename T>
 concept IsChildOfObject = !std::is_same_v<T, void> &&
                           !std::is_abstract_v<T> &&
@@ -46,19 +74,99 @@ public:
     template <IsChildOfObject T, typename... Args>
     T *AllocateObject(Args &&...params)
     {
-        if (m_CurObjCount >= m_MaxObjCount && m_IsGCEnabled)
-            Gc();
+        static_assert(sizeof(T) <= POOL_MAX_OBJECT_SIZE, "gc objects must fit into an object pool slot");
+        return AllocateObjectWithTail<T>(0, std::forward<Args>(params)...);
+    }
+
+    // the object is followed by tailBytes bytes of its own in the same pool slot
+    template <IsChildOfObject T, typename... Args>
+    T *AllocateObjectWithTail(size_t tailBytes, Args &&...params)
+    {
+        if (m_IsGCEnabled)
+        {
+            if (m_GcPhase != GcPhase::IDLE)
+                GcStep();
 
-        T *object = new T(std::forward<Args>(params)...);
+            // the marks are complete while sweeping,so minor collections can run again
+            if (m_YoungBytes >= NURSERY_BYTES && (m_GcPhase == GcPhase::IDLE || m_GcPhase == GcPhase::SWEEP))
+                Gc();
+        }
 
-        object->marked = false;
-        object->next = m_FirstObject;
-        m_FirstObject = object;
-        m_CurObjCount++;
+        // every object lives in a pool page,its gc state is kept in the side bitmaps of the page
+        T *object = new (ObjectPool::GetInstance()->Allocate(sizeof(T) + tailBytes)) T(std::forward<Args>(params)...);
+
+        m_YoungObjCount++;
+        m_YoungBytes += ObjectBytes(object);
         return object;
     }
 
+    // a buffer owned by the object was resized after the object was allocated
+    void AdjustObjectBytes(Object *owner, ptrdiff_t delta);
+
+    // a young object stored into an old object is remembered,
+    // minor collections mark the remembered objects as roots.
+    // while an incremental collection is marking,a white object stored into a black object is shaded gray instead
+    void WriteBarrier(Object *owner, const Value &value)
+    {
+        if (ObjectPool::IsMarked(owner) && IS_OBJECT_VALUE(value) && !ObjectPool::IsMarked(TO_OBJECT_VALUE(value)))
+            Barrier(TO_OBJECT_VALUE(value));
+    }
+
+    // the owner of the slot is unknown(e.g. a write through a ref),only stack and global slots are skipped
+    void WriteBarrier(Value *slot, const Value &value)
+    {
+        if (IS_OBJECT_VALUE(value) && !ObjectPool::IsMarked(TO_OBJECT_VALUE(value)) && !IsRootSlot(slot))
+            Barrier(TO_OBJECT_VALUE(value));
+    }
+
+    void PushGrayObject(Object *object);
+
+    // mark bits are set atomically while the helper threads mark
+    bool IsParallelMarking() const { return m_IsParallelMarking; }
+
+    const GcStats &GetGcStats() const;
+
+    // stores that bypass the write barrier(jit compiled code) make the next collection a major one
+    void RequestMajorGc();
+
     RefObject *AllocateIndexRefObject(Value *ptr, const Value &idxValue);
+    // the upvalues are captured beforehand,so the gc never sees a closure with unset upvalues
+    ClosureObject *AllocateClosureObject(FunctionObject *fn, UpvalueObject *const *upvalues, uint8_t upvalueCount);
+    // the instance and its fields share one pool slot unless the shape has too many fields for it
+    StructObject *AllocateStructObject(Shape *shape, const Value *fieldValues);
+
+    // the characters of strings are interned in a weak table,equal strings share them.
+    // returns a new script string with the content,the interned string is created if there is none
+    StrObject *AllocateStrObject(const char *chars, size_t len);
+    // member and builtin names are interned apart from the script strings,
+    // they are never collected,so a name is the same object for the lifetime of the vm
+    StrObject *AllocateNameStrObject(const char *chars, size_t len);
+    // like AllocateStrObject but takes the ownership of chars,they are deleted if an equal string is interned already
+    StrObject *TakeStrObject(char *chars, size_t len);
+    // like TakeStrObject but returns the interned string itself,insert/erase point a script string to it
+    StrObject *TakeInternedStrObject(char *chars, size_t len);
+
+    // refs that do not escape the call they are passed to live on a stack outside of the gc heap,
+    // they are released in reverse order once the call returns.
+    // a full stack falls back to gc allocated refs
+    RefObject *AllocateStackRefObject(Value *pointer)
+    {
+        if (m_StackRefCount == m_StackRefPage->slotCount)
+        {
+            m_StackRefOverflowCount++;
+            return AllocateObject<RefObject>(pointer);
+        }
+        return new (m_StackRefPage->slots + (size_t)m_StackRefCount++ * sizeof(RefObject)) RefObject(pointer);
+    }
+    RefObject *AllocateStackIndexRefObject(Value *ptr, const Value &idxValue);
+    void ReleaseStackRefObjects(uint8_t count)
+    {
+        // the overflowed refs were allocated last
+        for (; count > 0 && m_StackRefOverflowCount > 0; --count)
+            m_StackRefOverflowCount--;
+        m_StackRefCount -= count;
+    }
+    bool IsStackRefObject(const RefObject *ref) const { return ObjectPool::GetPage(ref) == m_StackRefPage; }
 
     void Push(const Value &value);
     Value Pop();
@@ -90,6 +198,46 @@ private:
 
     void Gc(bool deleteAll = false);
 
+    // incremental major collection
+    void GcStep();
+    void FinishMark();
+    void FinishCycle();
+
+    void RecordGcEvent(const GcEvent &event);
+
+    // sets the heap size of the next major collection from the live bytes
+    void UpdateGcThreshold();
+
+    void MarkRoots();
+    // blacken gray objects until the gray list is empty or the budget is used up,returns the work done
+    size_t TraceGrayObjects(size_t budget);
+
+    // parallel major collection
+    void ParallelTraceGrayObjects(uint32_t threadCount);
+    void MarkWorkerLoop(uint32_t index);
+    void ShareGrayObjects(GcMarkWorker *worker);
+    bool StealGrayObjects(uint32_t index);
+    void ParallelSweepPages(uint32_t threadCount);
+
+    // deletes the unmarked old objects of the page,returns the number of deleted objects
+    size_t SweepOldObjects(PoolPage *page, size_t &freedBytes, bool isParallel);
+    // deletes the unmarked young objects,the marked ones are promoted to the old generation
+    void SweepYoungObjects();
+
+    // next page to clear or sweep,nullptr once all pages were visited
+    PoolPage *NextGcPage();
+    void ResetGcCursor();
+
+    StrObject *NewStrObject(HashTable &table, char *chars, size_t len, uint32_t hash);
+    StrObject *InternChars(const char *chars, size_t len);
+    StrObject *NewScriptStrObject(StrObject *interned);
+    StrObject *FindInternedStrObject(const char *chars, size_t len, uint32_t hash);
+    void RemoveUnmarkedYoungStrings();
+
+    void Barrier(Object *object);
+    void Remember(Object *object);
+    bool IsRootSlot(Value *slot) const;
+
     bool m_IsGCEnabled{true};
 
     Value m_GlobalVariables[STACK_COUNT];
@@ -97,18 +245,75 @@ private:
     Value *m_StackTop{nullptr};
     Value m_ValueStack[STACK_COUNT]{};
 
+    // open upvalues sorted by stack slot from the top down
     UpvalueObject *m_OpenUpvalues{nullptr};
 
     CallFrame *m_CallFrameTop{nullptr};
     CallFrame m_CallFrameStack[STACK_COUNT]{};
 
-    Object *m_FirstObject{nullptr};
+    // old generation,a major collection runs once it holds m_NextGcHeapBytes bytes
     size_t m_CurObjCount{0};
-    size_t m_MaxObjCount{0};
+    size_t m_HeapBytes{0};
+    size_t m_NextGcHeapBytes{0};
+
+    // young generation,objects allocated since the last collection
+    size_t m_YoungObjCount{0};
+    size_t m_YoungBytes{0};
+
+    std::vector<Object *> m_RememberedObjects;
+    bool m_IsMajorGcRequested{false};
+
+    // marked objects whose references are not marked yet
+    std::vector<Object *> m_GrayObjects;
+
+    GcPhase m_GcPhase{GcPhase::IDLE};
+    // next page to clear or sweep,pages allocated during the collection hold no unmarked old object and are skipped
+    uint32_t m_GcCursorSizeClass{0};
+    PoolPage *m_GcCursorPage{nullptr};
+    // old objects deleted by the incremental collection
+    size_t m_GcCycleFreedCount{0};
+    size_t m_GcCycleFreedBytes{0};
+    double m_GcCycleMaxPauseMs{0.0};
+
+    GcStats m_GcStats;
+
+    // the interned strings,unmarked ones are removed between marking and sweeping
+    HashTable m_Strings;
+    // strings interned since the last collection,the only ones a minor collection can remove
+    std::vector<StrObject *> m_YoungStrings;
+    HashTable m_Names;
+
+    std::vector<std::unique_ptr<GcMarkWorker>> m_MarkWorkers;
+    uint32_t m_MarkThreadCount{0};
+    std::atomic<uint32_t> m_IdleMarkThreadCount{0};
+    bool m_IsParallelMarking{false};
+
+    // pages swept in chunks by the helper threads
+    std::vector<PoolPage *> m_SweepPages;
+    // native data is released by a callback of its library,unreached builtin objects are deleted on the main thread
+    std::mutex m_DeadObjectMutex;
+    std::vector<Object *> m_DeadObjects;
+
+    PoolPage *m_StackRefPage{nullptr};
+    uint32_t m_StackRefCount{0};
+    // stack refs that did not fit into m_StackRefPage
+    uint32_t m_StackRefOverflowCount{0};
+
+    // the open upvalue of each stack slot,capturing a slot again needs no walk of m_OpenUpvalues
+    UpvalueObject *m_OpenUpvalueSlots[STACK_COUNT]{};
 };
 
 #define ALLOCATE_OBJECT(type, ...) (Allocator::GetInstance()->AllocateObject<type>(__VA_ARGS__))
+#define ALLOCATE_STR_OBJECT(str) (Allocator::GetInstance()->AllocateStrObject(str, strlen(str)))
+#define TAKE_STR_OBJECT(chars, len) (Allocator::GetInstance()->TakeStrObject(chars, len))
+#define ALLOCATE_NAME_STR_OBJECT(str) (Allocator::GetInstance()->AllocateNameStrObject(str, strlen(str)))
 #define ALLOCATE_INDEX_REF_OBJECT(ptr, idxValue) (Allocator::GetInstance()->AllocateIndexRefObject(ptr, idxValue))
+#define ALLOCATE_CLOSURE_OBJECT(fn, upvalues, upvalueCount) (Allocator::GetInstance()->AllocateClosureObject(fn, upvalues, upvalueCount))
+#define ALLOCATE_STRUCT_OBJECT(shape, fieldValues) (Allocator::GetInstance()->AllocateStructObject(shape, fieldValues))
+#define ALLOCATE_STACK_REF_OBJECT(ptr) (Allocator::GetInstance()->AllocateStackRefObject(ptr))
+#define ALLOCATE_STACK_INDEX_REF_OBJECT(ptr, idxValue) (Allocator::GetInstance()->AllocateStackIndexRefObject(ptr, idxValue))
+#define RELEASE_STACK_REF_OBJECTS(count) (Allocator::GetInstance()->ReleaseStackRefObjects(count))
+#define IS_STACK_REF_OBJECT(ref) (Allocator::GetInstance()->IsStackRefObject(ref))
 
 #define GET_GLOBAL_VARIABLE_SLOT(x) (Allocator::GetInstance()->GetGlobalVariableSlot(x))
 
@@ -55,11 +55,15 @@ struct NumExpr : public Expr
 {
 	NumExpr() : Expr(AstType::NUM), value(0.0) {}
 	NumExpr(double value) : Expr(AstType::NUM), value(value) {}
+	NumExpr(int64_t integer) : Expr(AstType::NUM), value((double)integer), integer(integer), isInteger(true) {}
 	~NumExpr() override = default;
 
-	std::string Stringify() override { return std::to_string(value); }
+	std::string Stringify() override { return isInteger ? std::to_string(integer) : std::to_string(value); }
 
 	double value;
+	// integer literals(no '.') and folded integer arithmetic,value always mirrors it as double
+	int64_t integer{0};
+	bool isInteger{false};
 };
 
 struct StrExpr : public Expr
@@ -40,8 +40,10 @@ namespace
             result = TO_ARRAY_VALUE(args[0])->len;
         else if (IS_STR_VALUE(args[0]))
             result = TO_STR_VALUE(args[0])->len;
+        else if (IS_STR_BUILDER_VALUE(args[0]))
+            result = TO_STR_BUILDER_VALUE(args[0])->len;
         else
-            ASSERT("[Native function 'sizeof']:Expect a array or string argument.");
+            ASSERT("[Native function 'sizeof']:Expect a array,string or string builder argument.");
         return true;
     }
 
@@ -62,6 +64,7 @@ namespace
                 ASSERT("[Native function 'insert']:Index out of array's range");
 
             ArrayInsert(array, iIndex, args[2]);
+            Allocator::GetInstance()->WriteBarrier(array, args[2]);
         }
         else if (IS_STR_VALUE(args[0]))
         {
@@ -75,8 +78,20 @@ namespace
 
             StrInsert(TO_STR_VALUE(args[0]), iIndex, TO_STR_VALUE(args[2]));
         }
+        else if (IS_STR_BUILDER_VALUE(args[0]))
+        {
+            if (!IS_NUM_VALUE(args[1]) || !IS_STR_VALUE(args[2]))
+                ASSERT("[Native function 'insert']:Arg1 must be integer type and arg2 must be a string while insert to a string builder");
+
+            size_t iIndex = (size_t)TO_NUM_VALUE(args[1]);
+
+            if (iIndex < 0 || iIndex > TO_STR_BUILDER_VALUE(args[0])->len)
+                ASSERT("[Native function 'insert']:Index out of string builder's range");
+
+            StrBuilderInsert(TO_STR_BUILDER_VALUE(args[0]), iIndex, TO_STR_VALUE(args[2])->value, TO_STR_VALUE(args[2])->len);
+        }
         else
-            ASSERT("[Native function 'insert']:Expect a array or string argument.");
+            ASSERT("[Native function 'insert']:Expect a array,string or string builder argument.");
 
         return false;
     }
@@ -119,7 +134,82 @@ namespace
 
     extern "C" COMPUTEDUCK_API bool BUILTIN_FN(clock)(Value *args, uint8_t argCount, Value &result)
     {
-        result = clock() / CLOCKS_PER_SEC;
+        result = (double)clock() / CLOCKS_PER_SEC;
+        return true;
+    }
+
+    extern "C" COMPUTEDUCK_API bool BUILTIN_FN(dispose)(Value *args, uint8_t argCount, Value &result)
+    {
+        if (!IS_BUILTIN_VALUE(args[0]) || !TO_BUILTIN_VALUE(args[0])->Is<NativeData>())
+            ASSERT("[Native function 'dispose']:Expect a native resource,like the return value of SDL_LoadBMP.");
+
+        TO_BUILTIN_VALUE(args[0])->Dispose();
+        return false;
+    }
+
+    extern "C" COMPUTEDUCK_API bool BUILTIN_FN(strbuilder)(Value *args, uint8_t argCount, Value &result)
+    {
+        result = ALLOCATE_OBJECT(StrBuilderObject);
+        return true;
+    }
+
+    extern "C" COMPUTEDUCK_API bool BUILTIN_FN(append)(Value *args, uint8_t argCount, Value &result)
+    {
+        if (!IS_STR_BUILDER_VALUE(args[0]))
+            ASSERT("[Native function 'append']:Expect a string builder as arg0,like the return value of strbuilder().");
+
+        if (IS_STR_VALUE(args[1]))
+            StrBuilderAppend(TO_STR_BUILDER_VALUE(args[0]), TO_STR_VALUE(args[1])->value, TO_STR_VALUE(args[1])->len);
+        else
+        {
+            // other values are appended as they are printed,the text is copied first since it may be the builder itself
+            auto str = args[1].Stringify();
+            StrBuilderAppend(TO_STR_BUILDER_VALUE(args[0]), str.c_str(), str.size());
+        }
+        return false;
+    }
+
+    extern "C" COMPUTEDUCK_API bool BUILTIN_FN(tostring)(Value *args, uint8_t argCount, Value &result)
+    {
+        if (IS_STR_VALUE(args[0]))
+            result = args[0];
+        else if (IS_STR_BUILDER_VALUE(args[0]))
+            result = StrBuilderToString(TO_STR_BUILDER_VALUE(args[0]));
+        else
+        {
+            auto str = args[0].Stringify();
+            result = Allocator::GetInstance()->AllocateStrObject(str.c_str(), str.size());
+        }
+        return true;
+    }
+
+    extern "C" COMPUTEDUCK_API bool BUILTIN_FN(gcstats)(Value *args, uint8_t argCount, Value &result)
+    {
+        const auto &stats = Allocator::GetInstance()->GetGcStats();
+
+        // the keys and the histogram are not reachable from any root until the struct is returned
+        Allocator::GetInstance()->DisableGC();
+
+        Value *buckets = new Value[GC_PAUSE_BUCKET_COUNT];
+        for (uint32_t i = 0; i < GC_PAUSE_BUCKET_COUNT; ++i)
+            buckets[i] = stats.pauseHistogram[i];
+
+        HashTable *members = new HashTable();
+        members->Set(ALLOCATE_NAME_STR_OBJECT("minorCount"), stats.minorCount);
+        members->Set(ALLOCATE_NAME_STR_OBJECT("majorCount"), stats.majorCount);
+        members->Set(ALLOCATE_NAME_STR_OBJECT("incrementalCount"), stats.incrementalCount);
+        members->Set(ALLOCATE_NAME_STR_OBJECT("incrementalStepCount"), stats.incrementalStepCount);
+        members->Set(ALLOCATE_NAME_STR_OBJECT("pauseCount"), stats.pauseCount);
+        members->Set(ALLOCATE_NAME_STR_OBJECT("totalPauseMs"), stats.totalPauseMs);
+        members->Set(ALLOCATE_NAME_STR_OBJECT("maxPauseMs"), stats.maxPauseMs);
+        members->Set(ALLOCATE_NAME_STR_OBJECT("pauseHistogram"), ALLOCATE_OBJECT(ArrayObject, buckets, GC_PAUSE_BUCKET_COUNT));
+        members->Set(ALLOCATE_NAME_STR_OBJECT("freedObjectCount"), stats.freedObjectCount);
+        members->Set(ALLOCATE_NAME_STR_OBJECT("freedBytes"), stats.freedBytes);
+        members->Set(ALLOCATE_NAME_STR_OBJECT("heapObjectCount"), stats.heapObjectCount);
+        members->Set(ALLOCATE_NAME_STR_OBJECT("heapBytes"), stats.heapBytes);
+        result = ALLOCATE_OBJECT(StructObject, members);
+
+        Allocator::GetInstance()->EnableGC();
         return true;
     }
 }
@@ -136,10 +226,15 @@ void BuiltinManager::Init()
 
     REGISTER_BUILTIN_FN(print);
     REGISTER_BUILTIN_FN(println);
-    REGISTER_BUILTIN_FN(sizeof);
-    REGISTER_BUILTIN_FN(insert);
-    REGISTER_BUILTIN_FN(erase);
-    REGISTER_BUILTIN_FN(clock);
+    REGISTER_BUILTIN_FN_WITH_ARITY(sizeof, 1);
+    REGISTER_BUILTIN_FN_WITH_ARITY(insert, 3);
+    REGISTER_BUILTIN_FN_WITH_ARITY(erase, 2);
+    REGISTER_BUILTIN_FN_WITH_ARITY(clock, 0);
+    REGISTER_BUILTIN_FN_WITH_ARITY(dispose, 1);
+    REGISTER_BUILTIN_FN_WITH_ARITY(gcstats, 0);
+    REGISTER_BUILTIN_FN_WITH_ARITY(strbuilder, 0);
+    REGISTER_BUILTIN_FN_WITH_ARITY(append, 2);
+    REGISTER_BUILTIN_FN_WITH_ARITY(tostring, 1);
 
     Allocator::GetInstance()->EnableGC();
 }
@@ -152,6 +247,19 @@ BuiltinObject *BuiltinManager::FindBuiltinObject(StrObject* name)
     return TO_BUILTIN_VALUE(*value);
 }
 
+int32_t BuiltinManager::FindBuiltinIndex(StrObject *name)
+{
+    auto value = m_BuiltinIndexTable.Get(name);
+    if (!value)
+        return -1;
+    return static_cast<int32_t>(TO_NUM_VALUE(*value));
+}
+
+StrObject *BuiltinManager::GetBuiltinName(uint32_t index)
+{
+    return m_BuiltinNameList[index];
+}
+
 HashTable& BuiltinManager::GetBuiltinObjectTable()
 {
     return m_BuiltinObjectsTable;
@@ -14,17 +14,28 @@ public:
 
     void Init();
 
-    template <typename T>
-        requires(std::is_same_v<T, BuiltinFn> || std::is_same_v<T, Value>)
-    void Register(StrObject *name, const T &v)
+    template <typename... Args>
+    void Register(StrObject *name, Args &&...args)
     {
         auto isFound = m_BuiltinObjectsTable.Find(name);
         if (isFound)
             ASSERT("Redefined builtin:%s", ObjectStringify(name).c_str());
-        m_BuiltinObjectsTable.Set(name, ALLOCATE_OBJECT(BuiltinObject, v));
+        auto builtinObj = ALLOCATE_OBJECT(BuiltinObject, std::forward<Args>(args)...);
+        m_BuiltinObjectsTable.Set(name, builtinObj);
+        m_BuiltinIndexTable.Set(name, Value(m_BuiltinObjectList.size()));
+        m_BuiltinObjectList.emplace_back(builtinObj);
+        m_BuiltinNameList.emplace_back(name);
     }
 
     BuiltinObject *FindBuiltinObject(StrObject *name);
+    // index of the builtin in the dense builtin list,-1 if no builtin has the name(yet)
+    int32_t FindBuiltinIndex(StrObject *name);
+
+    BuiltinObject *GetBuiltinObject(uint32_t index)
+    {
+        return m_BuiltinObjectList[index];
+    }
+    StrObject *GetBuiltinName(uint32_t index);
 
     HashTable &GetBuiltinObjectTable();
 
@@ -33,4 +44,10 @@ private:
     ~BuiltinManager() = default;
 
     HashTable m_BuiltinObjectsTable;
+
+    // builtins in registration order,entries are only ever appended(dllimport registers more at runtime),
+    // so an index resolved once stays valid for the lifetime of the vm
+    HashTable m_BuiltinIndexTable;
+    std::vector<BuiltinObject *> m_BuiltinObjectList;
+    std::vector<StrObject *> m_BuiltinNameList;
 };
\ No newline at end of file
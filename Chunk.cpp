@@ -1,7 +1,317 @@
 #include "Chunk.h"
 #include "Object.h"
+#include "BuiltinManager.h"
 #include <format>
 #include <sstream>
+uint8_t GetGenericOpCode(uint8_t opcode)
+{
+    switch (opcode)
+    {
+    case OP_ADD_NUM:
+        return OP_ADD;
+    case OP_SUB_NUM:
+        return OP_SUB;
+    case OP_MUL_NUM:
+        return OP_MUL;
+    case OP_DIV_NUM:
+        return OP_DIV;
+    case OP_GREATER_NUM:
+        return OP_GREATER;
+    case OP_LESS_NUM:
+        return OP_LESS;
+    case OP_EQUAL_NUM:
+        return OP_EQUAL;
+    case OP_INC_LOCAL_NUM:
+        return OP_INC_LOCAL;
+    case OP_INC_GLOBAL_NUM:
+        return OP_INC_GLOBAL;
+    case OP_JUMP_IF_LESS_NUM:
+        return OP_JUMP_IF_LESS;
+    case OP_JUMP_IF_GREATER_NUM:
+        return OP_JUMP_IF_GREATER;
+    case OP_JUMP_IF_EQUAL_NUM:
+        return OP_JUMP_IF_EQUAL;
+    case OP_JUMP_IF_NOT_LESS_NUM:
+        return OP_JUMP_IF_NOT_LESS;
+    case OP_JUMP_IF_NOT_GREATER_NUM:
+        return OP_JUMP_IF_NOT_GREATER;
+    case OP_JUMP_IF_NOT_EQUAL_NUM:
+        return OP_JUMP_IF_NOT_EQUAL;
+    case OP_R_ADD_NUM:
+        return OP_R_ADD;
+    case OP_R_SUB_NUM:
+        return OP_R_SUB;
+    case OP_R_MUL_NUM:
+        return OP_R_MUL;
+    case OP_R_DIV_NUM:
+        return OP_R_DIV;
+    case OP_R_GREATER_NUM:
+        return OP_R_GREATER;
+    case OP_R_LESS_NUM:
+        return OP_R_LESS;
+    case OP_R_EQUAL_NUM:
+        return OP_R_EQUAL;
+    case OP_R_ADD_CONSTANT_NUM:
+        return OP_R_ADD_CONSTANT;
+    case OP_R_SUB_CONSTANT_NUM:
+        return OP_R_SUB_CONSTANT;
+    case OP_R_MUL_CONSTANT_NUM:
+        return OP_R_MUL_CONSTANT;
+    case OP_R_INC_LOCAL_NUM:
+        return OP_R_INC_LOCAL;
+    case OP_R_INC_GLOBAL_NUM:
+        return OP_R_INC_GLOBAL;
+    case OP_R_JUMP_IF_LESS_NUM:
+        return OP_R_JUMP_IF_LESS;
+    case OP_R_JUMP_IF_GREATER_NUM:
+        return OP_R_JUMP_IF_GREATER;
+    case OP_R_JUMP_IF_EQUAL_NUM:
+        return OP_R_JUMP_IF_EQUAL;
+    case OP_R_JUMP_IF_NOT_LESS_NUM:
+        return OP_R_JUMP_IF_NOT_LESS;
+    case OP_R_JUMP_IF_NOT_GREATER_NUM:
+        return OP_R_JUMP_IF_NOT_GREATER;
+    case OP_R_JUMP_IF_NOT_EQUAL_NUM:
+        return OP_R_JUMP_IF_NOT_EQUAL;
+    case OP_R_JUMP_IF_LESS_CONSTANT_NUM:
+        return OP_R_JUMP_IF_LESS_CONSTANT;
+    case OP_R_JUMP_IF_GREATER_CONSTANT_NUM:
+        return OP_R_JUMP_IF_GREATER_CONSTANT;
+    case OP_R_JUMP_IF_EQUAL_CONSTANT_NUM:
+        return OP_R_JUMP_IF_EQUAL_CONSTANT;
+    case OP_R_JUMP_IF_NOT_LESS_CONSTANT_NUM:
+        return OP_R_JUMP_IF_NOT_LESS_CONSTANT;
+    case OP_R_JUMP_IF_NOT_GREATER_CONSTANT_NUM:
+        return OP_R_JUMP_IF_NOT_GREATER_CONSTANT;
+    case OP_R_JUMP_IF_NOT_EQUAL_CONSTANT_NUM:
+        return OP_R_JUMP_IF_NOT_EQUAL_CONSTANT;
+    default:
+        return opcode;
+    }
+}
+
+uint32_t GetInstructionLength(const uint8_t *ip)
+{
+    switch (GetGenericOpCode(*ip))
+    {
+    case OP_ADD:
+    case OP_SUB:
+    case OP_MUL:
+    case OP_DIV:
+    case OP_EQUAL:
+    case OP_GREATER:
+    case OP_LESS:
+    case OP_NOT:
+    case OP_MINUS:
+    case OP_AND:
+    case OP_OR:
+    case OP_BIT_AND:
+    case OP_BIT_OR:
+    case OP_BIT_NOT:
+    case OP_BIT_XOR:
+    case OP_GET_INDEX:
+    case OP_SET_INDEX:
+    case OP_DLL_IMPORT:
+#ifdef COMPUTEDUCK_BUILD_WITH_LLVM
+    case OP_JUMP_END:
+#endif
+        return 1;
+    case OP_RETURN:
+    case OP_DEF_GLOBAL:
+    case OP_SET_GLOBAL:
+    case OP_GET_GLOBAL:
+    case OP_DEF_LOCAL:
+    case OP_SET_LOCAL:
+    case OP_GET_LOCAL:
+    case OP_GET_UPVALUE:
+    case OP_SET_UPVALUE:
+    case OP_FUNCTION_CALL:
+    case OP_TAIL_CALL:
+    case OP_REF_GLOBAL:
+    case OP_REF_LOCAL:
+    case OP_REF_UPVALUE:
+    case OP_REF_INDEX_GLOBAL:
+    case OP_REF_INDEX_LOCAL:
+    case OP_REF_INDEX_UPVALUE:
+    case OP_STACK_REF_GLOBAL:
+    case OP_STACK_REF_LOCAL:
+    case OP_STACK_REF_UPVALUE:
+    case OP_STACK_REF_INDEX_GLOBAL:
+    case OP_STACK_REF_INDEX_LOCAL:
+    case OP_STACK_REF_INDEX_UPVALUE:
+    case OP_STACK_REF_CALL:
+    case OP_RELEASE_STACK_REFS:
+    case OP_CONCAT:
+#ifdef COMPUTEDUCK_BUILD_WITH_LLVM
+    case OP_JUMP_START:
+#endif
+        return 1 + sizeof(uint8_t);
+    case OP_CONSTANT:
+    case OP_ARRAY:
+    case OP_GET_BUILTIN:
+    case OP_STRUCT:
+    case OP_NEW_STRUCT:
+    case OP_GET_STRUCT:
+    case OP_SET_STRUCT:
+    case OP_GET_BUILTIN_INDEX:
+        return 1 + sizeof(uint16_t);
+    case OP_JUMP:
+    case OP_JUMP_IF_FALSE:
+    case OP_JUMP_IF_LESS:
+    case OP_JUMP_IF_GREATER:
+    case OP_JUMP_IF_EQUAL:
+    case OP_JUMP_IF_NOT_LESS:
+    case OP_JUMP_IF_NOT_GREATER:
+    case OP_JUMP_IF_NOT_EQUAL:
+#ifdef COMPUTEDUCK_BUILD_WITH_LLVM
+        return 1 + sizeof(int32_t) + sizeof(uint8_t);
+#else
+        return 1 + sizeof(int32_t);
+#endif
+    case OP_CLOSURE:
+        return 1 + sizeof(uint16_t) + sizeof(uint8_t) + 2 * ip[1 + sizeof(uint16_t)];
+    case OP_INC_LOCAL:
+    case OP_INC_GLOBAL:
+        return 1 + sizeof(uint8_t) + sizeof(uint16_t);
+    case OP_R_NOT:
+    case OP_R_MINUS:
+    case OP_R_BIT_NOT:
+    case OP_R_MOVE:
+    case OP_R_DEF_GLOBAL:
+    case OP_R_SET_GLOBAL:
+    case OP_R_GET_GLOBAL:
+    case OP_R_SET_LOCAL:
+    case OP_R_GET_UPVALUE:
+    case OP_R_SET_UPVALUE:
+    case OP_R_FUNCTION_CALL:
+    case OP_R_TAIL_CALL:
+    case OP_R_STACK_REF_CALL:
+    case OP_R_RETURN:
+    case OP_R_REF_GLOBAL:
+    case OP_R_REF_LOCAL:
+    case OP_R_REF_UPVALUE:
+    case OP_R_STACK_REF_GLOBAL:
+    case OP_R_STACK_REF_LOCAL:
+    case OP_R_STACK_REF_UPVALUE:
+        return 1 + 2 * sizeof(uint8_t);
+    case OP_R_ADD:
+    case OP_R_SUB:
+    case OP_R_MUL:
+    case OP_R_DIV:
+    case OP_R_EQUAL:
+    case OP_R_GREATER:
+    case OP_R_LESS:
+    case OP_R_AND:
+    case OP_R_OR:
+    case OP_R_BIT_AND:
+    case OP_R_BIT_OR:
+    case OP_R_BIT_XOR:
+    case OP_R_GET_INDEX:
+    case OP_R_SET_INDEX:
+    case OP_R_REF_INDEX_GLOBAL:
+    case OP_R_REF_INDEX_LOCAL:
+    case OP_R_REF_INDEX_UPVALUE:
+    case OP_R_STACK_REF_INDEX_GLOBAL:
+    case OP_R_STACK_REF_INDEX_LOCAL:
+    case OP_R_STACK_REF_INDEX_UPVALUE:
+    case OP_R_RELEASE_STACK_REFS:
+    case OP_R_CONCAT:
+        return 1 + 3 * sizeof(uint8_t);
+    case OP_R_DLL_IMPORT:
+        return 1 + sizeof(uint16_t);
+    case OP_R_CONSTANT:
+    case OP_R_GET_BUILTIN:
+    case OP_R_NEW_STRUCT:
+    case OP_R_GET_BUILTIN_INDEX:
+    case OP_R_INC_LOCAL:
+    case OP_R_INC_GLOBAL:
+        return 1 + sizeof(uint8_t) + sizeof(uint16_t);
+    case OP_R_ADD_CONSTANT:
+    case OP_R_SUB_CONSTANT:
+    case OP_R_MUL_CONSTANT:
+    case OP_R_ARRAY:
+        return 1 + 2 * sizeof(uint8_t) + sizeof(uint16_t);
+    case OP_R_GET_STRUCT:
+    case OP_R_SET_STRUCT:
+        return 1 + 2 * sizeof(uint8_t) + 2 * sizeof(uint16_t);
+    case OP_R_CLOSURE:
+        return 1 + sizeof(uint8_t) + sizeof(uint16_t) + sizeof(uint8_t) + 2 * ip[1 + sizeof(uint8_t) + sizeof(uint16_t)];
+    case OP_R_STRUCT:
+        return 1 + 2 * sizeof(uint8_t) + sizeof(uint16_t) + sizeof(uint16_t) * DecodeOperand<uint16_t>(ip + 1 + 2 * sizeof(uint8_t));
+    case OP_R_JUMP:
+    case OP_R_JUMP_IF_FALSE:
+    case OP_R_JUMP_IF_LESS:
+    case OP_R_JUMP_IF_GREATER:
+    case OP_R_JUMP_IF_EQUAL:
+    case OP_R_JUMP_IF_NOT_LESS:
+    case OP_R_JUMP_IF_NOT_GREATER:
+    case OP_R_JUMP_IF_NOT_EQUAL:
+    case OP_R_JUMP_IF_LESS_CONSTANT:
+    case OP_R_JUMP_IF_GREATER_CONSTANT:
+    case OP_R_JUMP_IF_EQUAL_CONSTANT:
+    case OP_R_JUMP_IF_NOT_LESS_CONSTANT:
+    case OP_R_JUMP_IF_NOT_GREATER_CONSTANT:
+    case OP_R_JUMP_IF_NOT_EQUAL_CONSTANT:
+#ifdef COMPUTEDUCK_BUILD_WITH_LLVM
+        return GetJumpAddressOffset(*ip) + sizeof(int32_t) + sizeof(uint8_t);
+#else
+        return GetJumpAddressOffset(*ip) + sizeof(int32_t);
+#endif
+    default:
+        ASSERT("Unknown opcode:%d", *ip);
+        return 1;
+    }
+}
+
+uint32_t GetJumpAddressOffset(uint8_t opcode)
+{
+    switch (GetGenericOpCode(opcode))
+    {
+    case OP_JUMP:
+    case OP_JUMP_IF_FALSE:
+    case OP_JUMP_IF_LESS:
+    case OP_JUMP_IF_GREATER:
+    case OP_JUMP_IF_EQUAL:
+    case OP_JUMP_IF_NOT_LESS:
+    case OP_JUMP_IF_NOT_GREATER:
+    case OP_JUMP_IF_NOT_EQUAL:
+    case OP_R_JUMP:
+        return 1;
+    case OP_R_JUMP_IF_FALSE:
+        return 1 + sizeof(uint8_t);
+    case OP_R_JUMP_IF_LESS:
+    case OP_R_JUMP_IF_GREATER:
+    case OP_R_JUMP_IF_EQUAL:
+    case OP_R_JUMP_IF_NOT_LESS:
+    case OP_R_JUMP_IF_NOT_GREATER:
+    case OP_R_JUMP_IF_NOT_EQUAL:
+        return 1 + 2 * sizeof(uint8_t);
+    case OP_R_JUMP_IF_LESS_CONSTANT:
+    case OP_R_JUMP_IF_GREATER_CONSTANT:
+    case OP_R_JUMP_IF_EQUAL_CONSTANT:
+    case OP_R_JUMP_IF_NOT_LESS_CONSTANT:
+    case OP_R_JUMP_IF_NOT_GREATER_CONSTANT:
+    case OP_R_JUMP_IF_NOT_EQUAL_CONSTANT:
+        return 1 + sizeof(uint8_t) + sizeof(uint16_t);
+    default:
+        return 0;
+    }
+}
+
+size_t GetJumpTarget(const OpCodeList &opCodeList, size_t pos)
+{
+    auto offset = DecodeOperand<int32_t>(opCodeList.data() + pos + GetJumpAddressOffset(opCodeList[pos]));
+    return pos + offset;
+}
+
+void SetJumpTarget(OpCodeList &opCodeList, size_t pos, size_t target)
+{
+    auto offset = static_cast<int64_t>(target) - static_cast<int64_t>(pos);
+    if (offset < INT32_MIN || offset > INT32_MAX)
+        ASSERT("Jump offset out of range:%lld", static_cast<long long>(offset));
+    EncodeOperand<int32_t>(opCodeList.data() + pos + GetJumpAddressOffset(opCodeList[pos]), static_cast<int32_t>(offset));
+}
+
 Chunk::Chunk(OpCodeList opCodeList, const std::vector<Value> &constants)
     : opCodeList(opCodeList), constants(constants)
 {
@@ -24,13 +334,17 @@ std::string Chunk::Stringify()
 std::string Chunk::OpCodeStringify(const OpCodeList &opCodeList)
 {
     std::stringstream cout;
-    for (size_t i = 0; i < opCodeList.size(); ++i)
+    const uint8_t *begin = opCodeList.data();
+    const uint8_t *ip = begin;
+    const uint8_t *end = begin + opCodeList.size();
+    while (ip < end)
     {
-        size_t curAddress = i;
-        switch (opCodeList[curAddress])
+        size_t curAddress = ip - begin;
+        auto opcode = *ip++;
+        switch (opcode)
         {
         case OP_CONSTANT:
-            cout << std::format("{:08}\tOP_CONSTANT\t{}\n", curAddress, constants[opCodeList[++i]].Stringify());
+            cout << std::format("{:08}\tOP_CONSTANT\t{}\n", curAddress, constants[ReadOperand<uint16_t>(ip)].Stringify());
             break;
         case OP_ADD:
             cout << std::format("{:08}\tOP_ADD\n", curAddress);
@@ -60,7 +374,7 @@ std::string Chunk::OpCodeStringify(const OpCodeList &opCodeList)
             cout << std::format("{:08}\tOP_EQUAL\n", curAddress);
             break;
         case OP_ARRAY:
-            cout << std::format("{:08}\tOP_ARRAY\t{}", curAddress,opCodeList[++i]);
+            cout << std::format("{:08}\tOP_ARRAY\t{}\n", curAddress, ReadOperand<uint16_t>(ip));
             break;
         case OP_AND:
             cout << std::format("{:08}\tOP_AND\n", curAddress);
@@ -87,103 +401,617 @@ std::string Chunk::OpCodeStringify(const OpCodeList &opCodeList)
             cout << std::format("{:08}\tOP_SET_INDEX\n", curAddress);
             break;
         case OP_JUMP:
-#ifdef COMPUTEDUCK_BUILD_WITH_LLVM
-            cout << std::format("{:08}\tOP_JUMP\t{}\t{}\n", curAddress,opCodeList[++i],opCodeList[++i]);
-#else
-            cout << std::format("{:08}\tOP_JUMP\t{}\n", curAddress,opCodeList[++i]);
-#endif
-            break;
         case OP_JUMP_IF_FALSE:
+        {
+            auto name = opcode == OP_JUMP ? "OP_JUMP" : "OP_JUMP_IF_FALSE";
+            auto address = curAddress + ReadOperand<int32_t>(ip);
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
-            cout << std::format("{:08}\tOP_JUMP_IF_FALSE\t{}\t{}\n", curAddress,opCodeList[++i],opCodeList[++i]);
-            break;
+            auto mode = ReadOperand<uint8_t>(ip);
+            cout << std::format("{:08}\t{}\t{}\t{}\n", curAddress, name, address, mode);
 #else
-            cout << std::format("{:08}\tOP_JUMP_IF_FALSE\t{}\n", curAddress,opCodeList[++i]);
+            cout << std::format("{:08}\t{}\t{}\n", curAddress, name, address);
 #endif
             break;
+        }
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
         case OP_JUMP_START:
-            cout << std::format("{:08}\tOP_JUMP_START\t{}\n", curAddress,opCodeList[++i]);
+            cout << std::format("{:08}\tOP_JUMP_START\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
             break;
         case OP_JUMP_END:
             cout << std::format("{:08}\tOP_JUMP_END\n", curAddress);
             break;
 #endif
         case OP_RETURN:
-            cout << std::format("{:08}\tOP_RETURN\t{}\n", curAddress,opCodeList[++i]);
+            cout << std::format("{:08}\tOP_RETURN\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
             break;
         case OP_DEF_GLOBAL:
-            cout << std::format("{:08}\tOP_DEF_GLOBAL\t{}\n", curAddress,opCodeList[++i]);
+            cout << std::format("{:08}\tOP_DEF_GLOBAL\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
             break;
         case OP_SET_GLOBAL:
-            cout << std::format("{:08}\tOP_SET_GLOBAL\t{}\n", curAddress,opCodeList[++i]);
+            cout << std::format("{:08}\tOP_SET_GLOBAL\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
             break;
         case OP_GET_GLOBAL:
-            cout << std::format("{:08}\tOP_GET_GLOBAL\t{}\n", curAddress,opCodeList[++i]);
+            cout << std::format("{:08}\tOP_GET_GLOBAL\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
             break;
         case OP_DEF_LOCAL:
-            cout << std::format("{:08}\tOP_DEF_LOCAL\t{}\n", curAddress,opCodeList[++i]);
+            cout << std::format("{:08}\tOP_DEF_LOCAL\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
             break;
         case OP_SET_LOCAL:
-            cout << std::format("{:08}\tOP_SET_LOCAL\t{}\n", curAddress,opCodeList[++i]);
+            cout << std::format("{:08}\tOP_SET_LOCAL\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
             break;
         case OP_GET_LOCAL:
-            cout << std::format("{:08}\tOP_GET_LOCAL\t{}\n", curAddress,opCodeList[++i]);
+            cout << std::format("{:08}\tOP_GET_LOCAL\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
             break;
         case OP_GET_UPVALUE:
-            cout << std::format("{:08}\tOP_GET_UPVALUE\t{}\n", curAddress,opCodeList[++i]);
+            cout << std::format("{:08}\tOP_GET_UPVALUE\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
             break;
         case OP_SET_UPVALUE:
-            cout << std::format("{:08}\tOP_SET_UPVALUE\t{}\n", curAddress,opCodeList[++i]);
+            cout << std::format("{:08}\tOP_SET_UPVALUE\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
             break;
         case OP_CLOSURE:
         {
-            cout << std::format("{:08}\tOP_CLOSURE\t{}\t{}\n", curAddress, opCodeList[++i], opCodeList[++i]);
-            auto upvalueCount = opCodeList[i];
+            auto idx = ReadOperand<uint16_t>(ip);
+            auto upvalueCount = ReadOperand<uint8_t>(ip);
+            cout << std::format("{:08}\tOP_CLOSURE\t{}\t{}\n", curAddress, idx, upvalueCount);
             for (uint8_t j = 0; j < upvalueCount; ++j)
-                cout << std::format("\t\t\t|\t{}\t{}\n", opCodeList[++i], opCodeList[++i]);
+            {
+                auto index = ReadOperand<uint8_t>(ip);
+                auto scopeDepth = ReadOperand<uint8_t>(ip);
+                cout << std::format("\t\t\t|\t{}\t{}\n", index, scopeDepth);
+            }
             break;
         }
         case OP_FUNCTION_CALL:
-            cout << std::format("{:08}\tOP_FUNCTION_CALL\t{}\n", curAddress,opCodeList[++i]);
+            cout << std::format("{:08}\tOP_FUNCTION_CALL\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
+            break;
+        case OP_TAIL_CALL:
+            cout << std::format("{:08}\tOP_TAIL_CALL\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
             break;
         case OP_GET_BUILTIN:
-            cout << std::format("{:08}\tOP_GET_BUILTIN\t{}\n", curAddress,constants[opCodeList[++i]].Stringify());
+            cout << std::format("{:08}\tOP_GET_BUILTIN\t{}\n", curAddress, constants[ReadOperand<uint16_t>(ip)].Stringify());
             break;
+        case OP_GET_BUILTIN_INDEX:
+        {
+            auto index = ReadOperand<uint16_t>(ip);
+            cout << std::format("{:08}\tOP_GET_BUILTIN_INDEX\t{}\t{}\n", curAddress, index, ObjectStringify(BuiltinManager::GetInstance()->GetBuiltinName(index)));
+            break;
+        }
         case OP_STRUCT:
-            cout << std::format("{:08}\tOP_STRUCT\t{}\n", curAddress,opCodeList[++i]);
+            cout << std::format("{:08}\tOP_STRUCT\t{}\n", curAddress, ReadOperand<uint16_t>(ip));
+            break;
+        case OP_NEW_STRUCT:
+            cout << std::format("{:08}\tOP_NEW_STRUCT\t{}\n", curAddress, constants[ReadOperand<uint16_t>(ip)].Stringify());
             break;
         case OP_GET_STRUCT:
-            cout << std::format("{:08}\tOP_GET_STRUCT\n", curAddress);
+            cout << std::format("{:08}\tOP_GET_STRUCT\t{}\n", curAddress, ReadOperand<uint16_t>(ip));
             break;
         case OP_SET_STRUCT:
-            cout << std::format("{:08}\tOP_SET_STRUCT\n", curAddress);
+            cout << std::format("{:08}\tOP_SET_STRUCT\t{}\n", curAddress, ReadOperand<uint16_t>(ip));
             break;
         case OP_REF_GLOBAL:
-            cout << std::format("{:08}\tOP_REF_GLOBAL\t{}\n", curAddress,opCodeList[++i]);
+            cout << std::format("{:08}\tOP_REF_GLOBAL\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
             break;
         case OP_REF_LOCAL:
-            cout << std::format("{:08}\tOP_REF_LOCAL\t{}\n", curAddress,opCodeList[++i]);
+            cout << std::format("{:08}\tOP_REF_LOCAL\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
             break;
         case OP_REF_UPVALUE:
-            cout << std::format("{:08}\tOP_REF_UPVALUE\t{}\n", curAddress,opCodeList[++i]);
+            cout << std::format("{:08}\tOP_REF_UPVALUE\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
             break;
         case OP_REF_INDEX_GLOBAL:
-            cout << std::format("{:08}\tOP_REF_INDEX_GLOBAL\t{}\n", curAddress,opCodeList[++i]);
+            cout << std::format("{:08}\tOP_REF_INDEX_GLOBAL\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
             break;
         case OP_REF_INDEX_LOCAL:
-            cout << std::format("{:08}\tOP_REF_INDEX_LOCAL\t{}\n", curAddress,opCodeList[++i]);
+            cout << std::format("{:08}\tOP_REF_INDEX_LOCAL\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
             break;
         case OP_REF_INDEX_UPVALUE:
-            cout << std::format("{:08}\tOP_REF_INDEX_UPVALUE\t{}\n", curAddress,opCodeList[++i]);
+            cout << std::format("{:08}\tOP_REF_INDEX_UPVALUE\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
+            break;
+        case OP_STACK_REF_GLOBAL:
+            cout << std::format("{:08}\tOP_STACK_REF_GLOBAL\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
+            break;
+        case OP_STACK_REF_LOCAL:
+            cout << std::format("{:08}\tOP_STACK_REF_LOCAL\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
+            break;
+        case OP_STACK_REF_UPVALUE:
+            cout << std::format("{:08}\tOP_STACK_REF_UPVALUE\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
+            break;
+        case OP_STACK_REF_INDEX_GLOBAL:
+            cout << std::format("{:08}\tOP_STACK_REF_INDEX_GLOBAL\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
+            break;
+        case OP_STACK_REF_INDEX_LOCAL:
+            cout << std::format("{:08}\tOP_STACK_REF_INDEX_LOCAL\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
+            break;
+        case OP_STACK_REF_INDEX_UPVALUE:
+            cout << std::format("{:08}\tOP_STACK_REF_INDEX_UPVALUE\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
+            break;
+        case OP_STACK_REF_CALL:
+            cout << std::format("{:08}\tOP_STACK_REF_CALL\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
+            break;
+        case OP_RELEASE_STACK_REFS:
+            cout << std::format("{:08}\tOP_RELEASE_STACK_REFS\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
+            break;
+        case OP_CONCAT:
+            cout << std::format("{:08}\tOP_CONCAT\t{}\n", curAddress, ReadOperand<uint8_t>(ip));
             break;
         case OP_DLL_IMPORT:
             cout << std::format("{:08}\tOP_DLL_IMPORT\n", curAddress);
             break;
+        case OP_ADD_NUM:
+        case OP_SUB_NUM:
+        case OP_MUL_NUM:
+        case OP_DIV_NUM:
+        case OP_GREATER_NUM:
+        case OP_LESS_NUM:
+        case OP_EQUAL_NUM:
+            cout << std::format("{:08}\t{}\n", curAddress, SpecializedOpCodeName(opcode));
+            break;
+        case OP_INC_LOCAL:
+        case OP_INC_GLOBAL:
+        case OP_INC_LOCAL_NUM:
+        case OP_INC_GLOBAL_NUM:
+        {
+            auto index = ReadOperand<uint8_t>(ip);
+            auto idx = ReadOperand<uint16_t>(ip);
+            cout << std::format("{:08}\t{}\t{}\t{}\n", curAddress, SpecializedOpCodeName(opcode), index, constants[idx].Stringify());
+            break;
+        }
+        case OP_JUMP_IF_LESS:
+        case OP_JUMP_IF_GREATER:
+        case OP_JUMP_IF_EQUAL:
+        case OP_JUMP_IF_NOT_LESS:
+        case OP_JUMP_IF_NOT_GREATER:
+        case OP_JUMP_IF_NOT_EQUAL:
+        case OP_JUMP_IF_LESS_NUM:
+        case OP_JUMP_IF_GREATER_NUM:
+        case OP_JUMP_IF_EQUAL_NUM:
+        case OP_JUMP_IF_NOT_LESS_NUM:
+        case OP_JUMP_IF_NOT_GREATER_NUM:
+        case OP_JUMP_IF_NOT_EQUAL_NUM:
+        {
+            auto address = curAddress + ReadOperand<int32_t>(ip);
+#ifdef COMPUTEDUCK_BUILD_WITH_LLVM
+            auto mode = ReadOperand<uint8_t>(ip);
+            cout << std::format("{:08}\t{}\t{}\t{}\n", curAddress, SpecializedOpCodeName(opcode), address, mode);
+#else
+            cout << std::format("{:08}\t{}\t{}\n", curAddress, SpecializedOpCodeName(opcode), address);
+#endif
+            break;
+        }
+        case OP_R_MOVE:
+        case OP_R_NOT:
+        case OP_R_MINUS:
+        case OP_R_BIT_NOT:
+        case OP_R_DEF_GLOBAL:
+        case OP_R_SET_GLOBAL:
+        case OP_R_GET_GLOBAL:
+        case OP_R_SET_LOCAL:
+        case OP_R_GET_UPVALUE:
+        case OP_R_SET_UPVALUE:
+        case OP_R_FUNCTION_CALL:
+        case OP_R_TAIL_CALL:
+        case OP_R_STACK_REF_CALL:
+        case OP_R_RETURN:
+        case OP_R_REF_GLOBAL:
+        case OP_R_REF_LOCAL:
+        case OP_R_REF_UPVALUE:
+        case OP_R_STACK_REF_GLOBAL:
+        case OP_R_STACK_REF_LOCAL:
+        case OP_R_STACK_REF_UPVALUE:
+        {
+            auto a = ReadOperand<uint8_t>(ip);
+            auto b = ReadOperand<uint8_t>(ip);
+            cout << std::format("{:08}\t{}\t{}\t{}\n", curAddress, SpecializedOpCodeName(opcode), a, b);
+            break;
+        }
+        case OP_R_ADD:
+        case OP_R_SUB:
+        case OP_R_MUL:
+        case OP_R_DIV:
+        case OP_R_EQUAL:
+        case OP_R_GREATER:
+        case OP_R_LESS:
+        case OP_R_AND:
+        case OP_R_OR:
+        case OP_R_BIT_AND:
+        case OP_R_BIT_OR:
+        case OP_R_BIT_XOR:
+        case OP_R_ADD_NUM:
+        case OP_R_SUB_NUM:
+        case OP_R_MUL_NUM:
+        case OP_R_DIV_NUM:
+        case OP_R_GREATER_NUM:
+        case OP_R_LESS_NUM:
+        case OP_R_EQUAL_NUM:
+        case OP_R_GET_INDEX:
+        case OP_R_SET_INDEX:
+        case OP_R_REF_INDEX_GLOBAL:
+        case OP_R_REF_INDEX_LOCAL:
+        case OP_R_REF_INDEX_UPVALUE:
+        case OP_R_STACK_REF_INDEX_GLOBAL:
+        case OP_R_STACK_REF_INDEX_LOCAL:
+        case OP_R_STACK_REF_INDEX_UPVALUE:
+        case OP_R_RELEASE_STACK_REFS:
+        case OP_R_CONCAT:
+        {
+            auto a = ReadOperand<uint8_t>(ip);
+            auto b = ReadOperand<uint8_t>(ip);
+            auto c = ReadOperand<uint8_t>(ip);
+            cout << std::format("{:08}\t{}\t{}\t{}\t{}\n", curAddress, SpecializedOpCodeName(opcode), a, b, c);
+            break;
+        }
+        case OP_R_CONSTANT:
+        case OP_R_GET_BUILTIN:
+        case OP_R_NEW_STRUCT:
+        case OP_R_INC_LOCAL:
+        case OP_R_INC_GLOBAL:
+        case OP_R_INC_LOCAL_NUM:
+        case OP_R_INC_GLOBAL_NUM:
+        {
+            auto a = ReadOperand<uint8_t>(ip);
+            auto idx = ReadOperand<uint16_t>(ip);
+            cout << std::format("{:08}\t{}\t{}\t{}\n", curAddress, SpecializedOpCodeName(opcode), a, constants[idx].Stringify());
+            break;
+        }
+        case OP_R_GET_BUILTIN_INDEX:
+        {
+            auto a = ReadOperand<uint8_t>(ip);
+            auto index = ReadOperand<uint16_t>(ip);
+            cout << std::format("{:08}\tOP_R_GET_BUILTIN_INDEX\t{}\t{}\t{}\n", curAddress, a, index, ObjectStringify(BuiltinManager::GetInstance()->GetBuiltinName(index)));
+            break;
+        }
+        case OP_R_ADD_CONSTANT:
+        case OP_R_SUB_CONSTANT:
+        case OP_R_MUL_CONSTANT:
+        case OP_R_ADD_CONSTANT_NUM:
+        case OP_R_SUB_CONSTANT_NUM:
+        case OP_R_MUL_CONSTANT_NUM:
+        {
+            auto a = ReadOperand<uint8_t>(ip);
+            auto b = ReadOperand<uint8_t>(ip);
+            auto idx = ReadOperand<uint16_t>(ip);
+            cout << std::format("{:08}\t{}\t{}\t{}\t{}\n", curAddress, SpecializedOpCodeName(opcode), a, b, constants[idx].Stringify());
+            break;
+        }
+        case OP_R_ARRAY:
+        {
+            auto a = ReadOperand<uint8_t>(ip);
+            auto b = ReadOperand<uint8_t>(ip);
+            auto count = ReadOperand<uint16_t>(ip);
+            cout << std::format("{:08}\tOP_R_ARRAY\t{}\t{}\t{}\n", curAddress, a, b, count);
+            break;
+        }
+        case OP_R_CLOSURE:
+        {
+            auto a = ReadOperand<uint8_t>(ip);
+            auto idx = ReadOperand<uint16_t>(ip);
+            auto upvalueCount = ReadOperand<uint8_t>(ip);
+            cout << std::format("{:08}\tOP_R_CLOSURE\t{}\t{}\t{}\n", curAddress, a, idx, upvalueCount);
+            for (uint8_t j = 0; j < upvalueCount; ++j)
+            {
+                auto index = ReadOperand<uint8_t>(ip);
+                auto scopeDepth = ReadOperand<uint8_t>(ip);
+                cout << std::format("\t\t\t|\t{}\t{}\n", index, scopeDepth);
+            }
+            break;
+        }
+        case OP_R_STRUCT:
+        {
+            auto a = ReadOperand<uint8_t>(ip);
+            auto b = ReadOperand<uint8_t>(ip);
+            auto count = ReadOperand<uint16_t>(ip);
+            cout << std::format("{:08}\tOP_R_STRUCT\t{}\t{}\t{}\n", curAddress, a, b, count);
+            for (uint16_t j = 0; j < count; ++j)
+                cout << std::format("\t\t\t|\t{}\n", constants[ReadOperand<uint16_t>(ip)].Stringify());
+            break;
+        }
+        case OP_R_GET_STRUCT:
+        {
+            auto a = ReadOperand<uint8_t>(ip);
+            auto b = ReadOperand<uint8_t>(ip);
+            auto idx = ReadOperand<uint16_t>(ip);
+            auto cacheIdx = ReadOperand<uint16_t>(ip);
+            cout << std::format("{:08}\tOP_R_GET_STRUCT\t{}\t{}\t{}\t{}\n", curAddress, a, b, constants[idx].Stringify(), cacheIdx);
+            break;
+        }
+        case OP_R_SET_STRUCT:
+        {
+            auto a = ReadOperand<uint8_t>(ip);
+            auto idx = ReadOperand<uint16_t>(ip);
+            auto cacheIdx = ReadOperand<uint16_t>(ip);
+            auto b = ReadOperand<uint8_t>(ip);
+            cout << std::format("{:08}\tOP_R_SET_STRUCT\t{}\t{}\t{}\t{}\n", curAddress, a, constants[idx].Stringify(), cacheIdx, b);
+            break;
+        }
+        case OP_R_DLL_IMPORT:
+            cout << std::format("{:08}\tOP_R_DLL_IMPORT\t{}\n", curAddress, constants[ReadOperand<uint16_t>(ip)].Stringify());
+            break;
+        case OP_R_JUMP:
+        case OP_R_JUMP_IF_FALSE:
+        case OP_R_JUMP_IF_LESS:
+        case OP_R_JUMP_IF_GREATER:
+        case OP_R_JUMP_IF_EQUAL:
+        case OP_R_JUMP_IF_NOT_LESS:
+        case OP_R_JUMP_IF_NOT_GREATER:
+        case OP_R_JUMP_IF_NOT_EQUAL:
+        case OP_R_JUMP_IF_LESS_NUM:
+        case OP_R_JUMP_IF_GREATER_NUM:
+        case OP_R_JUMP_IF_EQUAL_NUM:
+        case OP_R_JUMP_IF_NOT_LESS_NUM:
+        case OP_R_JUMP_IF_NOT_GREATER_NUM:
+        case OP_R_JUMP_IF_NOT_EQUAL_NUM:
+        case OP_R_JUMP_IF_LESS_CONSTANT:
+        case OP_R_JUMP_IF_GREATER_CONSTANT:
+        case OP_R_JUMP_IF_EQUAL_CONSTANT:
+        case OP_R_JUMP_IF_NOT_LESS_CONSTANT:
+        case OP_R_JUMP_IF_NOT_GREATER_CONSTANT:
+        case OP_R_JUMP_IF_NOT_EQUAL_CONSTANT:
+        case OP_R_JUMP_IF_LESS_CONSTANT_NUM:
+        case OP_R_JUMP_IF_GREATER_CONSTANT_NUM:
+        case OP_R_JUMP_IF_EQUAL_CONSTANT_NUM:
+        case OP_R_JUMP_IF_NOT_LESS_CONSTANT_NUM:
+        case OP_R_JUMP_IF_NOT_GREATER_CONSTANT_NUM:
+        case OP_R_JUMP_IF_NOT_EQUAL_CONSTANT_NUM:
+        {
+            // the operands in front of the jump offset
+            std::string operands;
+            auto generic = GetGenericOpCode(opcode);
+            if (generic == OP_R_JUMP_IF_FALSE)
+                operands = std::format("\t{}", ReadOperand<uint8_t>(ip));
+            else if (generic >= OP_R_JUMP_IF_LESS && generic <= OP_R_JUMP_IF_NOT_EQUAL)
+            {
+                auto l = ReadOperand<uint8_t>(ip);
+                operands = std::format("\t{}\t{}", l, ReadOperand<uint8_t>(ip));
+            }
+            else if (generic != OP_R_JUMP)
+            {
+                auto l = ReadOperand<uint8_t>(ip);
+                operands = std::format("\t{}\t{}", l, constants[ReadOperand<uint16_t>(ip)].Stringify());
+            }
+            auto address = curAddress + ReadOperand<int32_t>(ip);
+#ifdef COMPUTEDUCK_BUILD_WITH_LLVM
+            auto mode = ReadOperand<uint8_t>(ip);
+            cout << std::format("{:08}\t{}{}\t{}\t{}\n", curAddress, SpecializedOpCodeName(opcode), operands, address, mode);
+#else
+            cout << std::format("{:08}\t{}{}\t{}\n", curAddress, SpecializedOpCodeName(opcode), operands, address);
+#endif
+            break;
+        }
         default:
+            ip = begin + curAddress + GetInstructionLength(begin + curAddress);
             break;
         }
     }
 
     return cout.str();
+}
+
+std::string Chunk::SpecializedOpCodeName(uint8_t opcode)
+{
+    switch (opcode)
+    {
+    case OP_INC_LOCAL:
+        return "OP_INC_LOCAL";
+    case OP_INC_GLOBAL:
+        return "OP_INC_GLOBAL";
+    case OP_JUMP_IF_LESS:
+        return "OP_JUMP_IF_LESS";
+    case OP_JUMP_IF_GREATER:
+        return "OP_JUMP_IF_GREATER";
+    case OP_JUMP_IF_EQUAL:
+        return "OP_JUMP_IF_EQUAL";
+    case OP_JUMP_IF_NOT_LESS:
+        return "OP_JUMP_IF_NOT_LESS";
+    case OP_JUMP_IF_NOT_GREATER:
+        return "OP_JUMP_IF_NOT_GREATER";
+    case OP_JUMP_IF_NOT_EQUAL:
+        return "OP_JUMP_IF_NOT_EQUAL";
+    case OP_ADD_NUM:
+        return "OP_ADD_NUM";
+    case OP_SUB_NUM:
+        return "OP_SUB_NUM";
+    case OP_MUL_NUM:
+        return "OP_MUL_NUM";
+    case OP_DIV_NUM:
+        return "OP_DIV_NUM";
+    case OP_GREATER_NUM:
+        return "OP_GREATER_NUM";
+    case OP_LESS_NUM:
+        return "OP_LESS_NUM";
+    case OP_EQUAL_NUM:
+        return "OP_EQUAL_NUM";
+    case OP_INC_LOCAL_NUM:
+        return "OP_INC_LOCAL_NUM";
+    case OP_INC_GLOBAL_NUM:
+        return "OP_INC_GLOBAL_NUM";
+    case OP_JUMP_IF_LESS_NUM:
+        return "OP_JUMP_IF_LESS_NUM";
+    case OP_JUMP_IF_GREATER_NUM:
+        return "OP_JUMP_IF_GREATER_NUM";
+    case OP_JUMP_IF_EQUAL_NUM:
+        return "OP_JUMP_IF_EQUAL_NUM";
+    case OP_JUMP_IF_NOT_LESS_NUM:
+        return "OP_JUMP_IF_NOT_LESS_NUM";
+    case OP_JUMP_IF_NOT_GREATER_NUM:
+        return "OP_JUMP_IF_NOT_GREATER_NUM";
+    case OP_JUMP_IF_NOT_EQUAL_NUM:
+        return "OP_JUMP_IF_NOT_EQUAL_NUM";
+    case OP_R_MOVE:
+        return "OP_R_MOVE";
+    case OP_R_CONSTANT:
+        return "OP_R_CONSTANT";
+    case OP_R_ADD:
+        return "OP_R_ADD";
+    case OP_R_SUB:
+        return "OP_R_SUB";
+    case OP_R_MUL:
+        return "OP_R_MUL";
+    case OP_R_DIV:
+        return "OP_R_DIV";
+    case OP_R_EQUAL:
+        return "OP_R_EQUAL";
+    case OP_R_GREATER:
+        return "OP_R_GREATER";
+    case OP_R_LESS:
+        return "OP_R_LESS";
+    case OP_R_NOT:
+        return "OP_R_NOT";
+    case OP_R_MINUS:
+        return "OP_R_MINUS";
+    case OP_R_AND:
+        return "OP_R_AND";
+    case OP_R_OR:
+        return "OP_R_OR";
+    case OP_R_BIT_AND:
+        return "OP_R_BIT_AND";
+    case OP_R_BIT_OR:
+        return "OP_R_BIT_OR";
+    case OP_R_BIT_NOT:
+        return "OP_R_BIT_NOT";
+    case OP_R_BIT_XOR:
+        return "OP_R_BIT_XOR";
+    case OP_R_ADD_CONSTANT:
+        return "OP_R_ADD_CONSTANT";
+    case OP_R_SUB_CONSTANT:
+        return "OP_R_SUB_CONSTANT";
+    case OP_R_MUL_CONSTANT:
+        return "OP_R_MUL_CONSTANT";
+    case OP_R_JUMP:
+        return "OP_R_JUMP";
+    case OP_R_JUMP_IF_FALSE:
+        return "OP_R_JUMP_IF_FALSE";
+    case OP_R_DEF_GLOBAL:
+        return "OP_R_DEF_GLOBAL";
+    case OP_R_SET_GLOBAL:
+        return "OP_R_SET_GLOBAL";
+    case OP_R_GET_GLOBAL:
+        return "OP_R_GET_GLOBAL";
+    case OP_R_SET_LOCAL:
+        return "OP_R_SET_LOCAL";
+    case OP_R_GET_UPVALUE:
+        return "OP_R_GET_UPVALUE";
+    case OP_R_SET_UPVALUE:
+        return "OP_R_SET_UPVALUE";
+    case OP_R_GET_INDEX:
+        return "OP_R_GET_INDEX";
+    case OP_R_SET_INDEX:
+        return "OP_R_SET_INDEX";
+    case OP_R_FUNCTION_CALL:
+        return "OP_R_FUNCTION_CALL";
+    case OP_R_TAIL_CALL:
+        return "OP_R_TAIL_CALL";
+    case OP_R_RETURN:
+        return "OP_R_RETURN";
+    case OP_R_GET_BUILTIN:
+        return "OP_R_GET_BUILTIN";
+    case OP_R_NEW_STRUCT:
+        return "OP_R_NEW_STRUCT";
+    case OP_R_REF_GLOBAL:
+        return "OP_R_REF_GLOBAL";
+    case OP_R_REF_LOCAL:
+        return "OP_R_REF_LOCAL";
+    case OP_R_REF_UPVALUE:
+        return "OP_R_REF_UPVALUE";
+    case OP_R_REF_INDEX_GLOBAL:
+        return "OP_R_REF_INDEX_GLOBAL";
+    case OP_R_REF_INDEX_LOCAL:
+        return "OP_R_REF_INDEX_LOCAL";
+    case OP_R_REF_INDEX_UPVALUE:
+        return "OP_R_REF_INDEX_UPVALUE";
+    case OP_R_STACK_REF_GLOBAL:
+        return "OP_R_STACK_REF_GLOBAL";
+    case OP_R_STACK_REF_LOCAL:
+        return "OP_R_STACK_REF_LOCAL";
+    case OP_R_STACK_REF_UPVALUE:
+        return "OP_R_STACK_REF_UPVALUE";
+    case OP_R_STACK_REF_INDEX_GLOBAL:
+        return "OP_R_STACK_REF_INDEX_GLOBAL";
+    case OP_R_STACK_REF_INDEX_LOCAL:
+        return "OP_R_STACK_REF_INDEX_LOCAL";
+    case OP_R_STACK_REF_INDEX_UPVALUE:
+        return "OP_R_STACK_REF_INDEX_UPVALUE";
+    case OP_R_STACK_REF_CALL:
+        return "OP_R_STACK_REF_CALL";
+    case OP_R_RELEASE_STACK_REFS:
+        return "OP_R_RELEASE_STACK_REFS";
+    case OP_R_CONCAT:
+        return "OP_R_CONCAT";
+    case OP_R_INC_LOCAL:
+        return "OP_R_INC_LOCAL";
+    case OP_R_INC_GLOBAL:
+        return "OP_R_INC_GLOBAL";
+    case OP_R_JUMP_IF_LESS:
+        return "OP_R_JUMP_IF_LESS";
+    case OP_R_JUMP_IF_GREATER:
+        return "OP_R_JUMP_IF_GREATER";
+    case OP_R_JUMP_IF_EQUAL:
+        return "OP_R_JUMP_IF_EQUAL";
+    case OP_R_JUMP_IF_NOT_LESS:
+        return "OP_R_JUMP_IF_NOT_LESS";
+    case OP_R_JUMP_IF_NOT_GREATER:
+        return "OP_R_JUMP_IF_NOT_GREATER";
+    case OP_R_JUMP_IF_NOT_EQUAL:
+        return "OP_R_JUMP_IF_NOT_EQUAL";
+    case OP_R_JUMP_IF_LESS_CONSTANT:
+        return "OP_R_JUMP_IF_LESS_CONSTANT";
+    case OP_R_JUMP_IF_GREATER_CONSTANT:
+        return "OP_R_JUMP_IF_GREATER_CONSTANT";
+    case OP_R_JUMP_IF_EQUAL_CONSTANT:
+        return "OP_R_JUMP_IF_EQUAL_CONSTANT";
+    case OP_R_JUMP_IF_NOT_LESS_CONSTANT:
+        return "OP_R_JUMP_IF_NOT_LESS_CONSTANT";
+    case OP_R_JUMP_IF_NOT_GREATER_CONSTANT:
+        return "OP_R_JUMP_IF_NOT_GREATER_CONSTANT";
+    case OP_R_JUMP_IF_NOT_EQUAL_CONSTANT:
+        return "OP_R_JUMP_IF_NOT_EQUAL_CONSTANT";
+    case OP_R_ADD_NUM:
+        return "OP_R_ADD_NUM";
+    case OP_R_SUB_NUM:
+        return "OP_R_SUB_NUM";
+    case OP_R_MUL_NUM:
+        return "OP_R_MUL_NUM";
+    case OP_R_DIV_NUM:
+        return "OP_R_DIV_NUM";
+    case OP_R_GREATER_NUM:
+        return "OP_R_GREATER_NUM";
+    case OP_R_LESS_NUM:
+        return "OP_R_LESS_NUM";
+    case OP_R_EQUAL_NUM:
+        return "OP_R_EQUAL_NUM";
+    case OP_R_ADD_CONSTANT_NUM:
+        return "OP_R_ADD_CONSTANT_NUM";
+    case OP_R_SUB_CONSTANT_NUM:
+        return "OP_R_SUB_CONSTANT_NUM";
+    case OP_R_MUL_CONSTANT_NUM:
+        return "OP_R_MUL_CONSTANT_NUM";
+    case OP_R_INC_LOCAL_NUM:
+        return "OP_R_INC_LOCAL_NUM";
+    case OP_R_INC_GLOBAL_NUM:
+        return "OP_R_INC_GLOBAL_NUM";
+    case OP_R_JUMP_IF_LESS_NUM:
+        return "OP_R_JUMP_IF_LESS_NUM";
+    case OP_R_JUMP_IF_GREATER_NUM:
+        return "OP_R_JUMP_IF_GREATER_NUM";
+    case OP_R_JUMP_IF_EQUAL_NUM:
+        return "OP_R_JUMP_IF_EQUAL_NUM";
+    case OP_R_JUMP_IF_NOT_LESS_NUM:
+        return "OP_R_JUMP_IF_NOT_LESS_NUM";
+    case OP_R_JUMP_IF_NOT_GREATER_NUM:
+        return "OP_R_JUMP_IF_NOT_GREATER_NUM";
+    case OP_R_JUMP_IF_NOT_EQUAL_NUM:
+        return "OP_R_JUMP_IF_NOT_EQUAL_NUM";
+    case OP_R_JUMP_IF_LESS_CONSTANT_NUM:
+        return "OP_R_JUMP_IF_LESS_CONSTANT_NUM";
+    case OP_R_JUMP_IF_GREATER_CONSTANT_NUM:
+        return "OP_R_JUMP_IF_GREATER_CONSTANT_NUM";
+    case OP_R_JUMP_IF_EQUAL_CONSTANT_NUM:
+        return "OP_R_JUMP_IF_EQUAL_CONSTANT_NUM";
+    case OP_R_JUMP_IF_NOT_LESS_CONSTANT_NUM:
+        return "OP_R_JUMP_IF_NOT_LESS_CONSTANT_NUM";
+    case OP_R_JUMP_IF_NOT_GREATER_CONSTANT_NUM:
+        return "OP_R_JUMP_IF_NOT_GREATER_CONSTANT_NUM";
+    case OP_R_JUMP_IF_NOT_EQUAL_CONSTANT_NUM:
+        return "OP_R_JUMP_IF_NOT_EQUAL_CONSTANT_NUM";
+    default:
+        return "OP_UNKNOWN";
+    }
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <vector>
 #include <iomanip>
 #include <array>
+#include <cstring>
 #include "Value.h"
 
 enum OpCode
@@ -37,9 +38,12 @@ enum OpCode
     OP_SET_INDEX,
     OP_CLOSURE,
     OP_FUNCTION_CALL,
+    OP_TAIL_CALL,
     OP_RETURN,
     OP_GET_BUILTIN,
     OP_STRUCT,
+    // instantiates the struct prototype in the constant list by copying it
+    OP_NEW_STRUCT,
     OP_GET_STRUCT,
     OP_SET_STRUCT,
     OP_REF_GLOBAL,
@@ -48,14 +52,207 @@ enum OpCode
     OP_REF_INDEX_GLOBAL,
     OP_REF_INDEX_LOCAL,
     OP_REF_INDEX_UPVALUE,
+    // refs passed straight to a call,they live on the stack of Allocator::AllocateStackRefObject instead of the gc heap
+    OP_STACK_REF_GLOBAL,
+    OP_STACK_REF_LOCAL,
+    OP_STACK_REF_UPVALUE,
+    OP_STACK_REF_INDEX_GLOBAL,
+    OP_STACK_REF_INDEX_LOCAL,
+    OP_STACK_REF_INDEX_UPVALUE,
+    // a call with stack refs as arguments,the refs the callee may keep are copied to the gc heap first
+    OP_STACK_REF_CALL,
+    // releases the stack refs of the call before
+    OP_RELEASE_STACK_REFS,
+    // adds the u8 operands of a chain of +,a chain of strings is joined at once,see ValueConcat
+    OP_CONCAT,
     OP_DLL_IMPORT,
+    // superinstructions fused from common opcode sequences
+    OP_INC_LOCAL,
+    OP_INC_GLOBAL,
+    OP_JUMP_IF_LESS,
+    OP_JUMP_IF_GREATER,
+    OP_JUMP_IF_EQUAL,
+    OP_JUMP_IF_NOT_LESS,
+    OP_JUMP_IF_NOT_GREATER,
+    OP_JUMP_IF_NOT_EQUAL,
+    // number-only variants the vm quickens the generic opcodes into in place,deoptimized back on a type mismatch
+    OP_ADD_NUM,
+    OP_SUB_NUM,
+    OP_MUL_NUM,
+    OP_DIV_NUM,
+    OP_GREATER_NUM,
+    OP_LESS_NUM,
+    OP_EQUAL_NUM,
+    OP_INC_LOCAL_NUM,
+    OP_INC_GLOBAL_NUM,
+    OP_JUMP_IF_LESS_NUM,
+    OP_JUMP_IF_GREATER_NUM,
+    OP_JUMP_IF_EQUAL_NUM,
+    OP_JUMP_IF_NOT_LESS_NUM,
+    OP_JUMP_IF_NOT_GREATER_NUM,
+    OP_JUMP_IF_NOT_EQUAL_NUM,
+    // OP_GET_BUILTIN resolved to the index of the builtin in BuiltinManager's dense builtin list
+    OP_GET_BUILTIN_INDEX,
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
     OP_JUMP_START,
     OP_JUMP_END,
 #endif
+    // register-based bytecode(-r/--register),run by VM::ExecuteRegister.
+    // R:u8 register of the frame(frame->slot[R]),K:u16 constant index,G:u8 global index,U:u8 upvalue index,J:jump offset
+    OP_R_MOVE,         // R dst,R src
+    OP_R_CONSTANT,     // R dst,K
+    OP_R_ADD,          // R dst,R left,R right
+    OP_R_SUB,
+    OP_R_MUL,
+    OP_R_DIV,
+    OP_R_EQUAL,
+    OP_R_GREATER,
+    OP_R_LESS,
+    OP_R_NOT,          // R dst,R src
+    OP_R_MINUS,
+    OP_R_AND,          // R dst,R left,R right
+    OP_R_OR,
+    OP_R_BIT_AND,
+    OP_R_BIT_OR,
+    OP_R_BIT_NOT,      // R dst,R src
+    OP_R_BIT_XOR,      // R dst,R left,R right
+    OP_R_ADD_CONSTANT, // R dst,R left,K right
+    OP_R_SUB_CONSTANT,
+    OP_R_MUL_CONSTANT,
+    OP_R_JUMP,          // J
+    OP_R_JUMP_IF_FALSE, // R condition,J
+    OP_R_DEF_GLOBAL,    // G,R src
+    OP_R_SET_GLOBAL,    // G,R src
+    OP_R_GET_GLOBAL,    // R dst,G
+    // a local is defined by writing its register directly,a set writes through the ref the local may hold
+    OP_R_SET_LOCAL,     // R dst,R src
+    OP_R_GET_UPVALUE,   // R dst,U
+    OP_R_SET_UPVALUE,   // U,R src
+    OP_R_ARRAY,         // R dst,R first element,u16 count
+    OP_R_GET_INDEX,     // R dst,R ds,R index
+    OP_R_SET_INDEX,     // R ds,R index,R src
+    OP_R_CLOSURE,       // R dst,K function,u8 upvalue count,upvalues like OP_CLOSURE
+    // the callee is in R base and the arguments above it,the result replaces the callee
+    OP_R_FUNCTION_CALL, // R base,u8 argument count
+    OP_R_TAIL_CALL,     // R base,u8 argument count
+    OP_R_RETURN,        // u8 return count,R src
+    OP_R_GET_BUILTIN,   // R dst,K name
+    OP_R_STRUCT,        // R dst,R first member value,u16 count,K name per member
+    OP_R_NEW_STRUCT,    // R dst,K prototype
+    OP_R_GET_STRUCT,    // R dst,R instance,K name,u16 inline cache
+    OP_R_SET_STRUCT,    // R instance,K name,u16 inline cache,R src
+    OP_R_REF_GLOBAL,    // R dst,G
+    OP_R_REF_LOCAL,     // R dst,R
+    OP_R_REF_UPVALUE,   // R dst,U
+    OP_R_REF_INDEX_GLOBAL,   // R dst,G,R index
+    OP_R_REF_INDEX_LOCAL,    // R dst,R,R index
+    OP_R_REF_INDEX_UPVALUE,  // R dst,U,R index
+    OP_R_STACK_REF_GLOBAL,   // same operands as the OP_R_REF_* above
+    OP_R_STACK_REF_LOCAL,
+    OP_R_STACK_REF_UPVALUE,
+    OP_R_STACK_REF_INDEX_GLOBAL,
+    OP_R_STACK_REF_INDEX_LOCAL,
+    OP_R_STACK_REF_INDEX_UPVALUE,
+    OP_R_STACK_REF_CALL,      // R base,u8 argument count
+    // releases the stack refs of the call before and clears its argument registers
+    OP_R_RELEASE_STACK_REFS,  // R base,u8 argument count,u8 stack ref count
+    OP_R_CONCAT,              // R dst,R first,u8 count,operands stored like OP_CONCAT
+    OP_R_DLL_IMPORT,          // K path
+    OP_R_INC_LOCAL,           // R,K
+    OP_R_INC_GLOBAL,          // G,K
+    OP_R_JUMP_IF_LESS,        // R left,R right,J
+    OP_R_JUMP_IF_GREATER,
+    OP_R_JUMP_IF_EQUAL,
+    OP_R_JUMP_IF_NOT_LESS,
+    OP_R_JUMP_IF_NOT_GREATER,
+    OP_R_JUMP_IF_NOT_EQUAL,
+    OP_R_JUMP_IF_LESS_CONSTANT, // R left,K right,J
+    OP_R_JUMP_IF_GREATER_CONSTANT,
+    OP_R_JUMP_IF_EQUAL_CONSTANT,
+    OP_R_JUMP_IF_NOT_LESS_CONSTANT,
+    OP_R_JUMP_IF_NOT_GREATER_CONSTANT,
+    OP_R_JUMP_IF_NOT_EQUAL_CONSTANT,
+    OP_R_ADD_NUM,
+    OP_R_SUB_NUM,
+    OP_R_MUL_NUM,
+    OP_R_DIV_NUM,
+    OP_R_GREATER_NUM,
+    OP_R_LESS_NUM,
+    OP_R_EQUAL_NUM,
+    OP_R_ADD_CONSTANT_NUM,
+    OP_R_SUB_CONSTANT_NUM,
+    OP_R_MUL_CONSTANT_NUM,
+    OP_R_INC_LOCAL_NUM,
+    OP_R_INC_GLOBAL_NUM,
+    OP_R_JUMP_IF_LESS_NUM,
+    OP_R_JUMP_IF_GREATER_NUM,
+    OP_R_JUMP_IF_EQUAL_NUM,
+    OP_R_JUMP_IF_NOT_LESS_NUM,
+    OP_R_JUMP_IF_NOT_GREATER_NUM,
+    OP_R_JUMP_IF_NOT_EQUAL_NUM,
+    OP_R_JUMP_IF_LESS_CONSTANT_NUM,
+    OP_R_JUMP_IF_GREATER_CONSTANT_NUM,
+    OP_R_JUMP_IF_EQUAL_CONSTANT_NUM,
+    OP_R_JUMP_IF_NOT_LESS_CONSTANT_NUM,
+    OP_R_JUMP_IF_NOT_GREATER_CONSTANT_NUM,
+    OP_R_JUMP_IF_NOT_EQUAL_CONSTANT_NUM,
+    OP_R_GET_BUILTIN_INDEX, // R dst,u16 builtin index
+    OP_COUNT,
 };
 
-using OpCodeList = std::vector<int16_t>;
+static_assert(OP_COUNT <= UINT8_MAX + 1, "opcodes are encoded in a single byte");
+
+inline bool IsRegisterOpCode(uint8_t opcode)
+{
+    return opcode >= OP_R_MOVE && opcode < OP_COUNT;
+}
+
+// opcodes take 1 byte,operands are fixed-width per opcode and stored unaligned in native byte order:
+// constant/inline cache indices and element counts are uint16_t,variable indices and arg counts are uint8_t,
+// register operands are uint8_t,jump offsets are int32_t relative to the jump opcode
+using OpCodeList = std::vector<uint8_t>;
+
+template <typename T>
+inline T DecodeOperand(const uint8_t *p)
+{
+    T v;
+    memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+template <typename T>
+inline void EncodeOperand(uint8_t *p, T v)
+{
+    memcpy(p, &v, sizeof(T));
+}
+
+// read an operand of type T at ip and step ip over it
+template <typename T, typename U>
+inline T ReadOperand(U *&ip)
+{
+    T v = DecodeOperand<T>(ip);
+    ip += sizeof(T);
+    return v;
+}
+
+// generic opcode a quickened opcode was specialized from,other opcodes are returned unchanged
+COMPUTEDUCK_API uint8_t GetGenericOpCode(uint8_t opcode);
+// count of bytes taken by the instruction starting at ip,operands included
+COMPUTEDUCK_API uint32_t GetInstructionLength(const uint8_t *ip);
+// offset in bytes from the opcode to its jump offset operand,0 for non-jump instructions
+COMPUTEDUCK_API uint32_t GetJumpAddressOffset(uint8_t opcode);
+// absolute position of the target of the jump instruction at opCodeList[pos]
+COMPUTEDUCK_API size_t GetJumpTarget(const OpCodeList &opCodeList, size_t pos);
+// point the jump instruction at opCodeList[pos] to the absolute position target
+COMPUTEDUCK_API void SetJumpTarget(OpCodeList &opCodeList, size_t pos, size_t target);
+
+// monomorphic inline cache of a OP_GET_STRUCT/OP_SET_STRUCT site,
+// remembers the slot of the member in the shape seen last time
+struct StructInlineCache
+{
+    class Shape *shape{nullptr};
+    int32_t slot{-1};
+};
 
 class COMPUTEDUCK_API Chunk
 {
@@ -73,6 +270,9 @@ public:
 
     std::vector<Value> constants;
 
+    std::vector<StructInlineCache> inlineCaches;
+
 private:
     std::string OpCodeStringify(const OpCodeList &opCodeList);
+    std::string SpecializedOpCodeName(uint8_t opcode);
 };
@@ -1,10 +1,236 @@
 #include "Compiler.h"
-#include <limits>
+#include <algorithm>
 #include "Object.h"
 #include "BuiltinManager.h"
 #include "Allocator.h"
+#include "Config.h"
 
-constexpr int16_t INVALID_OPCODE = std::numeric_limits<int16_t>::max();
+template <typename T>
+static uint32_t AppendOperand(OpCodeList &opCodeList, T operand)
+{
+    auto pos = opCodeList.size();
+    opCodeList.resize(pos + sizeof(T));
+    EncodeOperand(opCodeList.data() + pos, operand);
+    return static_cast<uint32_t>(pos);
+}
+
+// a function chunk needs a trailing return unless its last instruction is a return and no jump lands on its end
+static bool IsNeedTrailingReturn(const OpCodeList &opCodeList)
+{
+    bool isLastReturn = false;
+    for (size_t i = 0; i < opCodeList.size(); i += GetInstructionLength(opCodeList.data() + i))
+    {
+        if (GetJumpAddressOffset(opCodeList[i]) != 0 && GetJumpTarget(opCodeList, i) == opCodeList.size())
+            return true;
+        isLastReturn = opCodeList[i] == OP_RETURN || opCodeList[i] == OP_R_RETURN;
+    }
+    return !isLastReturn;
+}
+
+// fuse hot opcode sequences into superinstructions,a sequence is never fused if a jump lands inside it
+static void FuseSuperInstructions(OpCodeList &opCodeList)
+{
+    std::vector<size_t> instrStarts;
+    std::vector<bool> isJumpTarget(opCodeList.size() + 1, false);
+    for (size_t i = 0; i < opCodeList.size(); i += GetInstructionLength(opCodeList.data() + i))
+    {
+        instrStarts.emplace_back(i);
+        if (GetJumpAddressOffset(opCodeList[i]) != 0)
+            isJumpTarget[GetJumpTarget(opCodeList, i)] = true;
+    }
+
+    // opcode of the k-th instruction from instruction n,or -1 if it is out of range or a jump target
+    auto fusableOpCode = [&](size_t n, size_t k) -> int32_t
+    {
+        if (n + k >= instrStarts.size() || (k > 0 && isJumpTarget[instrStarts[n + k]]))
+            return -1;
+        return opCodeList[instrStarts[n + k]];
+    };
+
+    auto appendBytes = [&](OpCodeList &result, size_t begin, size_t end)
+    {
+        result.insert(result.end(), opCodeList.begin() + begin, opCodeList.begin() + end);
+    };
+
+    OpCodeList result;
+    std::vector<size_t> addressMap(opCodeList.size() + 1, 0);
+    // jumps in the result paired with the old absolute position they target
+    std::vector<std::pair<size_t, size_t>> jumps;
+
+    for (size_t n = 0; n < instrStarts.size();)
+    {
+        auto start = instrStarts[n];
+        addressMap[start] = result.size();
+
+        size_t fusedCount = 0;
+
+        // i=i+k: OP_CONSTANT k,OP_GET_LOCAL i,OP_ADD,OP_SET_LOCAL i
+        if (fusableOpCode(n, 0) == OP_CONSTANT &&
+            (fusableOpCode(n, 1) == OP_GET_LOCAL || fusableOpCode(n, 1) == OP_GET_GLOBAL) &&
+            fusableOpCode(n, 2) == OP_ADD &&
+            fusableOpCode(n, 3) == (fusableOpCode(n, 1) == OP_GET_LOCAL ? OP_SET_LOCAL : OP_SET_GLOBAL) &&
+            opCodeList[instrStarts[n + 1] + 1] == opCodeList[instrStarts[n + 3] + 1])
+        {
+            result.emplace_back(fusableOpCode(n, 1) == OP_GET_LOCAL ? OP_INC_LOCAL : OP_INC_GLOBAL);
+            result.emplace_back(opCodeList[instrStarts[n + 1] + 1]);
+            appendBytes(result, start + 1, start + 1 + sizeof(uint16_t));
+            fusedCount = 4;
+        }
+        // compare and branch: OP_LESS/OP_GREATER/OP_EQUAL,(OP_NOT),OP_JUMP_IF_FALSE
+        else if (fusableOpCode(n, 0) == OP_LESS || fusableOpCode(n, 0) == OP_GREATER || fusableOpCode(n, 0) == OP_EQUAL)
+        {
+            auto compare = fusableOpCode(n, 0);
+            size_t jumpIdx = 0;
+            uint8_t fused = 0;
+            if (fusableOpCode(n, 1) == OP_JUMP_IF_FALSE)
+            {
+                jumpIdx = n + 1;
+                fused = compare == OP_LESS ? OP_JUMP_IF_NOT_LESS : (compare == OP_GREATER ? OP_JUMP_IF_NOT_GREATER : OP_JUMP_IF_NOT_EQUAL);
+            }
+            else if (fusableOpCode(n, 1) == OP_NOT && fusableOpCode(n, 2) == OP_JUMP_IF_FALSE)
+            {
+                jumpIdx = n + 2;
+                fused = compare == OP_LESS ? OP_JUMP_IF_LESS : (compare == OP_GREATER ? OP_JUMP_IF_GREATER : OP_JUMP_IF_EQUAL);
+            }
+
+            if (jumpIdx != 0)
+            {
+                auto jumpStart = instrStarts[jumpIdx];
+                jumps.emplace_back(result.size(), GetJumpTarget(opCodeList, jumpStart));
+                result.emplace_back(fused);
+                appendBytes(result, jumpStart + 1, jumpStart + GetInstructionLength(opCodeList.data() + jumpStart));
+                fusedCount = jumpIdx - n + 1;
+            }
+        }
+
+        if (fusedCount == 0)
+        {
+            if (GetJumpAddressOffset(opCodeList[start]) != 0)
+                jumps.emplace_back(result.size(), GetJumpTarget(opCodeList, start));
+            appendBytes(result, start, start + GetInstructionLength(opCodeList.data() + start));
+            fusedCount = 1;
+        }
+
+        n += fusedCount;
+    }
+    addressMap[opCodeList.size()] = result.size();
+
+    for (const auto &[pos, target] : jumps)
+        SetJumpTarget(result, pos, addressMap[target]);
+
+    opCodeList = result;
+}
+
+// escape analysis of a variable holding a ref:the ref escapes if its value may be stored anywhere
+// that outlives the current call,reading or writing through the ref keeps it local.
+// every use of the variable inside a nested function escapes,the closure may outlive the call
+static bool IsEscaping(Expr *expr, std::string_view name, bool isCaptured);
+static bool IsEscaping(Stmt *stmt, std::string_view name, bool isCaptured);
+
+// the value of the expression is only dereferenced
+static bool IsEscapingOperand(Expr *expr, std::string_view name, bool isCaptured)
+{
+    if (expr->type == AstType::IDENTIFIER)
+        return isCaptured && ((IdentifierExpr *)expr)->literal == name;
+    return IsEscaping(expr, name, isCaptured);
+}
+
+static bool IsEscaping(Expr *expr, std::string_view name, bool isCaptured)
+{
+    switch (expr->type)
+    {
+    case AstType::NUM:
+    case AstType::STR:
+    case AstType::NIL:
+    case AstType::BOOL:
+    case AstType::DLL_IMPORT:
+        return false;
+    case AstType::IDENTIFIER:
+        return ((IdentifierExpr *)expr)->literal == name;
+    case AstType::GROUP:
+        return IsEscaping(((GroupExpr *)expr)->expr, name, isCaptured);
+    case AstType::ARRAY:
+        for (const auto &e : ((ArrayExpr *)expr)->elements)
+            if (IsEscaping(e, name, isCaptured))
+                return true;
+        return false;
+    case AstType::UNARY:
+        return IsEscapingOperand(((UnaryExpr *)expr)->right, name, isCaptured);
+    case AstType::BINARY:
+    {
+        auto binaryExpr = (BinaryExpr *)expr;
+        if (binaryExpr->op != "=")
+            return IsEscapingOperand(binaryExpr->left, name, isCaptured) || IsEscapingOperand(binaryExpr->right, name, isCaptured);
+        // assigning to the variable writes through the ref,assigning it to anything else stores the ref
+        return IsEscapingOperand(binaryExpr->left, name, isCaptured) || IsEscaping(binaryExpr->right, name, isCaptured);
+    }
+    case AstType::INDEX:
+        return IsEscapingOperand(((IndexExpr *)expr)->ds, name, isCaptured) || IsEscaping(((IndexExpr *)expr)->index, name, isCaptured);
+    case AstType::REF:
+    {
+        // a new ref points to the end of the ref chain,not to the ref itself
+        auto refExpr = ((RefExpr *)expr)->refExpr;
+        if (refExpr->type == AstType::INDEX)
+            return IsEscapingOperand(((IndexExpr *)refExpr)->ds, name, isCaptured) || IsEscaping(((IndexExpr *)refExpr)->index, name, isCaptured);
+        return IsEscapingOperand(refExpr, name, isCaptured);
+    }
+    case AstType::FUNCTION:
+        return IsEscaping(((FunctionExpr *)expr)->body, name, true);
+    case AstType::FUNCTION_CALL:
+    {
+        // the callee may keep its arguments
+        auto callExpr = (FunctionCallExpr *)expr;
+        if (IsEscaping(callExpr->name, name, isCaptured))
+            return true;
+        for (const auto &argu : callExpr->arguments)
+            if (IsEscaping(argu, name, isCaptured))
+                return true;
+        return false;
+    }
+    case AstType::STRUCT_CALL:
+        return IsEscapingOperand(((StructCallExpr *)expr)->callee, name, isCaptured);
+    case AstType::STRUCT:
+        for (const auto &[k, v] : ((StructExpr *)expr)->members)
+            if (IsEscaping(v, name, isCaptured))
+                return true;
+        return false;
+    default:
+        return true;
+    }
+}
+
+static bool IsEscaping(Stmt *stmt, std::string_view name, bool isCaptured)
+{
+    switch (stmt->type)
+    {
+    case AstType::EXPR:
+    {
+        // the value of an expression statement is discarded
+        auto expr = ((ExprStmt *)stmt)->expr;
+        return IsEscapingOperand(expr, name, isCaptured);
+    }
+    case AstType::RETURN:
+        return ((ReturnStmt *)stmt)->expr && IsEscaping(((ReturnStmt *)stmt)->expr, name, isCaptured);
+    case AstType::IF:
+    {
+        auto ifStmt = (IfStmt *)stmt;
+        return IsEscapingOperand(ifStmt->condition, name, isCaptured) ||
+               IsEscaping(ifStmt->thenBranch, name, isCaptured) ||
+               (ifStmt->elseBranch && IsEscaping(ifStmt->elseBranch, name, isCaptured));
+    }
+    case AstType::SCOPE:
+        for (const auto &s : ((ScopeStmt *)stmt)->stmts)
+            if (IsEscaping(s, name, isCaptured))
+                return true;
+        return false;
+    case AstType::WHILE:
+        return IsEscapingOperand(((WhileStmt *)stmt)->condition, name, isCaptured) || IsEscaping(((WhileStmt *)stmt)->body, name, isCaptured);
+    case AstType::STRUCT:
+        return IsEscaping(((StructStmt *)stmt)->body, name, isCaptured);
+    default:
+        return true;
+    }
+}
 
 Compiler::~Compiler()
 {
@@ -20,7 +246,13 @@ FunctionObject *Compiler::Compile(const std::vector<Stmt *> &stmts)
     for (const auto &stmt : stmts)
         CompileStmt(stmt);
 
-    auto mainFn = ALLOCATE_OBJECT(FunctionObject, CurChunk(), m_SymbolTable->GetLocalVarCount());
+    // the vm stops at the return of the outermost frame instead of checking the end of chunk per instruction
+    EmitReturn(0);
+
+    if (m_IsFuseSuperInstruction)
+        FuseSuperInstructions(CurChunk().opCodeList);
+
+    auto mainFn = ALLOCATE_OBJECT(FunctionObject, CurChunk(), m_IsUseRegister ? m_SymbolTable->GetRegisterCount() : m_SymbolTable->GetLocalVarCount());
 
     SAFE_DELETE(m_SymbolTable);
 
@@ -37,6 +269,21 @@ void Compiler::ResetStatus()
     SAFE_DELETE(m_SymbolTable);
     m_SymbolTable = new SymbolTable();
 
+    m_IsUseRegister = Config::GetInstance()->IsUseRegister();
+    // register-based bytecode has its own compare jumps and increments
+    m_IsFuseSuperInstruction = !m_IsUseRegister;
+    m_IsUseTailCall = true;
+
+#ifdef COMPUTEDUCK_BUILD_WITH_LLVM
+    // jit compiles the plain opcode sequences and needs a call frame per call,keep them for it.
+    // register-based bytecode is never jit compiled
+    if (!m_IsUseRegister && Config::GetInstance()->IsUseJit())
+    {
+        m_IsFuseSuperInstruction = false;
+        m_IsUseTailCall = false;
+    }
+#endif
+
     DefineBuiltin();
 }
 
@@ -69,45 +316,57 @@ void Compiler::CompileStmt(Stmt *stmt)
 
 void Compiler::CompileExprStmt(ExprStmt *stmt)
 {
+    if (m_IsUseRegister)
+    {
+        auto top = m_SymbolTable->GetRegisterTop();
+        if (stmt->expr->type == AstType::BINARY && ((BinaryExpr *)stmt->expr)->op == "=")
+            CompileAssignExpr((BinaryExpr *)stmt->expr);
+        else
+            CompileExprTo(stmt->expr, m_SymbolTable->AcquireRegister());
+        m_SymbolTable->ReleaseRegisters(top);
+        return;
+    }
+
     CompileExpr(stmt->expr);
 }
 
 void Compiler::CompileIfStmt(IfStmt *stmt)
 {
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
-    Emit(OP_JUMP_START);
-    Emit(JumpMode::IF);
+    if (!m_IsUseRegister)
+    {
+        Emit(OP_JUMP_START);
+        Emit(JumpMode::IF);
+    }
 #endif
 
-    CompileExpr(stmt->condition);
-    Emit(OP_JUMP_IF_FALSE);
-    auto jumpIfFalseAddress = Emit(INVALID_OPCODE);
+    auto jumpIfFalseAddress = CompileConditionJump(stmt->condition);
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
     Emit(JumpMode::IF);
 #endif
 
     CompileStmt(stmt->thenBranch);
 
-    int16_t jumpAddress = -1;
+    uint32_t jumpAddress = 0;
     if (stmt->elseBranch)
     {
-        Emit(OP_JUMP);
-        jumpAddress = Emit(INVALID_OPCODE);
+        jumpAddress = EmitJump(m_IsUseRegister ? OP_R_JUMP : OP_JUMP);
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
         Emit(JumpMode::IF);
 #endif
     }
 
-    ModifyOpCode(jumpIfFalseAddress, (int16_t)CurChunk().opCodeList.size());
+    PatchJump(jumpIfFalseAddress, CurChunk().opCodeList.size());
 
     if (stmt->elseBranch)
     {
         CompileStmt(stmt->elseBranch);
-        ModifyOpCode(jumpAddress, (int16_t)CurChunk().opCodeList.size());
+        PatchJump(jumpAddress, CurChunk().opCodeList.size());
     }
 
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
-    Emit(OP_JUMP_END);
+    if (!m_IsUseRegister)
+        Emit(OP_JUMP_END);
 #endif
 }
 
@@ -124,49 +383,114 @@ void Compiler::CompileScopeStmt(ScopeStmt *stmt)
 void Compiler::CompileWhileStmt(WhileStmt *stmt)
 {
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
-    Emit(OP_JUMP_START);
-    Emit(JumpMode::WHILE);
+    if (!m_IsUseRegister)
+    {
+        Emit(OP_JUMP_START);
+        Emit(JumpMode::WHILE);
+    }
 #endif
 
-    auto jumpAddress = (int32_t)CurChunk().opCodeList.size();
-    CompileExpr(stmt->condition);
-
-    Emit(OP_JUMP_IF_FALSE);
-    auto jumpIfFalseAddress = Emit(INVALID_OPCODE);
+    auto jumpAddress = CurChunk().opCodeList.size();
+    auto jumpIfFalseAddress = CompileConditionJump(stmt->condition);
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
     Emit(JumpMode::WHILE);
 #endif
 
     CompileStmt(stmt->body);
 
-    Emit(OP_JUMP);
-    Emit(jumpAddress);
+    PatchJump(EmitJump(m_IsUseRegister ? OP_R_JUMP : OP_JUMP), jumpAddress);
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
     Emit(JumpMode::WHILE);
 #endif
 
-    ModifyOpCode(jumpIfFalseAddress, (int16_t)CurChunk().opCodeList.size());
+    PatchJump(jumpIfFalseAddress, CurChunk().opCodeList.size());
 }
 
 void Compiler::CompileReturnStmt(ReturnStmt *stmt)
 {
+    if (m_IsUseRegister)
+    {
+        if (!stmt->expr)
+        {
+            EmitReturn(0);
+            return;
+        }
+
+        auto top = m_SymbolTable->GetRegisterTop();
+        auto reg = CompileToRegister(stmt->expr);
+
+        // like the stack-based tail call,only a call compiled right into the returned register qualifies,
+        // the outermost frame has no window below its slot to move the callee into
+        if (m_IsUseTailCall && m_SymbolTable->GetUpper() && stmt->expr->type == AstType::FUNCTION_CALL && m_LastCallPos + 3 == CurChunk().opCodeList.size())
+        {
+            ModifyOpCode(m_LastCallPos, OP_R_TAIL_CALL);
+            m_TailCallPositions.emplace_back(m_LastCallPos);
+        }
+
+        EmitReturn(1, reg);
+        m_SymbolTable->ReleaseRegisters(top);
+        return;
+    }
+
     if (stmt->expr)
     {
         CompileExpr(stmt->expr);
+
+        // return f(...):the callee reuses the frame of the current function,
+        // the OP_RETURN is only reached if the vm has to fall back to a regular call
+        if (m_IsUseTailCall && stmt->expr->type == AstType::FUNCTION_CALL && m_LastCallPos + 2 == CurChunk().opCodeList.size())
+        {
+            ModifyOpCode(m_LastCallPos, OP_TAIL_CALL);
+            m_TailCallPositions.emplace_back(m_LastCallPos);
+        }
+
         Emit(OP_RETURN);
         Emit(1);
     }
     else
-    {
-        Emit(OP_RETURN);
-        Emit(0);
-    }
+        EmitReturn(0);
 }
 
 void Compiler::CompileStructStmt(StructStmt *stmt)
 {
+    // the struct is instantiated by copying its prototype,no constructor is needed
+    if (auto prototype = CompileStructPrototype(stmt->body))
+    {
+        m_SymbolTable->Define(stmt->name, true, prototype);
+        return;
+    }
+
     auto symbol = m_SymbolTable->Define(stmt->name, true);
 
+    if (m_IsUseRegister)
+    {
+        // the constructor gets a symbol table of its own,its frame holds the registers of the struct members
+        auto top = m_SymbolTable->GetRegisterTop();
+        auto dst = symbol.scope == SymbolScope::LOCAL ? symbol.index : m_SymbolTable->AcquireRegister();
+
+        m_SymbolTable = new SymbolTable(m_SymbolTable);
+        m_ScopeChunks.emplace_back(Chunk());
+
+        auto reg = m_SymbolTable->AcquireRegister();
+        CompileStructExprTo(stmt->body, reg);
+        EmitReturn(1, reg);
+
+        auto chunk = m_ScopeChunks.back();
+        m_ScopeChunks.pop_back();
+
+        auto fn = ALLOCATE_OBJECT(FunctionObject, chunk, m_SymbolTable->GetRegisterCount());
+        EmitClosure(fn, dst);
+
+        auto tmpTable = m_SymbolTable;
+        m_SymbolTable = m_SymbolTable->GetUpper();
+        SAFE_DELETE(tmpTable);
+
+        if (symbol.scope != SymbolScope::LOCAL)
+            StoreSymbolFrom(symbol, dst);
+        m_SymbolTable->ReleaseRegisters(top);
+        return;
+    }
+
     m_ScopeChunks.emplace_back(Chunk());
 
     CompileStructExpr(stmt->body);
@@ -234,6 +558,8 @@ void Compiler::CompileBinaryExpr(BinaryExpr *expr)
         CompileExpr(expr->right);
         CompileExpr(expr->left, RWState::WRITE);
     }
+    else if (expr->op == "+" && CompileConcatExpr(expr))
+        return;
     else
     {
         CompileExpr(expr->right);
@@ -281,9 +607,48 @@ void Compiler::CompileBinaryExpr(BinaryExpr *expr)
     }
 }
 
+// operands of the left leaning chain ((a+b)+c)+d,from left to right
+static void CollectAddOperands(Expr *expr, std::vector<Expr *> &operands)
+{
+    if (expr->type == AstType::BINARY && ((BinaryExpr *)expr)->op == "+")
+    {
+        CollectAddOperands(((BinaryExpr *)expr)->left, operands);
+        operands.emplace_back(((BinaryExpr *)expr)->right);
+    }
+    else
+        operands.emplace_back(expr);
+}
+
+bool Compiler::CompileConcatExpr(BinaryExpr *expr)
+{
+    std::vector<Expr *> operands;
+    CollectAddOperands(expr, operands);
+
+    // a chain without a string literal is most likely arithmetic,which OP_ADD quickens
+    bool hasStr = std::any_of(operands.begin(), operands.end(), [](Expr *e)
+                              { return e->type == AstType::STR; });
+    if (operands.size() < 3 || operands.size() > UINT8_MAX || !hasStr)
+        return false;
+
+    // evaluated from right to left like the nested OP_ADDs
+    for (auto iter = operands.rbegin(); iter != operands.rend(); ++iter)
+        CompileExpr(*iter);
+
+    Emit(OP_CONCAT);
+    Emit(static_cast<uint8_t>(operands.size()));
+    return true;
+}
+
+static Value NumExprToValue(NumExpr *expr)
+{
+    if (expr->isInteger)
+        return Value(expr->integer);
+    return Value(expr->value);
+}
+
 void Compiler::CompileNumExpr(NumExpr *expr)
 {
-    EmitConstant(expr->value);
+    EmitConstant(NumExprToValue(expr));
 }
 
 void Compiler::CompileBoolExpr(BoolExpr *expr)
@@ -312,7 +677,7 @@ void Compiler::CompileUnaryExpr(UnaryExpr *expr)
 
 void Compiler::CompileStrExpr(StrExpr *expr)
 {
-    EmitConstant(ALLOCATE_OBJECT(StrObject, expr->value.c_str()));
+    EmitConstant(ALLOCATE_STR_OBJECT(expr->value.c_str()));
 }
 
 void Compiler::CompileNilExpr(NilExpr *expr)
@@ -331,7 +696,7 @@ void Compiler::CompileArrayExpr(ArrayExpr *expr)
         CompileExpr(e);
 
     Emit(OP_ARRAY);
-    Emit(static_cast<int16_t>(expr->elements.size()));
+    EmitU16(static_cast<uint16_t>(expr->elements.size()));
 }
 
 void Compiler::CompileIndexExpr(IndexExpr *expr, const RWState &state)
@@ -366,34 +731,57 @@ void Compiler::CompileIdentifierExpr(IdentifierExpr *expr, const RWState &state)
     }
 }
 
-void Compiler::CompileFunctionExpr(FunctionExpr *expr)
+void Compiler::CompileFunctionExpr(FunctionExpr *expr, uint8_t dst)
 {
     m_SymbolTable = new SymbolTable(m_SymbolTable);
 
     m_ScopeChunks.emplace_back(Chunk());
 
+    auto tailCallPositions = std::move(m_TailCallPositions);
+    auto isRefLocal = m_IsRefLocal;
+    m_TailCallPositions.clear();
+    m_IsRefLocal = false;
+
     for (const auto &param : expr->parameters)
         m_SymbolTable->Define(param->literal);
 
     for (const auto &s : expr->body->stmts)
         CompileStmt(s);
 
-    auto localVarCount = m_SymbolTable->GetLocalVarCount();
+    auto localVarCount = m_IsUseRegister ? m_SymbolTable->GetRegisterCount() : m_SymbolTable->GetLocalVarCount();
     auto parameterCount = static_cast<uint8_t>(expr->parameters.size());
 
     auto chunk = m_ScopeChunks.back();
     m_ScopeChunks.pop_back();
 
+    if (m_IsRefLocal)
+        for (auto pos : m_TailCallPositions)
+            chunk.opCodeList[pos] = m_IsUseRegister ? OP_R_FUNCTION_CALL : OP_FUNCTION_CALL;
+
+    m_TailCallPositions = std::move(tailCallPositions);
+    m_IsRefLocal = isRefLocal;
+
     // for non return  or empty stmt in function scope:add a return to return nothing
-    if (chunk.opCodeList.empty() || chunk.opCodeList[chunk.opCodeList.size() - 2] != OP_RETURN)
+    if (IsNeedTrailingReturn(chunk.opCodeList))
     {
-        chunk.opCodeList.emplace_back(OP_RETURN);
+        chunk.opCodeList.emplace_back(m_IsUseRegister ? OP_R_RETURN : OP_RETURN);
         chunk.opCodeList.emplace_back(0);
+        if (m_IsUseRegister)
+            chunk.opCodeList.emplace_back(0);
     }
 
-    auto fn = ALLOCATE_OBJECT(FunctionObject, chunk, localVarCount, parameterCount);
+    if (m_IsFuseSuperInstruction)
+        FuseSuperInstructions(chunk.opCodeList);
 
-    EmitClosure(fn);
+    // a ref passed as a non escaping parameter can stay a stack ref,see OP_STACK_REF_CALL
+    uint64_t escapingParamMask = UINT64_MAX;
+    for (size_t i = 0; i < expr->parameters.size() && i < 64; ++i)
+        if (!IsEscaping(expr->body, expr->parameters[i]->literal, false))
+            escapingParamMask &= ~((uint64_t)1 << i);
+
+    auto fn = ALLOCATE_OBJECT(FunctionObject, chunk, localVarCount, parameterCount, escapingParamMask);
+
+    EmitClosure(fn, dst);
 
     auto tmpTable = m_SymbolTable;
     m_SymbolTable = m_SymbolTable->GetUpper();
@@ -404,26 +792,48 @@ void Compiler::CompileFunctionCallExpr(FunctionCallExpr *expr)
 {
     CompileExpr(expr->name);
 
+    // a ref argument lives no longer than the call,unless the callee keeps it
+    uint8_t stackRefCount = 0;
     for (const auto &argu : expr->arguments)
-        CompileExpr(argu);
+    {
+        if (argu->type == AstType::REF)
+        {
+            CompileRefExpr((RefExpr *)argu, true);
+            stackRefCount++;
+        }
+        else
+            CompileExpr(argu);
+    }
 
-    Emit(OP_FUNCTION_CALL);
-    Emit(static_cast<int16_t>(expr->arguments.size()));
+    if (stackRefCount == 0)
+    {
+        m_LastCallPos = Emit(OP_FUNCTION_CALL);
+        Emit(static_cast<uint8_t>(expr->arguments.size()));
+    }
+    else
+    {
+        m_LastCallPos = UINT32_MAX;
+        Emit(OP_STACK_REF_CALL);
+        Emit(static_cast<uint8_t>(expr->arguments.size()));
+        Emit(OP_RELEASE_STACK_REFS);
+        Emit(stackRefCount);
+    }
 }
 
 void Compiler::CompileStructCallExpr(StructCallExpr *expr, const RWState &state)
 {
     CompileExpr(expr->callee);
 
-    EmitConstant(ALLOCATE_OBJECT(StrObject, ((IdentifierExpr *)expr->callMember)->literal.c_str()));
+    EmitConstant(ALLOCATE_NAME_STR_OBJECT(((IdentifierExpr *)expr->callMember)->literal.c_str()));
     
     if (state == RWState::READ)
         Emit(OP_GET_STRUCT);
     else
         Emit(OP_SET_STRUCT);
+    EmitU16(AddInlineCache());
 }
 
-void Compiler::CompileRefExpr(RefExpr *expr)
+void Compiler::CompileRefExpr(RefExpr *expr, bool isStackRef)
 {
     Symbol symbol;
     if (expr->refExpr->type == AstType::INDEX)
@@ -432,7 +842,7 @@ void Compiler::CompileRefExpr(RefExpr *expr)
         bool isFound = m_SymbolTable->Resolve(((IndexExpr *)expr->refExpr)->ds->Stringify(), symbol);
         if (!isFound)
             ASSERT("Undefined variable:%s", expr->Stringify().c_str());
-        RefSymbol(symbol, true);
+        RefSymbol(symbol, true, isStackRef);
     }
     else
     {
@@ -440,20 +850,66 @@ void Compiler::CompileRefExpr(RefExpr *expr)
         if (!isFound)
             ASSERT("Undefined variable:%s", expr->Stringify().c_str());
 
-        RefSymbol(symbol, false);
+        RefSymbol(symbol, false, isStackRef);
     }
 }
 
 void Compiler::CompileStructExpr(StructExpr *expr)
 {
-    for (const auto &[k, v] : expr->members)
+    if (auto prototype = CompileStructPrototype(expr))
+    {
+        Emit(OP_NEW_STRUCT);
+        EmitU16(AddConstant(prototype));
+        return;
+    }
+
+    // emit members in name order,so that every literal with the same member names gets the same shape
+    std::vector<std::pair<IdentifierExpr *, Expr *>> members(expr->members.begin(), expr->members.end());
+    std::sort(members.begin(), members.end(), [](const auto &l, const auto &r)
+              { return l.first->literal < r.first->literal; });
+
+    for (const auto &[k, v] : members)
     {
         CompileExpr(v);
-        EmitConstant(ALLOCATE_OBJECT(StrObject, k->literal.c_str()));
+        EmitConstant(ALLOCATE_NAME_STR_OBJECT(k->literal.c_str()));
     }
 
     Emit(OP_STRUCT);
-    Emit(static_cast<int16_t>(expr->members.size()));
+    EmitU16(static_cast<uint16_t>(expr->members.size()));
+}
+
+StructObject *Compiler::CompileStructPrototype(StructExpr *expr)
+{
+    if (expr->members.size() > SHAPE_MAX_FIELD_COUNT)
+        return nullptr;
+
+    for (const auto &[k, v] : expr->members)
+        if (v->type != AstType::NUM && v->type != AstType::STR && v->type != AstType::BOOL && v->type != AstType::NIL)
+            return nullptr;
+
+    // members in name order like CompileStructExpr,so the prototype gets the same shape as the literal would
+    std::vector<std::pair<IdentifierExpr *, Expr *>> members(expr->members.begin(), expr->members.end());
+    std::sort(members.begin(), members.end(), [](const auto &l, const auto &r)
+              { return l.first->literal < r.first->literal; });
+
+    Shape *shape = Shape::GetRoot();
+    Value fields[SHAPE_MAX_FIELD_COUNT];
+    for (const auto &[k, v] : members)
+    {
+        Value value;
+        if (v->type == AstType::NUM)
+            value = NumExprToValue((NumExpr *)v);
+        else if (v->type == AstType::STR)
+            value = ALLOCATE_STR_OBJECT(((StrExpr *)v)->value.c_str());
+        else if (v->type == AstType::BOOL)
+            value = ((BoolExpr *)v)->value;
+
+        auto name = ALLOCATE_NAME_STR_OBJECT(k->literal.c_str());
+        shape = shape->Transition(name);
+        fields[shape->FindSlot(name)] = value;
+    }
+
+    return ALLOCATE_STRUCT_OBJECT(shape, fields);
 }
 
 void Compiler::CompileDllImportExpr(DllImportExpr *expr)
@@ -464,10 +920,513 @@ void Compiler::CompileDllImportExpr(DllImportExpr *expr)
 
     DefineBuiltin();
 
-    EmitConstant(ALLOCATE_OBJECT(StrObject, dllpath.c_str()));
+    if (m_IsUseRegister)
+    {
+        Emit(OP_R_DLL_IMPORT);
+        EmitU16(AddConstant(ALLOCATE_STR_OBJECT(dllpath.c_str())));
+        return;
+    }
+
+    EmitConstant(ALLOCATE_STR_OBJECT(dllpath.c_str()));
     Emit(OP_DLL_IMPORT);
 }
 
+// the expression may write a variable,an element or a member,a local read in place before it is evaluated has to be copied first
+static bool IsHasSideEffect(Expr *expr)
+{
+    switch (expr->type)
+    {
+    case AstType::FUNCTION_CALL:
+    case AstType::DLL_IMPORT:
+        return true;
+    case AstType::GROUP:
+        return IsHasSideEffect(((GroupExpr *)expr)->expr);
+    case AstType::ARRAY:
+        return std::any_of(((ArrayExpr *)expr)->elements.begin(), ((ArrayExpr *)expr)->elements.end(), IsHasSideEffect);
+    case AstType::UNARY:
+        return IsHasSideEffect(((UnaryExpr *)expr)->right);
+    case AstType::BINARY:
+        return ((BinaryExpr *)expr)->op == "=" || IsHasSideEffect(((BinaryExpr *)expr)->left) || IsHasSideEffect(((BinaryExpr *)expr)->right);
+    case AstType::INDEX:
+        return IsHasSideEffect(((IndexExpr *)expr)->ds) || IsHasSideEffect(((IndexExpr *)expr)->index);
+    case AstType::STRUCT_CALL:
+        return IsHasSideEffect(((StructCallExpr *)expr)->callee);
+    case AstType::REF:
+        return IsHasSideEffect(((RefExpr *)expr)->refExpr);
+    case AstType::STRUCT:
+        for (const auto &[k, v] : ((StructExpr *)expr)->members)
+            if (IsHasSideEffect(v))
+                return true;
+        return false;
+    default:
+        return false;
+    }
+}
+
+// the register compare jump taken if the comparison is false,like the fused stack-based compare jumps
+static OpCode GetRegisterCompareJump(const std::string &op, bool isConstant)
+{
+    if (op == "<")
+        return isConstant ? OP_R_JUMP_IF_NOT_LESS_CONSTANT : OP_R_JUMP_IF_NOT_LESS;
+    if (op == ">")
+        return isConstant ? OP_R_JUMP_IF_NOT_GREATER_CONSTANT : OP_R_JUMP_IF_NOT_GREATER;
+    if (op == "==")
+        return isConstant ? OP_R_JUMP_IF_NOT_EQUAL_CONSTANT : OP_R_JUMP_IF_NOT_EQUAL;
+    if (op == ">=")
+        return isConstant ? OP_R_JUMP_IF_LESS_CONSTANT : OP_R_JUMP_IF_LESS;
+    if (op == "<=")
+        return isConstant ? OP_R_JUMP_IF_GREATER_CONSTANT : OP_R_JUMP_IF_GREATER;
+    if (op == "!=")
+        return isConstant ? OP_R_JUMP_IF_EQUAL_CONSTANT : OP_R_JUMP_IF_EQUAL;
+    return OP_R_JUMP_IF_FALSE;
+}
+
+uint32_t Compiler::CompileConditionJump(Expr *condition)
+{
+    if (!m_IsUseRegister)
+    {
+        CompileExpr(condition);
+        return EmitJump(OP_JUMP_IF_FALSE);
+    }
+
+    auto top = m_SymbolTable->GetRegisterTop();
+
+    while (condition->type == AstType::GROUP)
+        condition = ((GroupExpr *)condition)->expr;
+
+    auto compareJump = condition->type == AstType::BINARY ? GetRegisterCompareJump(((BinaryExpr *)condition)->op, ((BinaryExpr *)condition)->right->type == AstType::NUM) : OP_R_JUMP_IF_FALSE;
+    uint32_t pos = 0;
+    if (compareJump == OP_R_JUMP_IF_FALSE)
+    {
+        auto reg = CompileToRegister(condition);
+        pos = Emit(OP_R_JUMP_IF_FALSE);
+        Emit(reg);
+    }
+    else if (((BinaryExpr *)condition)->right->type == AstType::NUM)
+    {
+        auto binaryExpr = (BinaryExpr *)condition;
+        auto l = CompileToRegister(binaryExpr->left);
+        pos = Emit(compareJump);
+        Emit(l);
+        EmitU16(AddConstant(NumExprToValue((NumExpr *)binaryExpr->right)));
+    }
+    else
+    {
+        auto binaryExpr = (BinaryExpr *)condition;
+        auto r = CompileToRegister(binaryExpr->right, IsHasSideEffect(binaryExpr->left));
+        auto l = CompileToRegister(binaryExpr->left);
+        pos = Emit(compareJump);
+        Emit(l);
+        Emit(r);
+    }
+    EmitI32(0);
+
+    m_SymbolTable->ReleaseRegisters(top);
+    return pos;
+}
+
+uint8_t Compiler::CompileToRegister(Expr *expr, bool isCopyLocal)
+{
+    while (expr->type == AstType::GROUP)
+        expr = ((GroupExpr *)expr)->expr;
+
+    Symbol symbol;
+    if (!isCopyLocal && expr->type == AstType::IDENTIFIER && m_SymbolTable->Resolve(((IdentifierExpr *)expr)->literal, symbol) &&
+        symbol.scope == SymbolScope::LOCAL && !symbol.isStructSymbol && !symbol.structPrototype)
+        return symbol.index;
+
+    auto reg = m_SymbolTable->AcquireRegister();
+    CompileExprTo(expr, reg);
+    return reg;
+}
+
+void Compiler::CompileExprTo(Expr *expr, uint8_t dst)
+{
+    auto top = m_SymbolTable->GetRegisterTop();
+
+    switch (expr->type)
+    {
+    case AstType::NUM:
+        EmitConstantTo(dst, NumExprToValue((NumExpr *)expr));
+        break;
+    case AstType::STR:
+        EmitConstantTo(dst, ALLOCATE_STR_OBJECT(((StrExpr *)expr)->value.c_str()));
+        break;
+    case AstType::BOOL:
+        EmitConstantTo(dst, ((BoolExpr *)expr)->value);
+        break;
+    case AstType::NIL:
+        EmitConstantTo(dst, Value());
+        break;
+    case AstType::IDENTIFIER:
+    {
+        Symbol symbol;
+        if (!m_SymbolTable->Resolve(((IdentifierExpr *)expr)->literal, symbol))
+            ASSERT("Undefined variable:%s", expr->Stringify().c_str());
+        LoadSymbolTo(symbol, dst);
+        break;
+    }
+    case AstType::GROUP:
+        CompileExprTo(((GroupExpr *)expr)->expr, dst);
+        break;
+    case AstType::ARRAY:
+    {
+        auto arrayExpr = (ArrayExpr *)expr;
+        // the elements in consecutive registers,one acquired per element so that a call can use it as its window
+        auto first = m_SymbolTable->GetRegisterTop();
+        for (const auto &e : arrayExpr->elements)
+            CompileExprTo(e, m_SymbolTable->AcquireRegister());
+        Emit(OP_R_ARRAY);
+        Emit(dst);
+        Emit(first);
+        EmitU16(static_cast<uint16_t>(arrayExpr->elements.size()));
+        break;
+    }
+    case AstType::INDEX:
+    {
+        auto indexExpr = (IndexExpr *)expr;
+        auto ds = CompileToRegister(indexExpr->ds, IsHasSideEffect(indexExpr->index));
+        auto index = CompileToRegister(indexExpr->index);
+        Emit(OP_R_GET_INDEX);
+        Emit(dst);
+        Emit(ds);
+        Emit(index);
+        break;
+    }
+    case AstType::UNARY:
+    {
+        auto unaryExpr = (UnaryExpr *)expr;
+        auto reg = CompileToRegister(unaryExpr->right);
+        if (unaryExpr->op == "-")
+            Emit(OP_R_MINUS);
+        else if (unaryExpr->op == "~")
+            Emit(OP_R_BIT_NOT);
+        else if (unaryExpr->op == "not")
+            Emit(OP_R_NOT);
+        else
+            ASSERT("Unrecognized prefix type.");
+        Emit(dst);
+        Emit(reg);
+        break;
+    }
+    case AstType::BINARY:
+        CompileBinaryExprTo((BinaryExpr *)expr, dst);
+        break;
+    case AstType::FUNCTION_CALL:
+        CompileFunctionCallExprTo((FunctionCallExpr *)expr, dst);
+        break;
+    case AstType::STRUCT_CALL:
+    {
+        auto structCallExpr = (StructCallExpr *)expr;
+        auto instance = CompileToRegister(structCallExpr->callee);
+        Emit(OP_R_GET_STRUCT);
+        Emit(dst);
+        Emit(instance);
+        EmitU16(AddConstant(ALLOCATE_NAME_STR_OBJECT(((IdentifierExpr *)structCallExpr->callMember)->literal.c_str())));
+        EmitU16(AddInlineCache());
+        break;
+    }
+    case AstType::REF:
+        CompileRefExprTo((RefExpr *)expr, dst);
+        break;
+    case AstType::FUNCTION:
+        CompileFunctionExpr((FunctionExpr *)expr, dst);
+        break;
+    case AstType::STRUCT:
+        CompileStructExprTo((StructExpr *)expr, dst);
+        break;
+    case AstType::DLL_IMPORT:
+        CompileDllImportExpr((DllImportExpr *)expr);
+        break;
+    default:
+        ASSERT("Unknown expr.");
+    }
+
+    m_SymbolTable->ReleaseRegisters(top);
+}
+
+void Compiler::CompileAssignExpr(BinaryExpr *expr)
+{
+    auto top = m_SymbolTable->GetRegisterTop();
+
+    if (expr->left->type == AstType::IDENTIFIER)
+    {
+        const auto &name = ((IdentifierExpr *)expr->left)->literal;
+        if (expr->right->type == AstType::FUNCTION)
+            m_SymbolTable->Define(name);
+
+        Symbol symbol;
+        bool isFound = m_SymbolTable->Resolve(name, symbol);
+
+        // x=x+k
+        NumExpr *increment = nullptr;
+        if (isFound && (symbol.scope == SymbolScope::LOCAL || symbol.scope == SymbolScope::GLOBAL) && !symbol.isStructSymbol &&
+            expr->right->type == AstType::BINARY)
+        {
+            auto addExpr = (BinaryExpr *)expr->right;
+            if (addExpr->op == "+" && addExpr->right->type == AstType::NUM &&
+                addExpr->left->type == AstType::IDENTIFIER && ((IdentifierExpr *)addExpr->left)->literal == name)
+                increment = (NumExpr *)addExpr->right;
+        }
+
+        if (!isFound)
+        {
+            // a new local takes the register its value is compiled to
+            auto reg = m_SymbolTable->AcquireRegister();
+            CompileExprTo(expr->right, reg);
+            m_SymbolTable->ReleaseRegisters(top);
+
+            symbol = m_SymbolTable->Define(name);
+            if (symbol.scope == SymbolScope::GLOBAL)
+            {
+                Emit(OP_R_DEF_GLOBAL);
+                Emit(symbol.index);
+                Emit(reg);
+            }
+            else if (symbol.index != reg)
+            {
+                Emit(OP_R_MOVE);
+                Emit(symbol.index);
+                Emit(reg);
+            }
+        }
+        else if (increment)
+        {
+            Emit(symbol.scope == SymbolScope::LOCAL ? OP_R_INC_LOCAL : OP_R_INC_GLOBAL);
+            Emit(symbol.index);
+            EmitU16(AddConstant(NumExprToValue(increment)));
+        }
+        else if (expr->right->type == AstType::FUNCTION && symbol.scope == SymbolScope::LOCAL)
+            CompileExprTo(expr->right, symbol.index); // the local was defined right before,the closure goes straight to its register
+        else
+            StoreSymbolFrom(symbol, CompileToRegister(expr->right));
+    }
+    else if (expr->left->type == AstType::INDEX)
+    {
+        auto indexExpr = (IndexExpr *)expr->left;
+        auto src = CompileToRegister(expr->right, IsHasSideEffect(indexExpr));
+        auto ds = CompileToRegister(indexExpr->ds, IsHasSideEffect(indexExpr->index));
+        auto index = CompileToRegister(indexExpr->index);
+        Emit(OP_R_SET_INDEX);
+        Emit(ds);
+        Emit(index);
+        Emit(src);
+    }
+    else if (expr->left->type == AstType::STRUCT_CALL)
+    {
+        auto structCallExpr = (StructCallExpr *)expr->left;
+        auto src = CompileToRegister(expr->right, IsHasSideEffect(structCallExpr->callee));
+        auto instance = CompileToRegister(structCallExpr->callee);
+        Emit(OP_R_SET_STRUCT);
+        Emit(instance);
+        EmitU16(AddConstant(ALLOCATE_NAME_STR_OBJECT(((IdentifierExpr *)structCallExpr->callMember)->literal.c_str())));
+        EmitU16(AddInlineCache());
+        Emit(src);
+    }
+    else
+    {
+        CompileExprTo(expr->right, m_SymbolTable->AcquireRegister());
+        CompileExprTo(expr->left, m_SymbolTable->AcquireRegister());
+    }
+
+    m_SymbolTable->ReleaseRegisters(top);
+}
+
+void Compiler::CompileBinaryExprTo(BinaryExpr *expr, uint8_t dst)
+{
+    if (expr->op == "=")
+        return CompileAssignExpr(expr);
+    if (expr->op == "+" && CompileConcatExprTo(expr, dst))
+        return;
+
+    if ((expr->op == "+" || expr->op == "-" || expr->op == "*") && expr->right->type == AstType::NUM)
+    {
+        auto l = CompileToRegister(expr->left);
+        Emit(expr->op == "+" ? OP_R_ADD_CONSTANT : (expr->op == "-" ? OP_R_SUB_CONSTANT : OP_R_MUL_CONSTANT));
+        Emit(dst);
+        Emit(l);
+        EmitU16(AddConstant(NumExprToValue((NumExpr *)expr->right)));
+        return;
+    }
+
+    // the right operand is evaluated first like in the stack-based bytecode
+    auto r = CompileToRegister(expr->right, IsHasSideEffect(expr->left));
+    auto l = CompileToRegister(expr->left);
+
+    bool isNot = false;
+    if (expr->op == "+")
+        Emit(OP_R_ADD);
+    else if (expr->op == "-")
+        Emit(OP_R_SUB);
+    else if (expr->op == "*")
+        Emit(OP_R_MUL);
+    else if (expr->op == "/")
+        Emit(OP_R_DIV);
+    else if (expr->op == ">")
+        Emit(OP_R_GREATER);
+    else if (expr->op == "<")
+        Emit(OP_R_LESS);
+    else if (expr->op == "&")
+        Emit(OP_R_BIT_AND);
+    else if (expr->op == "|")
+        Emit(OP_R_BIT_OR);
+    else if (expr->op == "^")
+        Emit(OP_R_BIT_XOR);
+    else if (expr->op == ">=")
+    {
+        Emit(OP_R_LESS);
+        isNot = true;
+    }
+    else if (expr->op == "<=")
+    {
+        Emit(OP_R_GREATER);
+        isNot = true;
+    }
+    else if (expr->op == "==")
+        Emit(OP_R_EQUAL);
+    else if (expr->op == "!=")
+    {
+        Emit(OP_R_EQUAL);
+        isNot = true;
+    }
+    else if (expr->op == "and")
+        Emit(OP_R_AND);
+    else if (expr->op == "or")
+        Emit(OP_R_OR);
+    else
+        ASSERT("Unknown binary op:%s", expr->op.c_str());
+
+    Emit(dst);
+    Emit(l);
+    Emit(r);
+
+    if (isNot)
+    {
+        Emit(OP_R_NOT);
+        Emit(dst);
+        Emit(dst);
+    }
+}
+
+bool Compiler::CompileConcatExprTo(BinaryExpr *expr, uint8_t dst)
+{
+    std::vector<Expr *> operands;
+    CollectAddOperands(expr, operands);
+
+    bool hasStr = std::any_of(operands.begin(), operands.end(), [](Expr *e)
+                              { return e->type == AstType::STR; });
+    if (operands.size() < 3 || operands.size() > UINT8_MAX || !hasStr)
+        return false;
+
+    // the rightmost operand in the first register,like on the stack
+    auto count = static_cast<uint8_t>(operands.size());
+    auto first = m_SymbolTable->GetRegisterTop();
+    for (auto iter = operands.rbegin(); iter != operands.rend(); ++iter)
+        CompileExprTo(*iter, m_SymbolTable->AcquireRegister());
+
+    Emit(OP_R_CONCAT);
+    Emit(dst);
+    Emit(first);
+    Emit(count);
+    return true;
+}
+
+void Compiler::CompileFunctionCallExprTo(FunctionCallExpr *expr, uint8_t dst)
+{
+    auto argCount = static_cast<uint8_t>(expr->arguments.size());
+
+    // the callee and its arguments in consecutive registers,a temporary on the top is reused as the window
+    uint8_t base = dst;
+    if (dst + 1 != m_SymbolTable->GetRegisterTop() || dst < m_SymbolTable->GetLocalVarCount())
+        base = m_SymbolTable->AcquireRegister();
+
+    CompileExprTo(expr->name, base);
+
+    // one register acquired per argument,so that a call in an argument uses it as its window
+    uint8_t stackRefCount = 0;
+    for (const auto &argu : expr->arguments)
+    {
+        if (argu->type == AstType::REF)
+        {
+            CompileRefExprTo((RefExpr *)argu, m_SymbolTable->AcquireRegister(), true);
+            stackRefCount++;
+        }
+        else
+            CompileExprTo(argu, m_SymbolTable->AcquireRegister());
+    }
+
+    if (stackRefCount == 0)
+    {
+        m_LastCallPos = Emit(OP_R_FUNCTION_CALL);
+        Emit(base);
+        Emit(argCount);
+    }
+    else
+    {
+        m_LastCallPos = UINT32_MAX;
+        Emit(OP_R_STACK_REF_CALL);
+        Emit(base);
+        Emit(argCount);
+        Emit(OP_R_RELEASE_STACK_REFS);
+        Emit(base);
+        Emit(argCount);
+        Emit(stackRefCount);
+    }
+
+    if (base != dst)
+    {
+        Emit(OP_R_MOVE);
+        Emit(dst);
+        Emit(base);
+    }
+}
+
+void Compiler::CompileRefExprTo(RefExpr *expr, uint8_t dst, bool isStackRef)
+{
+    Symbol symbol;
+    if (expr->refExpr->type == AstType::INDEX)
+    {
+        auto index = CompileToRegister(((IndexExpr *)expr->refExpr)->index);
+        if (!m_SymbolTable->Resolve(((IndexExpr *)expr->refExpr)->ds->Stringify(), symbol))
+            ASSERT("Undefined variable:%s", expr->Stringify().c_str());
+        RefSymbolTo(symbol, dst, true, isStackRef);
+        Emit(index);
+    }
+    else
+    {
+        if (!m_SymbolTable->Resolve(expr->refExpr->Stringify(), symbol))
+            ASSERT("Undefined variable:%s", expr->Stringify().c_str());
+        RefSymbolTo(symbol, dst, false, isStackRef);
+    }
+}
+
+void Compiler::CompileStructExprTo(StructExpr *expr, uint8_t dst)
+{
+    if (auto prototype = CompileStructPrototype(expr))
+    {
+        Emit(OP_R_NEW_STRUCT);
+        Emit(dst);
+        EmitU16(AddConstant(prototype));
+        return;
+    }
+
+    // members in name order like CompileStructExpr
+    std::vector<std::pair<IdentifierExpr *, Expr *>> members(expr->members.begin(), expr->members.end());
+    std::sort(members.begin(), members.end(), [](const auto &l, const auto &r)
+              { return l.first->literal < r.first->literal; });
+
+    auto first = m_SymbolTable->GetRegisterTop();
+    for (const auto &[k, v] : members)
+        CompileExprTo(v, m_SymbolTable->AcquireRegister());
+
+    Emit(OP_R_STRUCT);
+    Emit(dst);
+    Emit(first);
+    EmitU16(static_cast<uint16_t>(members.size()));
+    for (const auto &[k, v] : members)
+        EmitU16(AddConstant(ALLOCATE_NAME_STR_OBJECT(k->literal.c_str())));
+}
+
 Chunk &Compiler::CurChunk()
 {
     return m_ScopeChunks.back();
@@ -475,33 +1434,79 @@ Chunk &Compiler::CurChunk()
 
 uint16_t Compiler::AddConstant(const Value &value)
 {
+    if (CurChunk().constants.size() > UINT16_MAX)
+        ASSERT("Too many constants in one chunk, max is %d", UINT16_MAX + 1);
     CurChunk().constants.emplace_back(value);
-    auto pos = static_cast<int16_t>(CurChunk().constants.size() - 1);
+    auto pos = static_cast<uint16_t>(CurChunk().constants.size() - 1);
     return pos;
 }
 
-uint32_t Compiler::Emit(int16_t opcode)
+uint16_t Compiler::AddInlineCache()
+{
+    CurChunk().inlineCaches.emplace_back();
+    auto pos = static_cast<uint16_t>(CurChunk().inlineCaches.size() - 1);
+    return pos;
+}
+
+uint32_t Compiler::Emit(uint8_t opcode)
 {
     CurChunk().opCodeList.emplace_back(opcode);
     return static_cast<uint32_t>(CurChunk().opCodeList.size() - 1);
 }
 
+uint32_t Compiler::EmitU16(uint16_t operand)
+{
+    return AppendOperand(CurChunk().opCodeList, operand);
+}
+
+uint32_t Compiler::EmitI32(int32_t operand)
+{
+    return AppendOperand(CurChunk().opCodeList, operand);
+}
+
+uint32_t Compiler::EmitJump(uint8_t opcode)
+{
+    auto pos = Emit(opcode);
+    EmitI32(0);
+    return pos;
+}
+
+void Compiler::PatchJump(uint32_t pos, size_t target)
+{
+    SetJumpTarget(CurChunk().opCodeList, pos, target);
+}
+
 uint32_t Compiler::EmitConstant(const Value &value)
 {
     auto pos = AddConstant(value);
 
     Emit(OP_CONSTANT);
-    Emit(pos);
+    EmitU16(pos);
     return static_cast<uint32_t>(CurChunk().opCodeList.size() - 1);
 }
 
-uint32_t Compiler::EmitClosure(FunctionObject *fn)
+void Compiler::EmitConstantTo(uint8_t dst, const Value &value)
+{
+    auto pos = AddConstant(value);
+
+    Emit(OP_R_CONSTANT);
+    Emit(dst);
+    EmitU16(pos);
+}
+
+uint32_t Compiler::EmitClosure(FunctionObject *fn, uint8_t dst)
 {
     auto upvalueCount = m_SymbolTable->GetUpvalueCount();
 
-    uint32_t pos = AddConstant(fn);
-    Emit(OP_CLOSURE);
-    Emit(pos);
+    auto pos = AddConstant(fn);
+    if (m_IsUseRegister)
+    {
+        Emit(OP_R_CLOSURE);
+        Emit(dst);
+    }
+    else
+        Emit(OP_CLOSURE);
+    EmitU16(pos);
     Emit(upvalueCount);
 
     for (uint8_t i = 0; i < upvalueCount; ++i)
@@ -514,7 +1519,22 @@ uint32_t Compiler::EmitClosure(FunctionObject *fn)
     return static_cast<uint32_t>(CurChunk().opCodeList.size() - 1);
 }
 
-void Compiler::ModifyOpCode(uint32_t pos, int16_t opcode)
+uint32_t Compiler::EmitReturn(uint8_t returnCount, uint8_t src)
+{
+    if (m_IsUseRegister)
+    {
+        auto pos = Emit(OP_R_RETURN);
+        Emit(returnCount);
+        Emit(src);
+        return pos;
+    }
+
+    auto pos = Emit(OP_RETURN);
+    Emit(returnCount);
+    return pos;
+}
+
+void Compiler::ModifyOpCode(uint32_t pos, uint8_t opcode)
 {
     CurChunk().opCodeList[pos] = opcode;
 }
@@ -538,6 +1558,13 @@ void Compiler::DefineSymbol(const Symbol &symbol)
 
 void Compiler::LoadSymbol(const Symbol &symbol)
 {
+    if (symbol.structPrototype)
+    {
+        Emit(OP_NEW_STRUCT);
+        EmitU16(AddConstant(symbol.structPrototype));
+        return;
+    }
+
     switch (symbol.scope)
     {
     case SymbolScope::GLOBAL:
@@ -554,10 +1581,10 @@ void Compiler::LoadSymbol(const Symbol &symbol)
         break;
     case SymbolScope::BUILTIN:
     {
-        CurChunk().constants.emplace_back(ALLOCATE_OBJECT(StrObject, symbol.name.data()));
-        auto pos = static_cast<int16_t>(CurChunk().constants.size() - 1);
+        CurChunk().constants.emplace_back(Allocator::GetInstance()->AllocateNameStrObject(symbol.name.data(), symbol.name.size()));
+        auto pos = static_cast<uint16_t>(CurChunk().constants.size() - 1);
         Emit(OP_GET_BUILTIN);
-        Emit(pos);
+        EmitU16(pos);
         break;
     }
     default:
@@ -592,20 +1619,147 @@ void Compiler::StoreSymbol(const Symbol &symbol)
     }
 }
 
-void Compiler::RefSymbol(const Symbol &symbol, bool isIndexSymbol)
+void Compiler::RefSymbol(const Symbol &symbol, bool isIndexSymbol, bool isStackRef)
+{
+    switch (symbol.scope)
+    {
+    case SymbolScope::GLOBAL:
+        if (isStackRef)
+            Emit(isIndexSymbol ? OP_STACK_REF_INDEX_GLOBAL : OP_STACK_REF_GLOBAL);
+        else
+            Emit(isIndexSymbol ? OP_REF_INDEX_GLOBAL : OP_REF_GLOBAL);
+        Emit(symbol.index);
+        break;
+    case SymbolScope::LOCAL:
+        // a stack ref may be copied to the gc heap by a callee that keeps it,so it may outlive its call too
+        if (isStackRef)
+            Emit(isIndexSymbol ? OP_STACK_REF_INDEX_LOCAL : OP_STACK_REF_LOCAL);
+        else
+            Emit(isIndexSymbol ? OP_REF_INDEX_LOCAL : OP_REF_LOCAL);
+        m_IsRefLocal = true;
+        Emit(symbol.index);
+        break;
+    case SymbolScope::UPVALUE:
+        if (isStackRef)
+            Emit(isIndexSymbol ? OP_STACK_REF_INDEX_UPVALUE : OP_STACK_REF_UPVALUE);
+        else
+            Emit(isIndexSymbol ? OP_REF_INDEX_UPVALUE : OP_REF_UPVALUE);
+        Emit(symbol.upvalueIndex);
+        break;
+    default:
+        break;
+    }
+}
+
+void Compiler::LoadSymbolTo(const Symbol &symbol, uint8_t dst)
+{
+    if (symbol.structPrototype)
+    {
+        Emit(OP_R_NEW_STRUCT);
+        Emit(dst);
+        EmitU16(AddConstant(symbol.structPrototype));
+        return;
+    }
+
+    // the constructor of a struct is called without arguments,its window is the register of the result
+    uint8_t reg = dst;
+    if (symbol.isStructSymbol && (dst + 1 != m_SymbolTable->GetRegisterTop() || dst < m_SymbolTable->GetLocalVarCount()))
+        reg = m_SymbolTable->AcquireRegister();
+
+    switch (symbol.scope)
+    {
+    case SymbolScope::GLOBAL:
+        Emit(OP_R_GET_GLOBAL);
+        Emit(reg);
+        Emit(symbol.index);
+        break;
+    case SymbolScope::LOCAL:
+        if (reg != symbol.index)
+        {
+            Emit(OP_R_MOVE);
+            Emit(reg);
+            Emit(symbol.index);
+        }
+        break;
+    case SymbolScope::UPVALUE:
+        Emit(OP_R_GET_UPVALUE);
+        Emit(reg);
+        Emit(symbol.upvalueIndex);
+        break;
+    case SymbolScope::BUILTIN:
+        Emit(OP_R_GET_BUILTIN);
+        Emit(reg);
+        EmitU16(AddConstant(Allocator::GetInstance()->AllocateNameStrObject(symbol.name.data(), symbol.name.size())));
+        break;
+    default:
+        break;
+    }
+
+    if (symbol.isStructSymbol)
+    {
+        Emit(OP_R_FUNCTION_CALL);
+        Emit(reg);
+        Emit(0);
+        if (reg != dst)
+        {
+            Emit(OP_R_MOVE);
+            Emit(dst);
+            Emit(reg);
+        }
+    }
+}
+
+void Compiler::StoreSymbolFrom(const Symbol &symbol, uint8_t src)
 {
     switch (symbol.scope)
     {
     case SymbolScope::GLOBAL:
-        Emit(isIndexSymbol ? OP_REF_INDEX_GLOBAL : OP_REF_GLOBAL);
+        Emit(OP_R_SET_GLOBAL);
         Emit(symbol.index);
+        Emit(src);
         break;
     case SymbolScope::LOCAL:
-        Emit(isIndexSymbol ? OP_REF_INDEX_LOCAL : OP_REF_LOCAL);
+        Emit(OP_R_SET_LOCAL);
         Emit(symbol.index);
+        Emit(src);
         break;
     case SymbolScope::UPVALUE:
-        Emit(isIndexSymbol ? OP_REF_INDEX_UPVALUE : OP_REF_UPVALUE);
+        Emit(OP_R_SET_UPVALUE);
+        Emit(symbol.upvalueIndex);
+        Emit(src);
+        break;
+    default:
+        break;
+    }
+}
+
+void Compiler::RefSymbolTo(const Symbol &symbol, uint8_t dst, bool isIndexSymbol, bool isStackRef)
+{
+    switch (symbol.scope)
+    {
+    case SymbolScope::GLOBAL:
+        if (isStackRef)
+            Emit(isIndexSymbol ? OP_R_STACK_REF_INDEX_GLOBAL : OP_R_STACK_REF_GLOBAL);
+        else
+            Emit(isIndexSymbol ? OP_R_REF_INDEX_GLOBAL : OP_R_REF_GLOBAL);
+        Emit(dst);
+        Emit(symbol.index);
+        break;
+    case SymbolScope::LOCAL:
+        if (isStackRef)
+            Emit(isIndexSymbol ? OP_R_STACK_REF_INDEX_LOCAL : OP_R_STACK_REF_LOCAL);
+        else
+            Emit(isIndexSymbol ? OP_R_REF_INDEX_LOCAL : OP_R_REF_LOCAL);
+        m_IsRefLocal = true;
+        Emit(dst);
+        Emit(symbol.index);
+        break;
+    case SymbolScope::UPVALUE:
+        if (isStackRef)
+            Emit(isIndexSymbol ? OP_R_STACK_REF_INDEX_UPVALUE : OP_R_STACK_REF_UPVALUE);
+        else
+            Emit(isIndexSymbol ? OP_R_REF_INDEX_UPVALUE : OP_R_REF_UPVALUE);
+        Emit(dst);
         Emit(symbol.upvalueIndex);
         break;
     default:
@@ -33,6 +33,8 @@ private:
 
     void CompileExpr(Expr *expr, const RWState &state = RWState::READ);
     void CompileBinaryExpr(BinaryExpr *expr);
+    // a chain of + with a string literal in it(like "x:"+x+",y:"+y) is compiled to one OP_CONCAT,returns false otherwise
+    bool CompileConcatExpr(BinaryExpr *expr);
     void CompileNumExpr(NumExpr *expr);
     void CompileBoolExpr(BoolExpr *expr);
     void CompileUnaryExpr(UnaryExpr *expr);
@@ -42,31 +44,77 @@ private:
     void CompileArrayExpr(ArrayExpr *expr);
     void CompileIndexExpr(IndexExpr *expr, const RWState &state);
     void CompileIdentifierExpr(IdentifierExpr *expr, const RWState &state = RWState::READ);
-    void CompileFunctionExpr(FunctionExpr *expr);
+    void CompileFunctionExpr(FunctionExpr *expr, uint8_t dst = 0);
     void CompileFunctionCallExpr(FunctionCallExpr *expr);
     void CompileStructCallExpr(StructCallExpr *expr, const RWState &state);
-    void CompileRefExpr(RefExpr *expr);
+    // a stack ref is only valid until the call it is passed to returns
+    void CompileRefExpr(RefExpr *expr, bool isStackRef = false);
     void CompileStructExpr(StructExpr *expr);
     void CompileDllImportExpr(DllImportExpr *expr);
 
+    // nullptr unless every member default is a literal
+    StructObject *CompileStructPrototype(StructExpr *expr);
+
+    // emit a jump taken if the condition is false,returns the position of the jump opcode
+    uint32_t CompileConditionJump(Expr *condition);
+
+    // register-based bytecode:an expression is compiled to the register its value has to end up in,
+    // locals live in registers of their own and temporaries are allocated above them
+    void CompileExprTo(Expr *expr, uint8_t dst);
+    // the register holding the value of the expression,a local is read in place unless isCopyLocal is set
+    uint8_t CompileToRegister(Expr *expr, bool isCopyLocal = false);
+    void CompileAssignExpr(BinaryExpr *expr);
+    void CompileBinaryExprTo(BinaryExpr *expr, uint8_t dst);
+    bool CompileConcatExprTo(BinaryExpr *expr, uint8_t dst);
+    void CompileFunctionCallExprTo(FunctionCallExpr *expr, uint8_t dst);
+    void CompileRefExprTo(RefExpr *expr, uint8_t dst, bool isStackRef = false);
+    void CompileStructExprTo(StructExpr *expr, uint8_t dst);
+
     Chunk &CurChunk();
 
     uint16_t AddConstant(const Value &value);
+    uint16_t AddInlineCache();
 
-    uint32_t Emit(int16_t opcode);
+    uint32_t Emit(uint8_t opcode);
+    uint32_t EmitU16(uint16_t operand);
+    uint32_t EmitI32(int32_t operand);
+    // emit a jump with an unpatched offset,returns the position of the jump opcode
+    uint32_t EmitJump(uint8_t opcode);
+    void PatchJump(uint32_t pos, size_t target);
     uint32_t EmitConstant(const Value &value);
-    uint32_t EmitClosure(FunctionObject *fn);
+    void EmitConstantTo(uint8_t dst, const Value &value);
+    // dst is the register of the closure in register-based bytecode
+    uint32_t EmitClosure(FunctionObject *fn, uint8_t dst = 0);
+    // src is the register of the returned value in register-based bytecode
+    uint32_t EmitReturn(uint8_t returnCount, uint8_t src = 0);
 
-    void ModifyOpCode(uint32_t pos, int16_t opcode);
+    void ModifyOpCode(uint32_t pos, uint8_t opcode);
 
     void DefineSymbol(const Symbol &symbol);
     void LoadSymbol(const Symbol &symbol);
     void StoreSymbol(const Symbol &symbol);
-    void RefSymbol(const Symbol &symbol, bool isIndexSymbol);
+    void RefSymbol(const Symbol &symbol, bool isIndexSymbol, bool isStackRef = false);
+
+    void LoadSymbolTo(const Symbol &symbol, uint8_t dst);
+    void StoreSymbolFrom(const Symbol &symbol, uint8_t src);
+    // the register of the index follows for an index symbol
+    void RefSymbolTo(const Symbol &symbol, uint8_t dst, bool isIndexSymbol, bool isStackRef = false);
 
     void DefineBuiltin();
 
     std::vector<Chunk> m_ScopeChunks;
 
     SymbolTable *m_SymbolTable{nullptr};
+
+    // compile to register-based bytecode instead of stack-based bytecode
+    bool m_IsUseRegister{false};
+    bool m_IsFuseSuperInstruction{true};
+    bool m_IsUseTailCall{true};
+
+    // tail calls of the function being compiled,they fall back to regular calls if the function refs one of its locals,
+    // since the ref may be reachable from the arguments(e.g. inside an array) and the callee reuses the frame
+    std::vector<uint32_t> m_TailCallPositions;
+    bool m_IsRefLocal{false};
+    // the OP_FUNCTION_CALL emitted last,a return can only turn it into a tail call if nothing was emitted after it
+    uint32_t m_LastCallPos{UINT32_MAX};
 };
\ No newline at end of file
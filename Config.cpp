@@ -1,5 +1,6 @@
 #include "Config.h"
 #include <filesystem>
+#include <thread>
 
 Config *Config::GetInstance()
 {
@@ -26,6 +27,110 @@ std::string Config::ToFullPath(std::string_view filePath)
     return fullPath;
 }
 
+void Config::SetUseRegister(bool b)
+{
+    m_UseRegister = b;
+}
+
+bool Config::IsUseRegister()
+{
+    return m_UseRegister;
+}
+
+void Config::SetDumpInlineCacheStats(bool b)
+{
+    m_DumpInlineCacheStats = b;
+}
+
+bool Config::IsDumpInlineCacheStats()
+{
+    return m_DumpInlineCacheStats;
+}
+
+void Config::SetIncrementalGc(bool b)
+{
+    m_IncrementalGc = b;
+}
+
+bool Config::IsIncrementalGc()
+{
+    return m_IncrementalGc;
+}
+
+void Config::SetGcStepBudget(uint32_t budget)
+{
+    m_GcStepBudget = budget == 0 ? 1 : budget;
+}
+
+uint32_t Config::GetGcStepBudget()
+{
+    return m_GcStepBudget;
+}
+
+void Config::SetGcThreadCount(uint32_t count)
+{
+    // threads beyond the core count only take turns on the cores,hardware_concurrency is 0 if it is not known
+    auto coreCount = std::thread::hardware_concurrency();
+    if (coreCount != 0 && count > coreCount)
+        count = coreCount;
+    m_GcThreadCount = count == 0 ? 1 : count;
+}
+
+uint32_t Config::GetGcThreadCount()
+{
+    return m_GcThreadCount;
+}
+
+void Config::SetGcGrowthFactor(double factor)
+{
+    m_GcGrowthFactor = factor < 1.0 ? 1.0 : factor;
+}
+
+double Config::GetGcGrowthFactor()
+{
+    return m_GcGrowthFactor;
+}
+
+void Config::SetGcMinHeapBytes(size_t bytes)
+{
+    m_GcMinHeapBytes = bytes;
+}
+
+size_t Config::GetGcMinHeapBytes()
+{
+    return m_GcMinHeapBytes;
+}
+
+void Config::SetGcMaxHeapBytes(size_t bytes)
+{
+    m_GcMaxHeapBytes = bytes;
+}
+
+size_t Config::GetGcMaxHeapBytes()
+{
+    return m_GcMaxHeapBytes;
+}
+
+void Config::SetGcLog(bool b)
+{
+    m_GcLog = b;
+}
+
+bool Config::IsGcLog()
+{
+    return m_GcLog;
+}
+
+void Config::SetGcStatsPath(std::string_view path)
+{
+    m_GcStatsPath = path;
+}
+
+const std::string &Config::GetGcStatsPath() const
+{
+    return m_GcStatsPath;
+}
+
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
 void Config::SetUseJit(bool b)
 {
@@ -12,11 +12,58 @@ public:
 
     std::string ToFullPath(std::string_view filePath);
 
+    // compile to register-based bytecode run by VM::ExecuteRegister instead of the stack-based bytecode
+    void SetUseRegister(bool b);
+    bool IsUseRegister();
+
+    void SetDumpInlineCacheStats(bool b);
+    bool IsDumpInlineCacheStats();
+
+    void SetIncrementalGc(bool b);
+    bool IsIncrementalGc();
+
+    // work(in object slots) done by one incremental gc step
+    void SetGcStepBudget(uint32_t budget);
+    uint32_t GetGcStepBudget();
+
+    // threads marking and sweeping during a major collection,the main thread included
+    void SetGcThreadCount(uint32_t count);
+    uint32_t GetGcThreadCount();
+
+    // after a major collection the next one runs once the old generation grew to its live bytes * growth factor,
+    // but not below the min heap size and not above the max heap size(0:no cap)
+    void SetGcGrowthFactor(double factor);
+    double GetGcGrowthFactor();
+
+    void SetGcMinHeapBytes(size_t bytes);
+    size_t GetGcMinHeapBytes();
+
+    void SetGcMaxHeapBytes(size_t bytes);
+    size_t GetGcMaxHeapBytes();
+
+    // print one line per collection to stderr
+    void SetGcLog(bool b);
+    bool IsGcLog();
+
+    // write the gc statistics as json to the file at exit
+    void SetGcStatsPath(std::string_view path);
+    const std::string &GetGcStatsPath() const;
+
 private:
     Config() = default;
     ~Config() = default;
 
     std::string m_CurExecuteFileDirectory;
+    bool m_UseRegister{false};
+    bool m_DumpInlineCacheStats{false};
+    bool m_IncrementalGc{false};
+    uint32_t m_GcStepBudget{256};
+    uint32_t m_GcThreadCount{1};
+    double m_GcGrowthFactor{2.0};
+    size_t m_GcMinHeapBytes{1024 * 1024};
+    size_t m_GcMaxHeapBytes{0};
+    bool m_GcLog{false};
+    std::string m_GcStatsPath;
 
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
 public:
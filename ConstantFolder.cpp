@@ -1,5 +1,6 @@
 #include "ConstantFolder.h"
 #include "Utils.h"
+#include "Value.h"
 
 void ConstantFolder::Fold(std::vector<Stmt *> &stmts)
 {
@@ -188,6 +189,45 @@ Expr *ConstantFolder::FoldStructExpr(StructExpr *expr)
     return expr;
 }
 
+// folds with the runtime rules,a result that is no integer at runtime is a double literal
+static NumExpr *ValueToNumExpr(const Value &value)
+{
+    if (IS_INT_VALUE(value))
+        return new NumExpr(static_cast<int64_t>(TO_INT_VALUE(value)));
+    return new NumExpr(TO_DOUBLE_VALUE(value));
+}
+
+Expr *ConstantFolder::FoldIntegerBinary(int64_t left, const std::string &op, int64_t right)
+{
+    if (op == "+")
+        return ValueToNumExpr(IntAdd(left, right));
+    else if (op == "-")
+        return ValueToNumExpr(IntSub(left, right));
+    else if (op == "*")
+        return ValueToNumExpr(IntMul(left, right));
+    else if (op == "/")
+        return new NumExpr((double)left / (double)right);
+    else if (op == "&")
+        return new NumExpr(left & right);
+    else if (op == "|")
+        return new NumExpr(left | right);
+    else if (op == "^")
+        return new NumExpr(left ^ right);
+    else if (op == "==")
+        return new BoolExpr(left == right);
+    else if (op == "!=")
+        return new BoolExpr(left != right);
+    else if (op == ">")
+        return new BoolExpr(left > right);
+    else if (op == ">=")
+        return new BoolExpr(left >= right);
+    else if (op == "<")
+        return new BoolExpr(left < right);
+    else if (op == "<=")
+        return new BoolExpr(left <= right);
+    return nullptr;
+}
+
 Expr *ConstantFolder::ConstantFold(Expr *expr)
 {
     if (expr->type == AstType::BINARY)
@@ -195,34 +235,39 @@ Expr *ConstantFolder::ConstantFold(Expr *expr)
         auto infix = (BinaryExpr *)expr;
         if (infix->left->type == AstType::NUM && infix->right->type == AstType::NUM)
         {
+            auto left = (NumExpr *)infix->left;
+            auto right = (NumExpr *)infix->right;
             Expr *newExpr = nullptr;
-            if (infix->op == "+")
-                newExpr = new NumExpr(((NumExpr *)infix->left)->value + ((NumExpr *)infix->right)->value);
+            if (left->isInteger && right->isInteger)
+                newExpr = FoldIntegerBinary(left->integer, infix->op, right->integer);
+            else if (infix->op == "+")
+                newExpr = new NumExpr(left->value + right->value);
             else if (infix->op == "-")
-                newExpr = new NumExpr(((NumExpr *)infix->left)->value - ((NumExpr *)infix->right)->value);
+                newExpr = new NumExpr(left->value - right->value);
             else if (infix->op == "*")
-                newExpr = new NumExpr(((NumExpr *)infix->left)->value * ((NumExpr *)infix->right)->value);
+                newExpr = new NumExpr(left->value * right->value);
             else if (infix->op == "/")
-                newExpr = new NumExpr(((NumExpr *)infix->left)->value / ((NumExpr *)infix->right)->value);
+                newExpr = new NumExpr(left->value / right->value);
             else if (infix->op == "&")
-                newExpr = new NumExpr((double)((int64_t)((NumExpr *)infix->left)->value & (int64_t)((NumExpr *)infix->right)->value));
+                newExpr = ValueToNumExpr(Value((int64_t)left->value & (int64_t)right->value));
             else if (infix->op == "|")
-                newExpr = new NumExpr((double)((int64_t)((NumExpr *)infix->left)->value | (int64_t)((NumExpr *)infix->right)->value));
+                newExpr = ValueToNumExpr(Value((int64_t)left->value | (int64_t)right->value));
             else if (infix->op == "^")
-                newExpr = new NumExpr((double)((int64_t)((NumExpr *)infix->left)->value ^ (int64_t)((NumExpr *)infix->right)->value));
+                newExpr = ValueToNumExpr(Value((int64_t)left->value ^ (int64_t)right->value));
             else if (infix->op == "==")
-                newExpr = new BoolExpr(((NumExpr *)infix->left)->value == ((NumExpr *)infix->right)->value);
+                newExpr = new BoolExpr(left->value == right->value);
             else if (infix->op == "!=")
-                newExpr = new BoolExpr(((NumExpr *)infix->left)->value != ((NumExpr *)infix->right)->value);
+                newExpr = new BoolExpr(left->value != right->value);
             else if (infix->op == ">")
-                newExpr = new BoolExpr(((NumExpr *)infix->left)->value > ((NumExpr *)infix->right)->value);
+                newExpr = new BoolExpr(left->value > right->value);
             else if (infix->op == ">=")
-                newExpr = new BoolExpr(((NumExpr *)infix->left)->value >= ((NumExpr *)infix->right)->value);
+                newExpr = new BoolExpr(left->value >= right->value);
             else if (infix->op == "<")
-                newExpr = new BoolExpr(((NumExpr *)infix->left)->value < ((NumExpr *)infix->right)->value);
+                newExpr = new BoolExpr(left->value < right->value);
             else if (infix->op == "<=")
-                newExpr = new BoolExpr(((NumExpr *)infix->left)->value <= ((NumExpr *)infix->right)->value);
-            else 
+                newExpr = new BoolExpr(left->value <= right->value);
+
+            if (!newExpr)
                 return infix;
             SAFE_DELETE(infix);
             return newExpr;
@@ -251,7 +296,8 @@ Expr *ConstantFolder::ConstantFold(Expr *expr)
         auto prefix = (UnaryExpr *)expr;
         if (prefix->right->type == AstType::NUM && prefix->op == "-")
         {
-            auto numExpr = new NumExpr(-((NumExpr *)prefix->right)->value);
+            auto right = (NumExpr *)prefix->right;
+            auto numExpr = right->isInteger ? ValueToNumExpr(IntNeg(right->integer)) : new NumExpr(-right->value);
             SAFE_DELETE(prefix);
             return numExpr;
         }
@@ -263,8 +309,8 @@ Expr *ConstantFolder::ConstantFold(Expr *expr)
         }
         else if (prefix->right->type == AstType::NUM && prefix->op == "~")
         {
-            auto v = ~(int64_t)((NumExpr *)prefix->right)->value;
-            auto numExpr = new NumExpr((double)v);
+            auto right = (NumExpr *)prefix->right;
+            auto numExpr = ValueToNumExpr(Value(~(right->isInteger ? right->integer : (int64_t)right->value)));
             SAFE_DELETE(prefix);
             return numExpr;
         }
@@ -35,5 +35,6 @@ private:
     Expr *FoldRefExpr(RefExpr *expr);
     Expr *FoldStructExpr(StructExpr *expr);
 
+    Expr *FoldIntegerBinary(int64_t left, const std::string &op, int64_t right);
     Expr *ConstantFold(Expr *expr);
 };
\ No newline at end of file
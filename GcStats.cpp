@@ -0,0 +1,96 @@
+#include "GcStats.h"
+
+void GcStats::RecordPause(double pauseMs)
+{
+    pauseCount++;
+    totalPauseMs += pauseMs;
+    if (pauseMs > maxPauseMs)
+        maxPauseMs = pauseMs;
+
+    uint32_t bucket = 0;
+    for (double bound = 0.01; bucket < GC_PAUSE_BUCKET_COUNT - 1 && pauseMs >= bound; bound *= 10.0)
+        bucket++;
+    pauseHistogram[bucket]++;
+}
+
+void GcStats::RecordCollection(const GcEvent &event)
+{
+    switch (event.kind)
+    {
+    case GcKind::MINOR:
+        minorCount++;
+        break;
+    case GcKind::MAJOR:
+        majorCount++;
+        break;
+    case GcKind::INCREMENTAL:
+        incrementalCount++;
+        break;
+    default:
+        break;
+    }
+
+    freedObjectCount += event.freedObjectCount;
+    freedBytes += event.freedBytes;
+    heapObjectCount = event.heapObjectCount;
+    heapBytes = event.heapBytes;
+
+    events.emplace_back(event);
+    if (events.size() > GC_EVENT_HISTORY_COUNT)
+        events.pop_front();
+}
+
+std::string GcStats::ToJson() const
+{
+    std::stringstream sstr;
+    sstr << "{\n";
+    sstr << "  \"minorCount\": " << minorCount << ",\n";
+    sstr << "  \"majorCount\": " << majorCount << ",\n";
+    sstr << "  \"incrementalCount\": " << incrementalCount << ",\n";
+    sstr << "  \"incrementalStepCount\": " << incrementalStepCount << ",\n";
+    sstr << "  \"pauseCount\": " << pauseCount << ",\n";
+    sstr << "  \"totalPauseMs\": " << totalPauseMs << ",\n";
+    sstr << "  \"maxPauseMs\": " << maxPauseMs << ",\n";
+
+    sstr << "  \"pauseHistogram\": {";
+    const char *bucketNames[GC_PAUSE_BUCKET_COUNT] = {"<10us", "<100us", "<1ms", "<10ms", "<100ms", ">=100ms"};
+    for (uint32_t i = 0; i < GC_PAUSE_BUCKET_COUNT; ++i)
+        sstr << (i == 0 ? "" : ", ") << "\"" << bucketNames[i] << "\": " << pauseHistogram[i];
+    sstr << "},\n";
+
+    sstr << "  \"freedObjectCount\": " << freedObjectCount << ",\n";
+    sstr << "  \"freedBytes\": " << freedBytes << ",\n";
+    sstr << "  \"heapObjectCount\": " << heapObjectCount << ",\n";
+    sstr << "  \"heapBytes\": " << heapBytes << ",\n";
+
+    sstr << "  \"events\": [";
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        const auto &event = events[i];
+        sstr << (i == 0 ? "\n" : ",\n")
+             << "    {\"kind\": \"" << GcKindToString(event.kind) << "\""
+             << ", \"pauseMs\": " << event.pauseMs
+             << ", \"freedObjectCount\": " << event.freedObjectCount
+             << ", \"freedBytes\": " << event.freedBytes
+             << ", \"heapObjectCount\": " << event.heapObjectCount
+             << ", \"heapBytes\": " << event.heapBytes << "}";
+    }
+    sstr << (events.empty() ? "]\n" : "\n  ]\n");
+    sstr << "}\n";
+    return sstr.str();
+}
+
+const char *GcKindToString(GcKind kind)
+{
+    switch (kind)
+    {
+    case GcKind::MINOR:
+        return "minor";
+    case GcKind::MAJOR:
+        return "major";
+    case GcKind::INCREMENTAL:
+        return "incremental";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <string>
+#include "Utils.h"
+
+// pause histogram buckets:<10us,<100us,<1ms,<10ms,<100ms,>=100ms
+constexpr uint32_t GC_PAUSE_BUCKET_COUNT = 6;
+// only the latest collections are kept in the event history
+constexpr size_t GC_EVENT_HISTORY_COUNT = 1024;
+
+enum class GcKind : uint8_t
+{
+    MINOR,
+    MAJOR,
+    // a major collection spread over several steps,its pause is the longest step
+    INCREMENTAL,
+};
+
+struct GcEvent
+{
+    GcKind kind{GcKind::MINOR};
+    double pauseMs{0.0};
+    uint64_t freedObjectCount{0};
+    uint64_t freedBytes{0};
+    // heap after the collection
+    size_t heapObjectCount{0};
+    size_t heapBytes{0};
+};
+
+struct COMPUTEDUCK_API GcStats
+{
+    // every stop of the mutator,a whole collection or one incremental step
+    void RecordPause(double pauseMs);
+    void RecordCollection(const GcEvent &event);
+
+    std::string ToJson() const;
+
+    uint64_t minorCount{0};
+    uint64_t majorCount{0};
+    uint64_t incrementalCount{0};
+    uint64_t incrementalStepCount{0};
+
+    uint64_t pauseCount{0};
+    double totalPauseMs{0.0};
+    double maxPauseMs{0.0};
+    uint64_t pauseHistogram[GC_PAUSE_BUCKET_COUNT]{};
+
+    uint64_t freedObjectCount{0};
+    uint64_t freedBytes{0};
+
+    // heap after the last collection
+    size_t heapObjectCount{0};
+    size_t heapBytes{0};
+
+    std::deque<GcEvent> events;
+};
+
+COMPUTEDUCK_API const char *GcKindToString(GcKind kind);
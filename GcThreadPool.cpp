@@ -0,0 +1,87 @@
+#include "GcThreadPool.h"
+
+GcThreadPool::~GcThreadPool()
+{
+    Destroy();
+}
+
+GcThreadPool *GcThreadPool::GetInstance()
+{
+    static GcThreadPool instance;
+    return &instance;
+}
+
+void GcThreadPool::Run(uint32_t threadCount, const std::function<void(uint32_t index)> &task)
+{
+    if (threadCount <= 1)
+    {
+        task(0);
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+
+        // helper threads are created on first use
+        while (m_Threads.size() < threadCount - 1)
+        {
+            auto index = (uint32_t)m_Threads.size() + 1;
+            m_Threads.emplace_back([this, index]()
+                                   { WorkerLoop(index); });
+        }
+
+        m_Task = &task;
+        m_TaskThreadCount = threadCount;
+        m_PendingThreadCount = threadCount - 1;
+        m_TaskGeneration++;
+    }
+    m_TaskCondition.notify_all();
+
+    task(0);
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_DoneCondition.wait(lock, [this]()
+                         { return m_PendingThreadCount == 0; });
+    m_Task = nullptr;
+}
+
+void GcThreadPool::Destroy()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_IsStopping = true;
+    }
+    m_TaskCondition.notify_all();
+
+    for (auto &thread : m_Threads)
+        thread.join();
+    m_Threads.clear();
+
+    m_IsStopping = false;
+}
+
+void GcThreadPool::WorkerLoop(uint32_t index)
+{
+    uint64_t generation = 0;
+    while (true)
+    {
+        const std::function<void(uint32_t index)> *task = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_TaskCondition.wait(lock, [&]()
+                                 { return m_IsStopping || (m_TaskGeneration != generation && index < m_TaskThreadCount); });
+            if (m_IsStopping)
+                return;
+            generation = m_TaskGeneration;
+            task = m_Task;
+        }
+
+        (*task)(index);
+
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_PendingThreadCount--;
+        }
+        m_DoneCondition.notify_one();
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "Utils.h"
+
+// helper threads of the collector,they sleep between collections.
+// a task runs on the calling thread(index 0) and on threadCount-1 helper threads at the same time
+class COMPUTEDUCK_API GcThreadPool
+{
+public:
+    static GcThreadPool *GetInstance();
+
+    // returns after the task finished on all threads
+    void Run(uint32_t threadCount, const std::function<void(uint32_t index)> &task);
+
+    void Destroy();
+
+private:
+    GcThreadPool() = default;
+    ~GcThreadPool();
+
+    void WorkerLoop(uint32_t index);
+
+    std::vector<std::thread> m_Threads;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_TaskCondition;
+    std::condition_variable m_DoneCondition;
+
+    const std::function<void(uint32_t index)> *m_Task{nullptr};
+    // helper threads with an index below m_TaskThreadCount join the current task
+    uint32_t m_TaskThreadCount{0};
+    uint64_t m_TaskGeneration{0};
+    uint32_t m_PendingThreadCount{0};
+    bool m_IsStopping{false};
+};
@@ -1,5 +1,6 @@
 #include "HashTable.h"
 #include "Object.h"
+#include "ObjectPool.h"
 #define TABLE_MAX_LOAD 0.75
 
 #define GROW_CAPACITY(capacity) ((capacity) < 8 ? 8 : (capacity)*2)
@@ -91,6 +92,47 @@ void HashTable::UnMark()
     }
 }
 
+void HashTable::Clear()
+{
+    SAFE_DELETE_ARRAY(m_Entries);
+    m_Count = 0;
+    m_Capacity = 0;
+}
+
+StrObject *HashTable::FindString(const char *chars, size_t len, uint32_t hash)
+{
+    if (m_Count == 0)
+        return nullptr;
+
+    uint32_t index = hash & (m_Capacity - 1);
+    while (1)
+    {
+        Entry *entry = &m_Entries[index];
+        if (entry->key == nullptr)
+        {
+            if (IS_NIL_VALUE(entry->value))
+                return nullptr;
+        }
+        else if (entry->key->hash == hash && entry->key->len == len && memcmp(entry->key->value, chars, len) == 0)
+            return entry->key;
+
+        index = (index + 1) & (m_Capacity - 1);
+    }
+}
+
+void HashTable::RemoveUnmarkedKeys()
+{
+    for (size_t i = 0; i < m_Capacity; ++i)
+    {
+        Entry *entry = &m_Entries[i];
+        if (entry->key && !ObjectPool::IsMarked(entry->key))
+        {
+            entry->key = nullptr;
+            entry->value = Value(true);
+        }
+    }
+}
+
 uint32_t HashTable::GetCount() const
 {
     return m_Count;
@@ -125,7 +167,7 @@ Entry *HashTable::FindEntry(Entry* entries, uint32_t capacity, StrObject *key)
             else if (tombstone == nullptr)
                 tombstone = entry;
         }
-        else if (entry->key->hash == key->hash)
+        else if (entry->key == key || (entry->key->hash == key->hash && entry->key->len == key->len && memcmp(entry->key->value, key->value, key->len) == 0))
             return entry;
 
         index = (index + 1) & (capacity - 1);
@@ -25,6 +25,12 @@ public:
     bool Delete(StrObject *key);
     void Mark();
     void UnMark();
+    void Clear();
+
+    // the key with the content,nullptr if there is none
+    StrObject *FindString(const char *chars, size_t len, uint32_t hash);
+    // deletes the entries whose key was not marked by the gc,the table holds its keys weakly
+    void RemoveUnmarkedKeys();
 
     uint32_t GetCount() const;
     uint32_t GetCapacity() const;
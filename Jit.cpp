@@ -213,20 +213,43 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
 
     const auto& opCodeList = frame.closure->function->chunk.opCodeList;
 
+    m_DoubleArithmetic = false;
+    m_IntOverflowSites.clear();
+
     auto ip = opCodeList.data();
-    while ((ip - opCodeList.data()) < opCodeList.size())
+    while (true)
     {
-        int32_t instruction = *ip++;
+        if ((ip - opCodeList.data()) >= opCodeList.size())
+        {
+            if (m_DoubleArithmetic || m_IntOverflowSites.empty())
+                break;
+
+            // compile the body again with all numbers in double,an integer overflow continues in this copy
+            m_DoubleArithmetic = true;
+            m_StackTop = m_ValueStack;
+            jumpInstrSetTable.clear();
+            localVariables.clear();
+            branchState = BranchState::IF_CONDITION;
+            m_Builder->SetInsertPoint(llvm::BasicBlock::Create(*m_Context, "double.entry", currentCompileFunction));
+            ip = opCodeList.data();
+            continue;
+        }
+
+        auto address = (int32_t)(ip - opCodeList.data());
+        // the vm may have quickened the opcodes in place,compile from the generic ones
+        int32_t instruction = GetGenericOpCode(*ip++);
         switch (instruction)
         {
         case OP_CONSTANT:
         {
-            auto idx = *ip++;
+            auto idx = ReadOperand<uint16_t>(ip);
             auto value = frame.closure->function->chunk.constants[idx];
 
             auto llvmValue = AllocateValue(value);
             if (!llvmValue)
-                JIT_ERROR(JitCompileState::FAIL, "Unsupported value type:%d", value.type);
+                JIT_ERROR(JitCompileState::FAIL, "Unsupported value type:%d", GET_VALUE_TYPE(value));
+            if (m_DoubleArithmetic)
+                llvmValue = ToDouble(llvmValue);
 
             Push(llvmValue);
             break;
@@ -236,8 +259,10 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
             auto left = Pop().GetLlvmValue();
             auto right = Pop().GetLlvmValue();
 
-            if (left->getType() == m_DoubleType && right->getType() == m_DoubleType)
-                Push(m_Builder->CreateFAdd(left, right));
+            if (left->getType() == m_Int64Type && right->getType() == m_Int64Type)
+                Push(CreateIntArithmetic(llvm::Intrinsic::sadd_with_overflow, left, right, address, localVariables));
+            else if (IsNumType(left->getType()) && IsNumType(right->getType()))
+                Push(m_Builder->CreateFAdd(ToDouble(left), ToDouble(right)));
             else
             {
                 left = AllocateValue(left);
@@ -250,46 +275,61 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
                 Push(result);
             }
 
+            CreateIntOverflowResume(address, localVariables);
             break;
         }
         case OP_SUB:
         {
             auto left = Pop().GetLlvmValue();
             auto right = Pop().GetLlvmValue();
-            if (left->getType() == m_DoubleType && right->getType() == m_DoubleType)
-                Push(m_Builder->CreateFSub(left, right));
+            if (left->getType() == m_Int64Type && right->getType() == m_Int64Type)
+                Push(CreateIntArithmetic(llvm::Intrinsic::ssub_with_overflow, left, right, address, localVariables));
+            else if (IsNumType(left->getType()) && IsNumType(right->getType()))
+                Push(m_Builder->CreateFSub(ToDouble(left), ToDouble(right)));
             else
             {
                 left = AllocateValue(left);
                 right = AllocateValue(right);
 
-                auto call = m_Builder->CreateCall(m_Module->getFunction(STR(ValueSub)), {left, right});
-                Push(call);
+                auto result = m_Builder->CreateAlloca(m_ValueType);
+
+                m_Builder->CreateCall(m_Module->getFunction(STR(ValueSub)), {left, right, result});
+
+                Push(result);
             }
+
+            CreateIntOverflowResume(address, localVariables);
             break;
         }
         case OP_MUL:
         {
             auto left = Pop().GetLlvmValue();
             auto right = Pop().GetLlvmValue();
-            if (left->getType() == m_DoubleType && right->getType() == m_DoubleType)
-                Push(m_Builder->CreateFMul(left, right));
+            if (left->getType() == m_Int64Type && right->getType() == m_Int64Type)
+                Push(CreateIntArithmetic(llvm::Intrinsic::smul_with_overflow, left, right, address, localVariables));
+            else if (IsNumType(left->getType()) && IsNumType(right->getType()))
+                Push(m_Builder->CreateFMul(ToDouble(left), ToDouble(right)));
             else
             {
                 left = AllocateValue(left);
                 right = AllocateValue(right);
 
-                auto call = m_Builder->CreateCall(m_Module->getFunction(STR(ValueMul)), {left, right});
-                Push(call);
+                auto result = m_Builder->CreateAlloca(m_ValueType);
+
+                m_Builder->CreateCall(m_Module->getFunction(STR(ValueMul)), {left, right, result});
+
+                Push(result);
             }
+
+            CreateIntOverflowResume(address, localVariables);
             break;
         }
         case OP_DIV:
         {
             auto left = Pop().GetLlvmValue();
             auto right = Pop().GetLlvmValue();
-            if (left->getType() == m_DoubleType && right->getType() == m_DoubleType)
-                Push(m_Builder->CreateFDiv(left, right));
+            if (IsNumType(left->getType()) && IsNumType(right->getType()))
+                Push(m_Builder->CreateFDiv(ToDouble(left), ToDouble(right)));
             else
             {
                 left = AllocateValue(left);
@@ -304,8 +344,10 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
         {
             auto left = Pop().GetLlvmValue();
             auto right = Pop().GetLlvmValue();
-            if (left->getType() == m_DoubleType && right->getType() == m_DoubleType)
-                Push(m_Builder->CreateFCmpULT(left, right));
+            if (left->getType() == m_Int64Type && right->getType() == m_Int64Type)
+                Push(m_Builder->CreateICmpSLT(left, right));
+            else if (IsNumType(left->getType()) && IsNumType(right->getType()))
+                Push(m_Builder->CreateFCmpULT(ToDouble(left), ToDouble(right)));
             else
             {
                 left = AllocateValue(left);
@@ -320,8 +362,10 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
         {
             auto left = Pop().GetLlvmValue();
             auto right = Pop().GetLlvmValue();
-            if (left->getType() == m_DoubleType && right->getType() == m_DoubleType)
-                Push(m_Builder->CreateFCmpUGT(left, right));
+            if (left->getType() == m_Int64Type && right->getType() == m_Int64Type)
+                Push(m_Builder->CreateICmpSGT(left, right));
+            else if (IsNumType(left->getType()) && IsNumType(right->getType()))
+                Push(m_Builder->CreateFCmpUGT(ToDouble(left), ToDouble(right)));
             else
             {
                 left = AllocateValue(left);
@@ -349,14 +393,20 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
         case OP_MINUS:
         {
             auto value = Pop().GetLlvmValue();
-            if (value->getType() == m_DoubleType)
-                Push(m_Builder->CreateNeg(value));
+            // -0 is a double,so a negated integer is one too
+            if (value->getType() == m_Int64Type)
+                Push(m_Builder->CreateFNeg(ToDouble(value)));
+            else if (value->getType() == m_DoubleType)
+                Push(m_Builder->CreateFNeg(value));
             else
             {
                 value = AllocateValue(value);
 
-                auto call = m_Builder->CreateCall(m_Module->getFunction(STR(ValueMinus)), {value});
-                Push(call);
+                auto result = m_Builder->CreateAlloca(m_ValueType);
+
+                m_Builder->CreateCall(m_Module->getFunction(STR(ValueMinus)), {value, result});
+
+                Push(result);
             }
             break;
         }
@@ -365,8 +415,10 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
             auto left = Pop().GetLlvmValue();
             auto right = Pop().GetLlvmValue();
 
-            if (left->getType() == m_DoubleType && right->getType() == m_DoubleType)
-                Push(m_Builder->CreateFCmpUEQ(left, right));
+            if (left->getType() == m_Int64Type && right->getType() == m_Int64Type)
+                Push(m_Builder->CreateICmpEQ(left, right));
+            else if (IsNumType(left->getType()) && IsNumType(right->getType()))
+                Push(m_Builder->CreateFCmpUEQ(ToDouble(left), ToDouble(right)));
             else if (left->getType() == m_BoolType && right->getType() == m_BoolType)
                 Push(m_Builder->CreateICmpEQ(left, right));
             else
@@ -374,7 +426,7 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
                 left = AllocateValue(left);
                 right = AllocateValue(right);
 
-                auto call = m_Builder->CreateCall(m_Module->getFunction(STR(ValueGreater)), {left, right});
+                auto call = m_Builder->CreateCall(m_Module->getFunction(STR(ValueEqual)), {left, right});
                 Push(call);
             }
 
@@ -382,7 +434,7 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
         }
         case OP_ARRAY:
         {
-            auto numElements = *ip++;
+            auto numElements = ReadOperand<uint16_t>(ip);
 
             auto elements = std::vector<llvm::Value *>(numElements);
 
@@ -451,13 +503,8 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
         {
             auto left = Pop().GetLlvmValue();
             auto right = Pop().GetLlvmValue();
-            if (left->getType() == m_BoolType && right->getType() == m_BoolType)
-            {
-                auto lCast = m_Builder->CreateFPToSI(left, m_Int64Type);
-                auto rCast = m_Builder->CreateFPToSI(right, m_Int64Type);
-                auto result = m_Builder->CreateAnd(lCast, rCast);
-                Push(result);
-            }
+            if (IsNumType(left->getType()) && IsNumType(right->getType()))
+                Push(m_Builder->CreateAnd(ToInt64(left), ToInt64(right)));
             else
             {
                 left = AllocateValue(left);
@@ -472,13 +519,8 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
         {
             auto left = Pop().GetLlvmValue();
             auto right = Pop().GetLlvmValue();
-            if (left->getType() == m_BoolType && right->getType() == m_BoolType)
-            {
-                auto lCast = m_Builder->CreateFPToSI(left, m_Int64Type);
-                auto rCast = m_Builder->CreateFPToSI(right, m_Int64Type);
-                auto result = m_Builder->CreateOr(lCast, rCast);
-                Push(result);
-            }
+            if (IsNumType(left->getType()) && IsNumType(right->getType()))
+                Push(m_Builder->CreateOr(ToInt64(left), ToInt64(right)));
             else
             {
                 left = AllocateValue(left);
@@ -492,11 +534,8 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
         case OP_BIT_NOT:
         {
             auto value = Pop().GetLlvmValue();
-            if (value->getType() == m_DoubleType)
-            {
-                value = m_Builder->CreateFPToSI(value, m_Int64Type);
-                Push(m_Builder->CreateXor(value, -1));
-            }
+            if (IsNumType(value->getType()))
+                Push(m_Builder->CreateXor(ToInt64(value), -1));
             else
             {
                 value = AllocateValue(value);
@@ -509,13 +548,8 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
         {
             auto left = Pop().GetLlvmValue();
             auto right = Pop().GetLlvmValue();
-            if (left->getType() == m_DoubleType && right->getType() == m_BoolType)
-            {
-                auto lCast = m_Builder->CreateFPToSI(left, m_Int64Type);
-                auto rCast = m_Builder->CreateFPToSI(right, m_Int64Type);
-                auto result = m_Builder->CreateXor(lCast, rCast);
-                Push(result);
-            }
+            if (IsNumType(left->getType()) && IsNumType(right->getType()))
+                Push(m_Builder->CreateXor(ToInt64(left), ToInt64(right)));
             else
             {
                 left = AllocateValue(left);
@@ -538,15 +572,15 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
                 auto vArrayType = static_cast<llvm::PointerType *>(ds->getType())->getElementType();
                 if (vArrayType->isArrayTy())
                 {
-                    if (index->getType() == m_DoubleType)
+                    if (IsNumType(index->getType()))
                     {
                         isSatis = true;
-                        auto iIndex = m_Builder->CreateFPToSI(index, m_Int64Type);
+                        auto iIndex = ToInt64(index);
                         llvm::Value *memberAddr = m_Builder->CreateInBoundsGEP(vArrayType, ds, {m_Builder->getInt32(0), iIndex});
                         Push(memberAddr);
                     }
                 }
-                else if (ds->getType() == m_ArrayObjectPtrType && index->getType() == m_DoubleType)
+                else if (ds->getType() == m_ArrayObjectPtrType && IsNumType(index->getType()))
                 {
                     ds = AllocateValue(ds);
                     index = AllocateValue(index);
@@ -577,28 +611,25 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
                 auto elementType = static_cast<llvm::PointerType *>(ds->getType())->getElementType();
                 if (elementType->isArrayTy())
                 {
-                    if (index->getType() == m_DoubleType)
+                    if (IsNumType(index->getType()))
                     {
                         isSatis = true;
-                        auto iIndex = m_Builder->CreateFPToSI(index, m_Int64Type);
+                        auto iIndex = ToInt64(index);
                         llvm::Value *memberAddr = m_Builder->CreateInBoundsGEP(elementType, ds, {m_Builder->getInt32(0), iIndex});
                         m_Builder->CreateStore(v, memberAddr);
                     }
                 }
                 else if (elementType == m_ValueType)
                 {
-                    auto objMemberAddr = m_Builder->CreateInBoundsGEP(m_ValueType, ds, {m_Builder->getInt32(0), m_Builder->getInt32(1)});
-                    auto arrayObjMemberAddr = m_Builder->CreateBitCast(objMemberAddr, m_ObjectPtrPtrType);
-                    arrayObjMemberAddr = m_Builder->CreateLoad(m_ObjectPtrType, arrayObjMemberAddr);
-                    arrayObjMemberAddr = m_Builder->CreateBitCast(arrayObjMemberAddr, m_ArrayObjectPtrType);
+                    auto arrayObjMemberAddr = LoadObjectFromValue(ds, m_ArrayObjectPtrType);
 
                     auto array = m_Builder->CreateInBoundsGEP(m_ArrayObjectType, arrayObjMemberAddr, {m_Builder->getInt32(0), m_Builder->getInt32(1)});
                     auto arrayElements = m_Builder->CreateLoad(m_ValuePtrType, array);
 
-                    if (index->getType() == m_DoubleType)
+                    if (IsNumType(index->getType()))
                     {
                         isSatis = true;
-                        auto iIndex = m_Builder->CreateFPToSI(index, m_Int64Type);
+                        auto iIndex = ToInt64(index);
 
                         llvm::Value *memberAddr = m_Builder->CreateInBoundsGEP(m_ValueType, arrayElements, iIndex);
 
@@ -651,7 +682,7 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
         }
         case OP_JUMP_IF_FALSE:
         {
-            auto address = *ip++;
+            ip += sizeof(int32_t); // jump offset,only used by the vm
             auto mode = *ip++;
 
             auto condition = Pop().GetLlvmValue();
@@ -675,7 +706,7 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
         }
         case OP_JUMP:
         {
-            auto address = *ip++;
+            ip += sizeof(int32_t); // jump offset,only used by the vm
             auto mode = *ip++;
 
             auto &instrSet = jumpInstrSetTable.back();
@@ -735,27 +766,21 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
             if (returnCount == 1)
             {
                 auto value = Pop().GetLlvmValue();
-                if (value->getType() == m_ValuePtrType)
+                if (value->getType() == m_Int64Type && currentCompileFunction->getReturnType() == m_DoubleType)
+                    value = ToDouble(value);
+                else if (value->getType() == m_ValuePtrType)
                 {
                     if (currentCompileFunction->getReturnType() == m_DoubleType)
                     {
-                        value = m_Builder->CreateInBoundsGEP(m_ValueType, value, {m_Builder->getInt32(0), m_Builder->getInt32(1)});
-                        value = m_Builder->CreateBitCast(value, m_DoublePtrType);
-                        value = m_Builder->CreateLoad(m_DoubleType, value);
+                        value = LoadNumFromValue(value);
                     }
                     else if (currentCompileFunction->getReturnType() == m_StrObjectPtrType)
                     {
-                        value = m_Builder->CreateInBoundsGEP(m_ValueType, value, {m_Builder->getInt32(0), m_Builder->getInt32(1)});
-                        value = m_Builder->CreateBitCast(value, m_ObjectPtrPtrType);
-                        value = m_Builder->CreateLoad(m_ObjectPtrType, value);
-                        value = m_Builder->CreateBitCast(value, m_StrObjectPtrType);
+                        value = LoadObjectFromValue(value, m_StrObjectPtrType);
                     }
                     else if (currentCompileFunction->getReturnType() == m_ArrayObjectPtrType)
                     {
-                        value = m_Builder->CreateInBoundsGEP(m_ValueType, value, {m_Builder->getInt32(0), m_Builder->getInt32(1)});
-                        value = m_Builder->CreateBitCast(value, m_ObjectPtrPtrType);
-                        value = m_Builder->CreateLoad(m_ObjectPtrType, value);
-                        value = m_Builder->CreateBitCast(value, m_ArrayObjectPtrType);
+                        value = LoadObjectFromValue(value, m_ArrayObjectPtrType);
                     }
                 }
 
@@ -811,7 +836,11 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
 
             auto name = GenerateLocalVarName(index);
 
-            auto alloc = m_Builder->CreateAlloca(value->getType());
+            // the alloca type is fixed at definition,a local that was assigned a double later is kept in double
+            if (m_DoubleLocalVariables.contains(fnName + name))
+                value = ToDouble(value);
+
+            auto alloc = CreateEntryBlockAlloca(value->getType());
             m_Builder->CreateStore(value, alloc);
 
             localVariables[name] = alloc;
@@ -836,7 +865,19 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
                 m_Builder->CreateCall(m_Module->getFunction(STR(SetValue)), {refValue,  value });
             }
             else
+            {
+                if (iter->second->getAllocatedType() == m_DoubleType)
+                    value = ToDouble(value);
+                else if (iter->second->getAllocatedType() == m_Int64Type && value->getType() == m_DoubleType)
+                {
+                    // integer local changes to double,recompile the function with the local in double
+                    m_DoubleLocalVariables.insert(fnName + name);
+                    InitModuleAndPassManager();
+                    ResetStatus();
+                    return Compile(frame, fnName);
+                }
                 m_Builder->CreateStore(value, iter->second);
+            }
 
             break;
         }
@@ -854,9 +895,7 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
                 {
                     auto arg = parentFn->getArg(index);
 
-                    llvm::AllocaInst *alloc = m_Builder->CreateAlloca(arg->getType());
-
-                    m_Builder->CreateStore(arg, alloc);
+                    llvm::AllocaInst *alloc = CreateEntryBlockAlloca(arg->getType(), arg);
 
                     localVariables[name] = alloc;
 
@@ -870,7 +909,7 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
                                                                                                             llvm::ConstantInt::get(m_Int16Type, index),
                                                                                                         });
 
-                    auto alloc = m_Builder->CreateAlloca(slot->getType());
+                    auto alloc = CreateEntryBlockAlloca(slot->getType());
                     m_Builder->CreateStore(slot, alloc);
 
                     localVariables[name] = alloc;
@@ -885,6 +924,7 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
             break;
         }
         case OP_FUNCTION_CALL:
+        case OP_STACK_REF_CALL:
         {
             auto argCount = (uint8_t)*ip++;
 
@@ -951,7 +991,7 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
                 {
                     std::vector<llvm::Value *> args;
                     for (auto slot = m_StackTop - argCount; slot < m_StackTop; ++slot)
-                        args.emplace_back(slot->GetLlvmValue());
+                        args.emplace_back(ToDouble(slot->GetLlvmValue())); // numbers cross the jit function boundary as double
 
                     m_StackTop = m_StackTop - argCount - 1;
 
@@ -985,10 +1025,11 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
             break;
         }
         case OP_GET_BUILTIN:
+        case OP_GET_BUILTIN_INDEX:
         {
-            auto idx = *ip++;
-            auto value = frame.closure->function->chunk.constants[idx];
-            auto name = std::string(TO_STR_VALUE(value)->value);
+            auto idx = ReadOperand<uint16_t>(ip);
+            auto nameObj = instruction == OP_GET_BUILTIN ? TO_STR_VALUE(frame.closure->function->chunk.constants[idx]) : BuiltinManager::GetInstance()->GetBuiltinName(idx);
+            auto name = std::string(nameObj->value);
             auto iter = m_BuiltinFnCache.find(name);
 
             llvm::Function *fn = nullptr;
@@ -1005,7 +1046,7 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
         }
         case OP_STRUCT:
         {
-            auto memberCount = *ip++;
+            auto memberCount = ReadOperand<uint16_t>(ip);
 
             auto tableInstancePtr = m_Builder->CreateCall(m_Module->getFunction(STR(AllocateHashTable)));
 
@@ -1025,8 +1066,17 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
             Push(structInstancePtr);
             break;
         }
+        case OP_NEW_STRUCT:
+        {
+            auto prototype = TO_STRUCT_VALUE(frame.closure->function->chunk.constants[ReadOperand<uint16_t>(ip)]);
+            // the prototype is a constant of the chunk,it lives as long as the function
+            auto prototypePtr = m_Builder->CreateIntToPtr(m_Builder->getInt64(reinterpret_cast<uint64_t>(prototype)), m_StructObjectPtrType);
+            Push(m_Builder->CreateCall(m_Module->getFunction(STR(NewStructObject)), {prototypePtr}));
+            break;
+        }
         case OP_GET_STRUCT:
         {
+            ip += sizeof(uint16_t); // inline cache index,only used by the vm
             auto memberName = Pop().GetLlvmValue();
             auto instance = Pop().GetLlvmValue();
 
@@ -1038,22 +1088,17 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
 
             if (instance->getType() == m_ValuePtrType)
             {
-                instance = m_Builder->CreateInBoundsGEP(m_ValueType, instance, {m_Builder->getInt32(0), m_Builder->getInt32(1)});
-                instance = m_Builder->CreateBitCast(instance, m_ObjectPtrPtrType);
-                instance = m_Builder->CreateLoad(m_ObjectPtrType, instance);
-                instance = m_Builder->CreateBitCast(instance, m_StructObjectPtrType);
+                instance = LoadObjectFromValue(instance, m_StructObjectPtrType);
             }
 
-            auto tablePtr = m_Builder->CreateInBoundsGEP(m_StructObjectType, instance, {m_Builder->getInt32(0), m_Builder->getInt32(1)});
-            tablePtr = m_Builder->CreateLoad(m_HashTablePtrType, tablePtr);
-
-            auto resultValuePtr = m_Builder->CreateCall(m_Module->getFunction(STR(HashTableGet)), {tablePtr, memberName});
+            auto resultValuePtr = m_Builder->CreateCall(m_Module->getFunction(STR(StructObjectGetMember)), {instance, memberName});
 
             Push(resultValuePtr);
             break;
         }
         case OP_SET_STRUCT:
         {
+            ip += sizeof(uint16_t); // inline cache index,only used by the vm
             auto memberName = Pop().GetLlvmValue();
             auto instance = Pop().GetLlvmValue();
 
@@ -1068,22 +1113,18 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
 
             if (instance->getType() == m_ValuePtrType)
             {
-                instance = m_Builder->CreateInBoundsGEP(m_ValueType, instance, {m_Builder->getInt32(0), m_Builder->getInt32(1)});
-                instance = m_Builder->CreateBitCast(instance, m_ObjectPtrPtrType);
-                instance = m_Builder->CreateLoad(m_ObjectPtrType, instance);
-                instance = m_Builder->CreateBitCast(instance, m_StructObjectPtrType);
+                instance = LoadObjectFromValue(instance, m_StructObjectPtrType);
             }
 
-            auto tablePtr = m_Builder->CreateInBoundsGEP(m_StructObjectType, instance, {m_Builder->getInt32(0), m_Builder->getInt32(1)});
-            tablePtr = m_Builder->CreateLoad(m_HashTablePtrType, tablePtr);
-
-            auto resultValuePtr = m_Builder->CreateCall(m_Module->getFunction(STR(HashTableGet)), {tablePtr, memberName});
+            auto resultValuePtr = m_Builder->CreateCall(m_Module->getFunction(STR(StructObjectGetMember)), {instance, memberName});
 
             m_Builder->CreateCall(m_Module->getFunction(STR(SetValue)), {resultValuePtr, value});
 
             break;
         }
+        // jit code allocates every ref on the gc heap,so stack refs need no release
         case OP_REF_GLOBAL:
+        case OP_STACK_REF_GLOBAL:
         {
             auto index = *ip++;
             auto globArray = m_Builder->CreateLoad(m_ValuePtrType, m_Module->getNamedGlobal(GLOBAL_VARIABLE_STR));
@@ -1094,6 +1135,7 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
             break;
         }
         case OP_REF_LOCAL:
+        case OP_STACK_REF_LOCAL:
         {
             auto index = *ip++;
 
@@ -1124,6 +1166,7 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
             break;
         }
         case OP_REF_INDEX_GLOBAL:
+        case OP_STACK_REF_INDEX_GLOBAL:
         {
             auto index = *ip++;
             auto idxValue = Pop().GetLlvmValue();
@@ -1138,6 +1181,7 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
             break;
         }
         case OP_REF_INDEX_LOCAL:
+        case OP_STACK_REF_INDEX_LOCAL:
         {
             auto index = *ip++;
 
@@ -1169,6 +1213,31 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
             Push(value);
             break;
         }
+        case OP_RELEASE_STACK_REFS:
+        {
+            ip++;
+            break;
+        }
+        case OP_CONCAT:
+        {
+            auto count = *ip++;
+            std::vector<llvm::Value *> operands(count);
+            for (uint8_t i = 0; i < count; ++i)
+                operands[i] = AllocateValue(Pop().GetLlvmValue());
+
+            auto operandsPtr = m_Builder->CreateAlloca(m_ValueType, m_Builder->getInt32(count));
+            for (uint8_t i = 0; i < count; ++i)
+            {
+                // the vm sees the operands in stack order,the leftmost one last
+                auto dst = m_Builder->CreateInBoundsGEP(m_ValueType, operandsPtr, m_Builder->getInt32(count - 1 - i));
+                AssignValue(dst, operands[i], sizeof(Value));
+            }
+
+            auto result = m_Builder->CreateAlloca(m_ValueType);
+            m_Builder->CreateCall(m_Module->getFunction(STR(ValueConcat)), {operandsPtr, m_Builder->getInt8(count), result});
+            Push(result);
+            break;
+        }
         case OP_DLL_IMPORT:
         {
             // TODO
@@ -1194,6 +1263,7 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
             break;
         }
         case OP_REF_UPVALUE:
+        case OP_STACK_REF_UPVALUE:
         {
             auto index = *ip++;
             auto upvalue = m_Builder->CreateCall(m_Module->getFunction(STR(GetUpvalue)), {m_Builder->getInt8(index)});
@@ -1203,6 +1273,7 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
             break;
         }
         case OP_REF_INDEX_UPVALUE:
+        case OP_STACK_REF_INDEX_UPVALUE:
         {
             auto index = *ip++;
             auto v = Pop().GetLlvmValue();
@@ -1216,7 +1287,7 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
         }
         case OP_CLOSURE:
         {
-            auto idx = *ip++;
+            auto idx = ReadOperand<uint16_t>(ip);
             auto upvalueCount = *ip++;
 
             for (uint8_t i = 0; i < upvalueCount; ++i)
@@ -1228,6 +1299,20 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
             // TODO
             break;
         }
+        case OP_TAIL_CALL:
+        {
+            JIT_ERROR(JitCompileState::FAIL, "Jit Compiler not support OP_TAIL_CALL");
+            break;
+        }
+        case OP_INC_LOCAL:
+        case OP_INC_GLOBAL:
+        case OP_JUMP_IF_LESS:
+        case OP_JUMP_IF_GREATER:
+        case OP_JUMP_IF_EQUAL:
+        case OP_JUMP_IF_NOT_LESS:
+        case OP_JUMP_IF_NOT_GREATER:
+        case OP_JUMP_IF_NOT_EQUAL:
+            JIT_ERROR(JitCompileState::FAIL, "Jit Compiler not support superinstruction:%d", instruction);
         default:
             break;
         }
@@ -1237,6 +1322,9 @@ JitFnDecl Jit::Compile(const CallFrame &frame, const std::string &fnName)
     m_Module->print(llvm::errs(), nullptr);
 #endif
 
+    if (!LinkIntOverflowSites())
+        JIT_ERROR(JitCompileState::FAIL, "Cannot continue an integer overflow of %s in double", fnName.c_str());
+
     llvm::verifyFunction(*currentCompileFunction);
     m_FPM->run(*currentCompileFunction);
 
@@ -1285,14 +1373,18 @@ void Jit::InitTypes()
     m_BoolPtrType = llvm::PointerType::get(m_BoolType, 0);
     m_DoublePtrType = llvm::PointerType::get(m_DoubleType, 0);
 
+#ifdef COMPUTEDUCK_BUILD_WITH_NAN_BOXING
+    m_ValueType = llvm::StructType::create(*m_Context, {m_Int64Type}, "struct.Value");
+#else
     m_UnionType = llvm::StructType::create(*m_Context, {m_DoubleType}, "union.anon");
 
     m_ValueType = llvm::StructType::create(*m_Context, {m_Int8Type, m_UnionType}, "struct.Value");
+#endif
     m_ValuePtrType = llvm::PointerType::get(m_ValueType, 0);
 
     m_ObjectType = llvm::StructType::create(*m_Context, "struct.Object");
     m_ObjectPtrType = llvm::PointerType::get(m_ObjectType, 0);
-    m_ObjectType->setBody({m_Int8Type, m_BoolType, m_ObjectPtrType});
+    m_ObjectType->setBody({m_Int8Type, m_BoolType});
     m_ObjectPtrPtrType = llvm::PointerType::get(m_ObjectPtrType, 0);
 
     m_StrObjectType = llvm::StructType::create(*m_Context, {m_ObjectType, m_Int8PtrType, m_Int32Type, m_Int32Type}, "struct.StrObject");
@@ -1312,7 +1404,7 @@ void Jit::InitTypes()
     m_HashTableType = llvm::StructType::create(*m_Context, {m_Int32Type, m_Int32Type, m_EntryPtrType}, "struct.Table");
     m_HashTablePtrType = llvm::PointerType::get(m_HashTableType, 0);
 
-    m_StructObjectType = llvm::StructType::create(*m_Context, {m_ObjectType, m_HashTablePtrType}, "struct.StructObject");
+    m_StructObjectType = llvm::StructType::create(*m_Context, {m_ObjectType, m_Int8PtrType, m_ValuePtrType, m_HashTablePtrType}, "struct.StructObject");
     m_StructObjectPtrType = llvm::PointerType::get(m_StructObjectType, 0);
 }
 
@@ -1345,6 +1437,9 @@ void Jit::InitInternalFunctions()
     fnType = llvm::FunctionType::get(m_StructObjectPtrType, {m_HashTablePtrType}, false);
     m_Module->getOrInsertFunction(STR(AllocateStructObject), fnType);
 
+    fnType = llvm::FunctionType::get(m_StructObjectPtrType, {m_StructObjectPtrType}, false);
+    m_Module->getOrInsertFunction(STR(NewStructObject), fnType);
+
     fnType = llvm::FunctionType::get(m_ValuePtrType, {m_Int16Type}, false);
     m_Module->getOrInsertFunction(STR(GetLocalVariableSlot), fnType);
 
@@ -1360,6 +1455,9 @@ void Jit::InitInternalFunctions()
     fnType = llvm::FunctionType::get(m_ValuePtrType, {m_HashTablePtrType, m_StrObjectPtrType}, false);
     m_Module->getOrInsertFunction(STR(HashTableGet), fnType);
 
+    fnType = llvm::FunctionType::get(m_ValuePtrType, {m_StructObjectPtrType, m_StrObjectPtrType}, false);
+    m_Module->getOrInsertFunction(STR(StructObjectGetMember), fnType);
+
     fnType = llvm::FunctionType::get(m_ValuePtrType, {m_ValuePtrType}, false);
     m_Module->getOrInsertFunction(STR(GetEndOfRefValuePtr), fnType);
 
@@ -1368,12 +1466,17 @@ void Jit::InitInternalFunctions()
 
     fnType = llvm::FunctionType::get(m_VoidType, {m_ValuePtrType, m_ValuePtrType, m_ValuePtrType}, false);
     m_Module->getOrInsertFunction(STR(ValueAdd), fnType);
+    m_Module->getOrInsertFunction(STR(ValueSub), fnType);
+    m_Module->getOrInsertFunction(STR(ValueMul), fnType);
     m_Module->getOrInsertFunction(STR(GetArrayObjectElement), fnType);
 
+    fnType = llvm::FunctionType::get(m_VoidType, {m_ValuePtrType, m_Int8Type, m_ValuePtrType}, false);
+    m_Module->getOrInsertFunction(STR(ValueConcat), fnType);
+
     fnType = llvm::FunctionType::get(m_DoubleType, {m_ValuePtrType, m_ValuePtrType}, false);
-    m_Module->getOrInsertFunction(STR(ValueSub), fnType);
-    m_Module->getOrInsertFunction(STR(ValueMul), fnType);
     m_Module->getOrInsertFunction(STR(ValueDiv), fnType);
+
+    fnType = llvm::FunctionType::get(m_Int64Type, {m_ValuePtrType, m_ValuePtrType}, false);
     m_Module->getOrInsertFunction(STR(ValueBitAnd), fnType);
     m_Module->getOrInsertFunction(STR(ValueBitOr), fnType);
     m_Module->getOrInsertFunction(STR(ValueBitXor), fnType);
@@ -1388,8 +1491,10 @@ void Jit::InitInternalFunctions()
     fnType = llvm::FunctionType::get(m_BoolType, {m_ValuePtrType}, false);
     m_Module->getOrInsertFunction(STR(ValueLogicNot), fnType);
 
-    fnType = llvm::FunctionType::get(m_DoubleType, {m_ValuePtrType}, false);
+    fnType = llvm::FunctionType::get(m_Int64Type, {m_ValuePtrType}, false);
     m_Module->getOrInsertFunction(STR(ValueBitNot), fnType);
+
+    fnType = llvm::FunctionType::get(m_VoidType, {m_ValuePtrType, m_ValuePtrType}, false);
     m_Module->getOrInsertFunction(STR(ValueMinus), fnType);
 
     fnType = llvm::FunctionType::get(m_ValuePtrType, {m_Int8Type}, false);
@@ -1403,6 +1508,46 @@ llvm::Value *Jit::AllocateValue(llvm::Value *v)
     if(valueType == m_ValuePtrType)
         return v;
 
+#ifdef COMPUTEDUCK_BUILD_WITH_NAN_BOXING
+    llvm::Value *bits = nullptr;
+    if (valueType == m_DoubleType)
+        bits = m_Builder->CreateBitCast(v, m_Int64Type);
+    else if (valueType == m_Int64Type)
+    {
+        // integers outside the 48-bit payload are boxed as double
+        auto inRange = m_Builder->CreateAnd(m_Builder->CreateICmpSGE(v, m_Builder->getInt64(VALUE_INT_MIN)), m_Builder->CreateICmpSLE(v, m_Builder->getInt64(VALUE_INT_MAX)));
+        auto intBits = m_Builder->CreateOr(m_Builder->CreateAnd(v, m_Builder->getInt64(NAN_BOXING_INT_PAYLOAD_MASK)), m_Builder->getInt64(NAN_BOXING_INT_BITS));
+        auto doubleBits = m_Builder->CreateBitCast(m_Builder->CreateSIToFP(v, m_DoubleType), m_Int64Type);
+        bits = m_Builder->CreateSelect(inRange, intBits, doubleBits);
+    }
+    else if (valueType == m_BoolType)
+        bits = m_Builder->CreateSelect(v, m_Builder->getInt64(NAN_BOXING_TRUE_BITS), m_Builder->getInt64(NAN_BOXING_FALSE_BITS));
+    else if (valueType == m_BoolPtrType)
+        bits = m_Builder->getInt64(NAN_BOXING_NIL_BITS);
+    else if (valueType == m_ObjectPtrType ||
+             valueType == m_StrObjectPtrType ||
+             valueType == m_ArrayObjectPtrType ||
+             valueType == m_StructObjectPtrType ||
+             valueType == m_RefObjectPtrType)
+        bits = m_Builder->CreateOr(m_Builder->CreatePtrToInt(v, m_Int64Type), m_Builder->getInt64(NAN_BOXING_OBJECT_MASK));
+    else if (valueType == m_Int8PtrType)
+    {
+        // create str object
+        auto strObject = m_Builder->CreateCall(m_Module->getFunction(STR(AllocateStrObject)), {v});
+        bits = m_Builder->CreateOr(m_Builder->CreatePtrToInt(strObject, m_Int64Type), m_Builder->getInt64(NAN_BOXING_OBJECT_MASK));
+    }
+    else
+    {
+        return nullptr;
+    }
+
+    auto alloc = m_Builder->CreateAlloca(m_ValueType, nullptr);
+
+    llvm::Value *memberAddr = m_Builder->CreateInBoundsGEP(m_ValueType, alloc, {m_Builder->getInt32(0), m_Builder->getInt32(0)});
+    m_Builder->CreateStore(bits, memberAddr);
+
+    return alloc;
+#else
     llvm::Value *vt = nullptr;
     llvm::Value *storedV = nullptr;
     llvm::Type *type = m_DoublePtrType;
@@ -1413,8 +1558,12 @@ llvm::Value *Jit::AllocateValue(llvm::Value *v)
     }
     else if (valueType == m_Int64Type)
     {
-        vt = m_Builder->getInt8(ValueType::NUM);
-        storedV = m_Builder->CreateSIToFP(v, m_DoubleType);
+        // integers outside the 48-bit range are boxed as double,like in the vm
+        auto inRange = m_Builder->CreateAnd(m_Builder->CreateICmpSGE(v, m_Builder->getInt64(VALUE_INT_MIN)), m_Builder->CreateICmpSLE(v, m_Builder->getInt64(VALUE_INT_MAX)));
+        auto doubleBits = m_Builder->CreateBitCast(m_Builder->CreateSIToFP(v, m_DoubleType), m_Int64Type);
+        vt = m_Builder->CreateSelect(inRange, m_Builder->getInt8(ValueType::INT), m_Builder->getInt8(ValueType::NUM));
+        type = m_Int64Type->getPointerTo();
+        storedV = m_Builder->CreateSelect(inRange, v, doubleBits);
     }
     else if (valueType == m_BoolType)
     {
@@ -1429,6 +1578,7 @@ llvm::Value *Jit::AllocateValue(llvm::Value *v)
     else if (valueType == m_ObjectPtrType ||
              valueType == m_StrObjectPtrType ||
              valueType == m_ArrayObjectPtrType ||
+             valueType == m_StructObjectPtrType ||
              valueType == m_RefObjectPtrType)
     {
         vt = m_Builder->getInt8(ValueType::OBJECT);
@@ -1459,28 +1609,62 @@ llvm::Value *Jit::AllocateValue(llvm::Value *v)
     m_Builder->CreateStore(storedV, memberAddr);
 
     return alloc;
+#endif
 }
 
 llvm::Value *Jit::AllocateValue(const Value &value)
 {
-    if (IS_NUM_VALUE(value))
-        return llvm::ConstantFP::get(m_DoubleType, TO_NUM_VALUE(value));
+    if (IS_INT_VALUE(value))
+        return llvm::ConstantInt::get(m_Int64Type, TO_INT_VALUE(value), true);
+    else if (IS_DOUBLE_VALUE(value))
+        return llvm::ConstantFP::get(m_DoubleType, TO_DOUBLE_VALUE(value));
     else if (IS_BOOL_VALUE(value))
         return llvm::ConstantInt::get(m_BoolType, TO_BOOL_VALUE(value));
     else if (IS_NIL_VALUE(value))
         return llvm::ConstantPointerNull::get(m_BoolPtrType);
     else if (IS_STR_VALUE(value))
     {
-        auto str = TO_STR_VALUE(value)->value;
-        llvm::Value *strObject = m_Builder->CreateGlobalString(str);
-        strObject = m_Builder->CreateBitCast(strObject, m_Int8PtrType);
-        strObject = m_Builder->CreateCall(m_Module->getFunction(STR(AllocateStrObject)), {strObject});
-        return strObject;
+        // constant strings are interned and kept alive by their chunk,so the jitted code refers to the same object as the vm
+        return m_Builder->CreateIntToPtr(m_Builder->getInt64(reinterpret_cast<uint64_t>(TO_STR_VALUE(value))), m_StrObjectPtrType);
     }
     else
         return nullptr;
 }
 
+llvm::Value *Jit::LoadNumFromValue(llvm::Value *valuePtr)
+{
+#ifdef COMPUTEDUCK_BUILD_WITH_NAN_BOXING
+    auto memberAddr = m_Builder->CreateInBoundsGEP(m_ValueType, valuePtr, {m_Builder->getInt32(0), m_Builder->getInt32(0)});
+    auto bits = m_Builder->CreateLoad(m_Int64Type, memberAddr);
+    auto isInt = m_Builder->CreateICmpEQ(m_Builder->CreateAnd(bits, m_Builder->getInt64(NAN_BOXING_OBJECT_MASK | NAN_BOXING_INT_TAG)), m_Builder->getInt64(NAN_BOXING_INT_BITS));
+    // sign extend the 48-bit payload
+    auto integer = m_Builder->CreateAShr(m_Builder->CreateShl(bits, 16), 16);
+    return m_Builder->CreateSelect(isInt, m_Builder->CreateSIToFP(integer, m_DoubleType), m_Builder->CreateBitCast(bits, m_DoubleType));
+#else
+    auto typeAddr = m_Builder->CreateInBoundsGEP(m_ValueType, valuePtr, {m_Builder->getInt32(0), m_Builder->getInt32(0)});
+    auto isInt = m_Builder->CreateICmpEQ(m_Builder->CreateLoad(m_Int8Type, typeAddr), m_Builder->getInt8(ValueType::INT));
+    auto memberAddr = m_Builder->CreateInBoundsGEP(m_ValueType, valuePtr, {m_Builder->getInt32(0), m_Builder->getInt32(1)});
+    auto integer = m_Builder->CreateLoad(m_Int64Type, m_Builder->CreateBitCast(memberAddr, m_Int64Type->getPointerTo()));
+    auto number = m_Builder->CreateLoad(m_DoubleType, m_Builder->CreateBitCast(memberAddr, m_DoublePtrType));
+    return m_Builder->CreateSelect(isInt, m_Builder->CreateSIToFP(integer, m_DoubleType), number);
+#endif
+}
+
+llvm::Value *Jit::LoadObjectFromValue(llvm::Value *valuePtr, llvm::PointerType *objectPtrType)
+{
+#ifdef COMPUTEDUCK_BUILD_WITH_NAN_BOXING
+    auto memberAddr = m_Builder->CreateInBoundsGEP(m_ValueType, valuePtr, {m_Builder->getInt32(0), m_Builder->getInt32(0)});
+    auto bits = m_Builder->CreateLoad(m_Int64Type, memberAddr);
+    bits = m_Builder->CreateAnd(bits, m_Builder->getInt64(~NAN_BOXING_OBJECT_MASK));
+    return m_Builder->CreateIntToPtr(bits, objectPtrType);
+#else
+    auto memberAddr = m_Builder->CreateInBoundsGEP(m_ValueType, valuePtr, {m_Builder->getInt32(0), m_Builder->getInt32(1)});
+    memberAddr = m_Builder->CreateBitCast(memberAddr, m_ObjectPtrPtrType);
+    auto object = m_Builder->CreateLoad(m_ObjectPtrType, memberAddr);
+    return m_Builder->CreateBitCast(object, objectPtrType);
+#endif
+}
+
 void Jit::Push(llvm::Value *v)
 {
     *m_StackTop++ = v;
@@ -1529,6 +1713,7 @@ llvm::Type *Jit::GetLlvmTypeFromValueType(uint8_t v)
     case ValueType::NIL:
         return m_BoolPtrType;
     case ValueType::NUM:
+    case ValueType::INT:
         return m_DoubleType;
     case ValueType::BOOL:
         return m_BoolType;
@@ -1551,7 +1736,7 @@ uint8_t Jit::GetValueTypeFromLlvmType(llvm::Type *v)
 {
     if (v == m_BoolPtrType)
         return ValueType::NIL;
-    else if (v == m_DoubleType)
+    else if (v == m_DoubleType || v == m_Int64Type)
         return ValueType::NUM;
     else if (v == m_BoolType)
         return ValueType::BOOL;
@@ -1566,6 +1751,162 @@ uint8_t Jit::GetValueTypeFromLlvmType(llvm::Type *v)
     return ValueType::NIL;
 }
 
+bool Jit::IsNumType(llvm::Type *type)
+{
+    return type == m_DoubleType || type == m_Int64Type;
+}
+
+llvm::Value *Jit::ToDouble(llvm::Value *v)
+{
+    if (v->getType() == m_Int64Type)
+        return m_Builder->CreateSIToFP(v, m_DoubleType);
+    return v;
+}
+
+llvm::Value *Jit::ToInt64(llvm::Value *v)
+{
+    if (v->getType() == m_DoubleType)
+        return m_Builder->CreateFPToSI(v, m_Int64Type);
+    return v;
+}
+
+llvm::Value *Jit::CreateIntArithmetic(llvm::Intrinsic::ID id, llvm::Value *l, llvm::Value *r, int32_t address, const std::map<std::string, llvm::AllocaInst *> &localVariables)
+{
+    if (m_DoubleArithmetic)
+        return CreateDoubleArithmetic(id, ToDouble(l), ToDouble(r));
+
+    auto fn = llvm::Intrinsic::getDeclaration(m_Module.get(), id, {m_Int64Type});
+    auto result = m_Builder->CreateCall(fn, {l, r});
+    auto value = m_Builder->CreateExtractValue(result, 0);
+
+    // like in the vm,a result outside of the integer range is a double
+    auto outOfRange = m_Builder->CreateOr(m_Builder->CreateICmpSLT(value, m_Builder->getInt64(VALUE_INT_MIN)), m_Builder->CreateICmpSGT(value, m_Builder->getInt64(VALUE_INT_MAX)));
+    auto overflow = m_Builder->CreateOr(m_Builder->CreateExtractValue(result, 1), outOfRange);
+
+    auto currentFn = m_Builder->GetInsertBlock()->getParent();
+    auto overflowBlock = llvm::BasicBlock::Create(*m_Context, "int.overflow." + std::to_string(address), currentFn);
+    auto continueBlock = llvm::BasicBlock::Create(*m_Context, "int.continue." + std::to_string(address), currentFn);
+    m_Builder->CreateCondBr(overflow, overflowBlock, continueBlock);
+
+    // the overflow block is filled by LinkIntOverflowSites once the double copy of the body exists
+    auto &site = m_IntOverflowSites[address];
+    site.overflowBlock = overflowBlock;
+    site.id = id;
+    site.left = l;
+    site.right = r;
+    site.localVariables = localVariables;
+    site.stack.assign(m_ValueStack, m_StackTop);
+
+    m_Builder->SetInsertPoint(continueBlock);
+    return value;
+}
+
+llvm::Value *Jit::CreateDoubleArithmetic(llvm::Intrinsic::ID id, llvm::Value *l, llvm::Value *r)
+{
+    if (id == llvm::Intrinsic::sadd_with_overflow)
+        return m_Builder->CreateFAdd(l, r);
+    else if (id == llvm::Intrinsic::ssub_with_overflow)
+        return m_Builder->CreateFSub(l, r);
+    return m_Builder->CreateFMul(l, r);
+}
+
+void Jit::CreateIntOverflowResume(int32_t address, const std::map<std::string, llvm::AllocaInst *> &localVariables)
+{
+    if (!m_DoubleArithmetic)
+        return;
+
+    auto iter = m_IntOverflowSites.find(address);
+    if (iter == m_IntOverflowSites.end())
+        return;
+
+    auto &site = iter->second;
+    auto prevBlock = m_Builder->GetInsertBlock();
+    site.resumeBlock = llvm::BasicBlock::Create(*m_Context, "double.resume." + std::to_string(address), prevBlock->getParent());
+    m_Builder->CreateBr(site.resumeBlock);
+    m_Builder->SetInsertPoint(site.resumeBlock);
+
+    // the values computed in the double copy before the resume point get a second incoming value from the overflow block
+    for (auto slot = m_ValueStack; slot < m_StackTop; ++slot)
+    {
+        if (!slot->IsLlvmValue() || !llvm::isa<llvm::Instruction>(slot->GetLlvmValue()))
+            continue;
+
+        auto v = slot->GetLlvmValue();
+        auto phi = m_Builder->CreatePHI(v->getType(), 2);
+        phi->addIncoming(v, prevBlock);
+        site.stackPhis.emplace_back(slot - m_ValueStack, phi);
+        *slot = phi;
+    }
+
+    site.doubleLocalVariables = localVariables;
+}
+
+bool Jit::LinkIntOverflowSites()
+{
+    auto convert = [this](llvm::Value *v, llvm::Type *type) -> llvm::Value *
+    {
+        if (v->getType() == type)
+            return v;
+        if (v->getType() == m_Int64Type && type == m_DoubleType)
+            return m_Builder->CreateSIToFP(v, m_DoubleType);
+        return nullptr;
+    };
+
+    for (auto &[address, site] : m_IntOverflowSites)
+    {
+        if (!site.resumeBlock)
+            return false;
+
+        m_Builder->SetInsertPoint(site.overflowBlock);
+
+        for (const auto &[name, alloc] : site.localVariables)
+        {
+            auto doubleIter = site.doubleLocalVariables.find(name);
+            if (doubleIter == site.doubleLocalVariables.end())
+                continue;
+
+            auto v = convert(m_Builder->CreateLoad(alloc->getAllocatedType(), alloc), doubleIter->second->getAllocatedType());
+            if (!v)
+                return false;
+            m_Builder->CreateStore(v, doubleIter->second);
+        }
+
+        auto result = CreateDoubleArithmetic(site.id, ToDouble(site.left), ToDouble(site.right));
+        for (auto &[index, phi] : site.stackPhis)
+        {
+            // the double copy has the result of the operation on top of the stack
+            llvm::Value *v = result;
+            if (index > site.stack.size())
+                return false;
+            else if (index < site.stack.size())
+            {
+                if (!site.stack[index].IsLlvmValue())
+                    return false;
+                v = site.stack[index].GetLlvmValue();
+            }
+
+            v = convert(v, phi->getType());
+            if (!v)
+                return false;
+            phi->addIncoming(v, site.overflowBlock);
+        }
+
+        m_Builder->CreateBr(site.resumeBlock);
+    }
+    return true;
+}
+
+llvm::AllocaInst *Jit::CreateEntryBlockAlloca(llvm::Type *type, llvm::Value *initValue)
+{
+    // locals live in the entry block,so that the overflow blocks can reach the ones of both copies of the body
+    auto &entryBlock = m_Builder->GetInsertBlock()->getParent()->getEntryBlock();
+    llvm::IRBuilder<> builder(&entryBlock, entryBlock.begin());
+    auto alloc = builder.CreateAlloca(type);
+    if (initValue)
+        builder.CreateStore(initValue, alloc);
+    return alloc;
+}
+
 bool Jit::IsObjectType(llvm::Type *type)
 {
     return type == m_ObjectPtrType ||
@@ -10,6 +10,7 @@
 #include <llvm/IR/Function.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/Instructions.h>
+#include <llvm/IR/Intrinsics.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/Module.h>
@@ -35,6 +36,7 @@
 #include <llvm/IR/LLVMContext.h>
 #include <llvm-c/Core.h>
 #include <variant>
+#include <map>
 #include "JitUtils.h"
 #include "Chunk.h"
 #include "Value.h"
@@ -156,6 +158,23 @@ private:
         llvm::BasicBlock *endBranch{ nullptr };
     };
 
+    // an integer add/sub/mul whose result leaves the integer range,
+    // it continues in the copy of the function body that computes numbers in double
+    struct IntOverflowSite
+    {
+        llvm::BasicBlock *overflowBlock{ nullptr };
+        llvm::Intrinsic::ID id;
+        llvm::Value *left{ nullptr };
+        llvm::Value *right{ nullptr };
+        std::map<std::string, llvm::AllocaInst *> localVariables;
+        std::vector<StackValue> stack;
+
+        // set by the double copy of the function body
+        llvm::BasicBlock *resumeBlock{ nullptr };
+        std::map<std::string, llvm::AllocaInst *> doubleLocalVariables;
+        std::vector<std::pair<size_t, llvm::PHINode *>> stackPhis;
+    };
+
     enum class BranchState
     {
         IF_CONDITION,
@@ -180,6 +199,9 @@ private:
     llvm::Value *AllocateValue(llvm::Value *v);
     llvm::Value *AllocateValue(const Value &value);
 
+    llvm::Value *LoadNumFromValue(llvm::Value *valuePtr);
+    llvm::Value *LoadObjectFromValue(llvm::Value *valuePtr, llvm::PointerType *objectPtrType);
+
     void Push(llvm::Value *v);
     void Push(const Value &v);
     StackValue Pop();
@@ -191,10 +213,22 @@ private:
     uint8_t GetValueTypeFromLlvmType(llvm::Type *v);
 
     bool IsObjectType(llvm::Type* type);
+    bool IsNumType(llvm::Type *type);
+
+    llvm::Value *ToDouble(llvm::Value *v);
+    llvm::Value *ToInt64(llvm::Value *v);
+    llvm::Value *CreateIntArithmetic(llvm::Intrinsic::ID id, llvm::Value *l, llvm::Value *r, int32_t address, const std::map<std::string, llvm::AllocaInst *> &localVariables);
+    llvm::Value *CreateDoubleArithmetic(llvm::Intrinsic::ID id, llvm::Value *l, llvm::Value *r);
+    void CreateIntOverflowResume(int32_t address, const std::map<std::string, llvm::AllocaInst *> &localVariables);
+    bool LinkIntOverflowSites();
+
+    llvm::AllocaInst *CreateEntryBlockAlloca(llvm::Type *type, llvm::Value *initValue = nullptr);
 
     void AssignValue(llvm::Value* dst,llvm::Value* src,size_t size = sizeof(Value));
 
+#ifndef COMPUTEDUCK_BUILD_WITH_NAN_BOXING
     llvm::StructType *m_UnionType{ nullptr };
+#endif
 
     llvm::StructType *m_ValueType{ nullptr };
     llvm::PointerType *m_ValuePtrType{ nullptr };
@@ -242,6 +276,11 @@ private:
     StackValue m_ValueStack[STACK_COUNT];
 
     std::unordered_map<std::string, llvm::Function *> m_BuiltinFnCache;
+    std::set<std::string> m_DoubleLocalVariables;
+
+    // the function body is compiled a second time with m_DoubleArithmetic set if it has integer overflow sites
+    bool m_DoubleArithmetic{ false };
+    std::map<int32_t, IntOverflowSite> m_IntOverflowSites;
 
     std::unique_ptr<llvm::LLVMContext> m_Context;
     std::unique_ptr<llvm::Module> m_Module;
@@ -15,7 +15,7 @@ extern "C" COMPUTEDUCK_API Value* AllocateValueArray(uint32_t size)
 
 extern "C" COMPUTEDUCK_API StrObject *AllocateStrObject(const char *v)
 {
-    return ALLOCATE_OBJECT(StrObject, v);
+    return ALLOCATE_STR_OBJECT(v);
 }
 
 extern "C" COMPUTEDUCK_API ArrayObject *AllocateArrayObject(Value *elements, uint32_t size)
@@ -33,6 +33,11 @@ extern "C" COMPUTEDUCK_API StructObject *AllocateStructObject(HashTable *table)
     return ALLOCATE_OBJECT(StructObject, table);
 }
 
+extern "C" COMPUTEDUCK_API StructObject *NewStructObject(StructObject *prototype)
+{
+    return ALLOCATE_STRUCT_OBJECT(prototype->shape, prototype->fields);
+}
+
 extern "C" COMPUTEDUCK_API Value *GetLocalVariableSlot(int16_t index)
 {
     return GET_LOCAL_VARIABLE_SLOT(index);
@@ -53,6 +58,11 @@ extern "C" COMPUTEDUCK_API Value* HashTableGet(HashTable *table, StrObject *key)
     return table->Get(key);
 }
 
+extern "C" COMPUTEDUCK_API Value *StructObjectGetMember(StructObject *instance, StrObject *name)
+{
+    return instance->GetMember(name);
+}
+
 extern "C" COMPUTEDUCK_API RefObject *AllocateIndexRefObject(Value *ptr, const Value &v)
 {
     return ALLOCATE_INDEX_REF_OBJECT(ptr, v);
@@ -124,8 +134,10 @@ size_t HashValueList(Value *start, Value *end)
     {
         if (IS_OBJECT_VALUE(*slot))
             value ^= std::hash<uint8_t>()(TO_OBJECT_VALUE(*slot)->type);
+        else if (IS_NUM_VALUE(*slot)) // integers are passed to the jit function as double
+            value ^= std::hash<uint8_t>()(ValueType::NUM);
         else
-            value ^= std::hash<uint8_t>()(slot->type);
+            value ^= std::hash<uint8_t>()(GET_VALUE_TYPE(*slot));
     }
     return value;
 }
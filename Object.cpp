@@ -1,4 +1,95 @@
 #include "Object.h"
+#include "ObjectPool.h"
+#include "Allocator.h"
+
+Shape::~Shape()
+{
+    for (auto child : m_Transitions)
+        SAFE_DELETE(child);
+    std::vector<Shape *>().swap(m_Transitions);
+}
+
+Shape *Shape::GetRoot()
+{
+    static Shape root;
+    return &root;
+}
+
+Shape *Shape::Transition(StrObject *key)
+{
+    if (FindSlot(key) != -1)
+        return this;
+
+    for (auto child : m_Transitions)
+        if (child->m_Keys.back() == key)
+            return child;
+
+    auto child = new Shape();
+    child->m_Keys = m_Keys;
+    child->m_Keys.emplace_back(key);
+    child->m_KeyNames = m_KeyNames;
+    child->m_KeyNames.emplace_back(key->value);
+    m_Transitions.emplace_back(child);
+    return child;
+}
+
+int32_t Shape::FindSlot(StrObject *key) const
+{
+    for (size_t i = 0; i < m_Keys.size(); ++i)
+        if (m_Keys[i] == key)
+            return (int32_t)i;
+    return -1;
+}
+
+uint32_t Shape::GetFieldCount() const
+{
+    return (uint32_t)m_Keys.size();
+}
+
+const std::string &Shape::GetFieldName(uint32_t slot) const
+{
+    return m_KeyNames[slot];
+}
+
+StructObject::StructObject(Shape *shape, const Value *fieldValues, bool isInlineFields)
+    : Object(ObjectType::STRUCT), shape(shape), fields(nullptr), members(nullptr)
+{
+    auto fieldCount = shape->GetFieldCount();
+    fields = isInlineFields ? reinterpret_cast<Value *>(this + 1) : new Value[fieldCount];
+    for (uint32_t i = 0; i < fieldCount; ++i)
+        fields[i] = fieldValues[i];
+}
+
+StructObject::StructObject(HashTable *membs)
+    : Object(ObjectType::STRUCT), shape(nullptr), fields(nullptr), members(membs)
+{
+    if (membs->GetCount() > SHAPE_MAX_FIELD_COUNT)
+        return;
+
+    shape = Shape::GetRoot();
+    fields = new Value[membs->GetCount()];
+    for (uint32_t i = 0; i < membs->GetCapacity(); ++i)
+    {
+        if (membs->IsValid(i))
+        {
+            const auto &entry = membs->GetEntries()[i];
+            shape = shape->Transition(entry.key);
+            fields[shape->FindSlot(entry.key)] = entry.value;
+        }
+    }
+    SAFE_DELETE(members);
+}
+
+Value *StructObject::GetMember(StrObject *name)
+{
+    if (shape == nullptr)
+        return members->Get(name);
+
+    auto slot = shape->FindSlot(name);
+    if (slot == -1)
+        return nullptr;
+    return fields + slot;
+}
 
 std::string ObjectStringify(Object *object
 #ifndef NDEBUG
@@ -28,13 +119,21 @@ std::string ObjectStringify(Object *object
     {
         auto structObj = TO_STRUCT_OBJ(object);
         std::string result = "struct instance(0x" + PointerAddressToString(object) + "):\n{\n";
-        for (size_t i = 0; i < structObj->members->GetCapacity(); ++i)
+        if (structObj->shape)
         {
-            if (structObj->members->IsValid(i))
+            for (uint32_t i = 0; i < structObj->shape->GetFieldCount(); ++i)
+                result += structObj->shape->GetFieldName(i) + ":" + structObj->fields[i].Stringify() + "\n";
+        }
+        else
+        {
+            for (size_t i = 0; i < structObj->members->GetCapacity(); ++i)
             {
-                auto key = structObj->members->GetEntries()[i].key;
-                auto value = structObj->members->GetEntries()[i].value;
-                result += ObjectStringify(key) + ":" + value.Stringify() + "\n";
+                if (structObj->members->IsValid(i))
+                {
+                    auto key = structObj->members->GetEntries()[i].key;
+                    auto value = structObj->members->GetEntries()[i].value;
+                    result += ObjectStringify(key) + ":" + value.Stringify() + "\n";
+                }
             }
         }
         result = result.substr(0, result.size() - 1);
@@ -78,6 +177,8 @@ std::string ObjectStringify(Object *object
 
         return "Builtin :" + vStr;
     }
+    case ObjectType::STR_BUILDER:
+        return std::string(TO_STR_BUILDER_OBJ(object)->value ? TO_STR_BUILDER_OBJ(object)->value : "", TO_STR_BUILDER_OBJ(object)->len);
     default:
         ASSERT("Unknown object type");
     }
@@ -85,59 +186,84 @@ std::string ObjectStringify(Object *object
 
 void MarkObject(Object *object)
 {
+    // old objects keep their mark between collections,a minor collection stops at them
     if (object == nullptr)
         return;
 
-    object->marked = true;
+    if (Allocator::GetInstance()->IsParallelMarking())
+    {
+        // marking threads race for the mark bit,only the winner makes the object gray
+        if (!ObjectPool::AtomicMark(object))
+            return;
+    }
+    else if (!ObjectPool::Mark(object))
+        return;
+
+    // gray object,its references are marked later by BlackenObject
+    Allocator::GetInstance()->PushGrayObject(object);
+}
+
+size_t BlackenObject(Object *object)
+{
     switch (object->type)
     {
     case ObjectType::ARRAY:
     {
         for (int32_t i = 0; i < TO_ARRAY_OBJ(object)->len; ++i)
             TO_ARRAY_OBJ(object)->elements[i].Mark();
-        break;
+        return 1 + TO_ARRAY_OBJ(object)->len;
     }
     case ObjectType::STRUCT:
     {
-        TO_STRUCT_OBJ(object)->members->Mark();
-        break;
+        auto structObj = TO_STRUCT_OBJ(object);
+        if (structObj->shape)
+        {
+            for (uint32_t i = 0; i < structObj->shape->GetFieldCount(); ++i)
+                structObj->fields[i].Mark();
+            return 1 + structObj->shape->GetFieldCount();
+        }
+        structObj->members->Mark();
+        return 1 + structObj->members->GetCapacity();
     }
     case ObjectType::REF:
     {
         TO_REF_OBJ(object)->pointer->Mark();
-        break;
+        return 1;
     }
     case ObjectType::FUNCTION:
     {
         for (const auto &v : TO_FUNCTION_OBJ(object)->chunk.constants)
             v.Mark();
-        break;
+        return 1 + TO_FUNCTION_OBJ(object)->chunk.constants.size();
     }
     case ObjectType::UPVALUE:
     {
         TO_UPVALUE_OBJ(object)->closed.Mark();
-        break;
+        return 1;
     }
     case ObjectType::CLOSURE:
     {
         ClosureObject* closure =TO_CLOSURE_OBJ(object);
         MarkObject(closure->function);
-        for (size_t i = 0; i < UPVALUE_COUNT; ++i)
-        {
-            UpvalueObject* upvalue = closure->upvalues[i];
-            MarkObject(upvalue);
-        }
-        break;
+        for (uint8_t i = 0; i < closure->upvalueCount; ++i)
+            MarkObject(closure->upvalues[i]);
+        return 1 + closure->upvalueCount;
     }
     case ObjectType::BUILTIN:
     {
         if (TO_BUILTIN_OBJ(object)->Is<Value>())
             TO_BUILTIN_OBJ(object)->Get<Value>().Mark();
-        break;
+        return 1;
     }
     case ObjectType::STR:
+    {
+        if (!TO_STR_OBJ(object)->IsInterned())
+            MarkObject(TO_STR_OBJ(object)->interned);
+        return 1;
+    }
+    case ObjectType::STR_BUILDER:
     default:
-        break;
+        return 1;
     }
 }
 
@@ -146,7 +272,7 @@ void UnMarkObject(Object *object)
     if (object == nullptr)
         return;
 
-    object->marked = false;
+    ObjectPool::Unmark(object);
     switch (object->type)
     {
     case ObjectType::ARRAY:
@@ -157,7 +283,14 @@ void UnMarkObject(Object *object)
     }
     case ObjectType::STRUCT:
     {
-        TO_STRUCT_OBJ(object)->members->UnMark();
+        auto structObj = TO_STRUCT_OBJ(object);
+        if (structObj->shape)
+        {
+            for (uint32_t i = 0; i < structObj->shape->GetFieldCount(); ++i)
+                structObj->fields[i].UnMark();
+        }
+        else
+            structObj->members->UnMark();
         break;
     }
     case ObjectType::REF:
@@ -179,11 +312,8 @@ void UnMarkObject(Object *object)
     case ObjectType::CLOSURE:
     {
         UnMarkObject(TO_CLOSURE_OBJ(object)->function);
-        for (size_t i = 0; i < UPVALUE_COUNT; ++i)
-        {
-            auto upvalue = TO_CLOSURE_OBJ(object)->upvalues[i];
-            UnMarkObject(upvalue);
-        }
+        for (uint8_t i = 0; i < TO_CLOSURE_OBJ(object)->upvalueCount; ++i)
+            UnMarkObject(TO_CLOSURE_OBJ(object)->upvalues[i]);
         break;
     }
     case ObjectType::BUILTIN:
@@ -193,68 +323,122 @@ void UnMarkObject(Object *object)
         break;
     }
     case ObjectType::STR:
+    {
+        if (!TO_STR_OBJ(object)->IsInterned())
+            UnMarkObject(TO_STR_OBJ(object)->interned);
+        break;
+    }
+    case ObjectType::STR_BUILDER:
     default:
         break;
     }
 }
 
-COMPUTEDUCK_API void DeleteObject(Object *object)
+void BuiltinObject::SetExternalBytes(size_t bytes)
+{
+    if (!Is<NativeData>())
+        ASSERT("Only a native resource has external bytes.");
+
+    auto &nativeData = Get<NativeData>();
+    Allocator::GetInstance()->AdjustObjectBytes(this, (ptrdiff_t)bytes - (ptrdiff_t)nativeData.externalBytes);
+    nativeData.externalBytes = bytes;
+}
+
+void BuiltinObject::Dispose()
+{
+    if (!Is<NativeData>())
+        ASSERT("Only a native resource can be disposed.");
+
+    auto &nativeData = Get<NativeData>();
+    if (nativeData.nativeData == nullptr)
+        return;
+
+    nativeData.destroyFunc(nativeData.nativeData);
+    nativeData.nativeData = nullptr;
+    SetExternalBytes(0);
+}
+
+size_t ObjectBytes(Object *object)
 {
     switch (object->type)
     {
     case ObjectType::STR:
-    {
-        auto strObj = TO_STR_OBJ(object);
-        SAFE_DELETE(strObj);
-        return;
-    }
+        return sizeof(StrObject) + (TO_STR_OBJ(object)->IsInterned() ? TO_STR_OBJ(object)->len + 1 : 0);
     case ObjectType::ARRAY:
-    {
-        auto arrObj = TO_ARRAY_OBJ(object);
-        SAFE_DELETE(arrObj);
-        return;
-    }
+        return sizeof(ArrayObject) + TO_ARRAY_OBJ(object)->len * sizeof(Value);
     case ObjectType::STRUCT:
     {
         auto structObj = TO_STRUCT_OBJ(object);
-        SAFE_DELETE(structObj);
-        return;
+        if (structObj->shape)
+            return sizeof(StructObject) + structObj->shape->GetFieldCount() * sizeof(Value);
+        return sizeof(StructObject) + sizeof(HashTable) + structObj->members->GetCapacity() * sizeof(Entry);
     }
     case ObjectType::REF:
-    {
-        auto refObj = TO_REF_OBJ(object);
-        SAFE_DELETE(refObj);
-        return;
-    }
+        return sizeof(RefObject);
     case ObjectType::FUNCTION:
     {
-        auto fnObj = TO_FUNCTION_OBJ(object);
-        SAFE_DELETE(fnObj);
-        return;
+        const auto &chunk = TO_FUNCTION_OBJ(object)->chunk;
+        return sizeof(FunctionObject) + chunk.opCodeList.capacity() + chunk.constants.capacity() * sizeof(Value);
     }
     case ObjectType::UPVALUE:
-    {
-        auto upvalueObj = TO_UPVALUE_OBJ(object);
-        SAFE_DELETE(upvalueObj);
-        return;
-    }
+        return sizeof(UpvalueObject);
     case ObjectType::CLOSURE:
-    {
-        auto closureObj = TO_CLOSURE_OBJ(object);
-        SAFE_DELETE(closureObj);
-        return;
-    }
+        return sizeof(ClosureObject) + TO_CLOSURE_OBJ(object)->upvalueCount * sizeof(UpvalueObject *);
     case ObjectType::BUILTIN:
     {
         auto builtinObj = TO_BUILTIN_OBJ(object);
-        SAFE_DELETE(builtinObj);
-        return;
+        return sizeof(BuiltinObject) + (builtinObj->Is<NativeData>() ? builtinObj->Get<NativeData>().externalBytes : 0);
     }
+    case ObjectType::STR_BUILDER:
+        return sizeof(StrBuilderObject) + TO_STR_BUILDER_OBJ(object)->capacity;
     default:
-        return;
+        return 0;
+    }
+}
+
+// objects live in ObjectPool memory,destroy them in place,the slot is handed back to the pool by the caller
+#define DESTROY_OBJECT(type, obj) \
+    do                            \
+    {                             \
+        obj->~type();             \
+        return sizeof(type);      \
+    } while (false)
+
+COMPUTEDUCK_API size_t DestroyObject(Object *object)
+{
+    switch (object->type)
+    {
+    case ObjectType::STR:
+        DESTROY_OBJECT(StrObject, TO_STR_OBJ(object));
+    case ObjectType::ARRAY:
+        DESTROY_OBJECT(ArrayObject, TO_ARRAY_OBJ(object));
+    case ObjectType::STRUCT:
+        DESTROY_OBJECT(StructObject, TO_STRUCT_OBJ(object));
+    case ObjectType::REF:
+        DESTROY_OBJECT(RefObject, TO_REF_OBJ(object));
+    case ObjectType::FUNCTION:
+        DESTROY_OBJECT(FunctionObject, TO_FUNCTION_OBJ(object));
+    case ObjectType::UPVALUE:
+        DESTROY_OBJECT(UpvalueObject, TO_UPVALUE_OBJ(object));
+    case ObjectType::CLOSURE:
+        DESTROY_OBJECT(ClosureObject, TO_CLOSURE_OBJ(object));
+    case ObjectType::BUILTIN:
+        DESTROY_OBJECT(BuiltinObject, TO_BUILTIN_OBJ(object));
+    case ObjectType::STR_BUILDER:
+        DESTROY_OBJECT(StrBuilderObject, TO_STR_BUILDER_OBJ(object));
+    default:
+        return 0;
     }
 }
 
+COMPUTEDUCK_API void DeleteObject(Object *object)
+{
+    if (DestroyObject(object) != 0)
+        ObjectPool::GetInstance()->Free(object);
+}
+
+#undef DESTROY_OBJECT
+
 bool IsObjectEqual(Object *left, Object *right)
 {
     if ((left == nullptr || right == nullptr) || (left->type != right->type))
@@ -262,7 +446,14 @@ bool IsObjectEqual(Object *left, Object *right)
     switch (left->type)
     {
     case ObjectType::STR:
-        return TO_STR_OBJ(left)->hash == TO_STR_OBJ(right)->hash;
+    {
+        // equal script strings share one interned string,only a member name may equal another one
+        auto leftStr = TO_STR_OBJ(left);
+        auto rightStr = TO_STR_OBJ(right);
+        if (leftStr->interned == rightStr->interned)
+            return true;
+        return leftStr->hash == rightStr->hash && leftStr->len == rightStr->len && memcmp(leftStr->value, rightStr->value, leftStr->len) == 0;
+    }
     case ObjectType::ARRAY:
     {
         if (TO_ARRAY_OBJ(left)->len != TO_ARRAY_OBJ(right)->len)
@@ -273,7 +464,7 @@ bool IsObjectEqual(Object *left, Object *right)
         return true;
     }
     case ObjectType::STRUCT:
-        return TO_STRUCT_OBJ(left)->members == TO_STRUCT_OBJ(right)->members;
+        return left == right;
     case ObjectType::REF:
         return *TO_REF_OBJ(left)->pointer == *TO_REF_OBJ(right)->pointer;
     case ObjectType::FUNCTION:
@@ -291,7 +482,9 @@ bool IsObjectEqual(Object *left, Object *right)
     }
     case ObjectType::BUILTIN:
     {
-        if (TO_BUILTIN_OBJ(left)->Is<NativeData>())
+        if (TO_BUILTIN_OBJ(left)->fn || TO_BUILTIN_OBJ(right)->fn)
+            return TO_BUILTIN_OBJ(left)->fn == TO_BUILTIN_OBJ(right)->fn;
+        else if (TO_BUILTIN_OBJ(left)->Is<NativeData>())
         {
             auto thisNd = TO_BUILTIN_OBJ(left)->Get<NativeData>();
             auto otherNd = TO_BUILTIN_OBJ(right)->Get<NativeData>();
@@ -308,9 +501,9 @@ bool IsObjectEqual(Object *left, Object *right)
     {
         auto leftClosure = TO_CLOSURE_OBJ(left);
         auto rightClosure = TO_CLOSURE_OBJ(right);
-        if (!IsObjectEqual(leftClosure->function, rightClosure->function))
+        if (!IsObjectEqual(leftClosure->function, rightClosure->function) || leftClosure->upvalueCount != rightClosure->upvalueCount)
             return false;
-        for (size_t i = 0; i < UPVALUE_COUNT; ++i)
+        for (uint8_t i = 0; i < leftClosure->upvalueCount; ++i)
         {
             auto upvalue1 = leftClosure->upvalues[i];
             auto upvalue2 = rightClosure->upvalues[i];
@@ -319,6 +512,8 @@ bool IsObjectEqual(Object *left, Object *right)
         }
         return true;
     }
+    case ObjectType::STR_BUILDER:
+        return left == right;
     default:
         ASSERT("Unknown object type");
         return false;
@@ -332,31 +527,102 @@ StrObject *StrAdd(StrObject *left, StrObject *right)
     memcpy(newStr, left->value, left->len);
     memcpy(newStr + left->len, right->value, right->len);
     newStr[length] = '\0';
-    return new StrObject(newStr);
+    return TAKE_STR_OBJECT(newStr, length);
+}
+
+// interned characters are shared by every string with the same content,
+// so the changed string gets other interned characters instead of changing them in place
+static void SetStrContent(StrObject *str, char *chars, size_t len)
+{
+    if (str->IsInterned())
+        ASSERT("A member name can not be changed.");
+
+    auto interned = Allocator::GetInstance()->TakeInternedStrObject(chars, len);
+    str->interned = interned;
+    str->value = interned->value;
+    str->len = interned->len;
+    str->hash = interned->hash;
+    Allocator::GetInstance()->WriteBarrier(str, interned);
 }
 
 void StrInsert(StrObject *left, uint32_t idx, StrObject *right)
 {
     size_t length = left->len + right->len;
     char *newStr = new char[length + 1];
-    memset(newStr, '\0', length + 1);
-    strncpy(newStr, left->value, idx);
-    newStr = strcat(newStr, right->value);
-    newStr = strcat(newStr, left->value + idx);
-
-    left->value = newStr;
-    left->len = length;
+    memcpy(newStr, left->value, idx);
+    memcpy(newStr + idx, right->value, right->len);
+    memcpy(newStr + idx + right->len, left->value + idx, left->len - idx);
+    newStr[length] = '\0';
+    SetStrContent(left, newStr, length);
 }
 
 void StrErase(StrObject *left, uint32_t idx)
 {
-    int32_t i = 0, j = 0;
-    for (; left->value[i] != '\0'; ++i)
-        if (i != idx)
-            left->value[j++] = left->value[i];
+    size_t length = left->len - 1;
+    char *newStr = new char[length + 1];
+    memcpy(newStr, left->value, idx);
+    memcpy(newStr + idx, left->value + idx + 1, length - idx);
+    newStr[length] = '\0';
+    SetStrContent(left, newStr, length);
+}
 
-    left->value[j] = '\0';
-    left->len--;
+StrObject *StrConcat(StrObject *const *strs, size_t count)
+{
+    size_t length = 0;
+    for (size_t i = 0; i < count; ++i)
+        length += strs[i]->len;
+
+    char *newStr = new char[length + 1];
+    char *dst = newStr;
+    for (size_t i = 0; i < count; ++i)
+    {
+        memcpy(dst, strs[i]->value, strs[i]->len);
+        dst += strs[i]->len;
+    }
+    newStr[length] = '\0';
+    return TAKE_STR_OBJECT(newStr, length);
+}
+
+// grows the buffer to hold at least len more chars,the capacity doubles so a sequence of appends copies O(n) chars
+static void StrBuilderReserve(StrBuilderObject *builder, size_t len)
+{
+    size_t required = builder->len + len + 1;
+    if (required <= builder->capacity)
+        return;
+
+    size_t capacity = builder->capacity < STR_BUILDER_MIN_CAPACITY ? STR_BUILDER_MIN_CAPACITY : builder->capacity;
+    while (capacity < required)
+        capacity *= 2;
+
+    char *newValue = new char[capacity];
+    if (builder->value)
+        memcpy(newValue, builder->value, builder->len + 1);
+    SAFE_DELETE_ARRAY(builder->value);
+
+    Allocator::GetInstance()->AdjustObjectBytes(builder, (ptrdiff_t)capacity - (ptrdiff_t)builder->capacity);
+    builder->value = newValue;
+    builder->capacity = capacity;
+}
+
+void StrBuilderAppend(StrBuilderObject *builder, const char *chars, size_t len)
+{
+    StrBuilderReserve(builder, len);
+    memcpy(builder->value + builder->len, chars, len);
+    builder->len += len;
+    builder->value[builder->len] = '\0';
+}
+
+void StrBuilderInsert(StrBuilderObject *builder, size_t idx, const char *chars, size_t len)
+{
+    StrBuilderReserve(builder, len);
+    memmove(builder->value + idx + len, builder->value + idx, builder->len - idx + 1);
+    memcpy(builder->value + idx, chars, len);
+    builder->len += len;
+}
+
+StrObject *StrBuilderToString(StrBuilderObject *builder)
+{
+    return Allocator::GetInstance()->AllocateStrObject(builder->value ? builder->value : "", builder->len);
 }
 
 void ArrayInsert(ArrayObject *left, uint32_t idx, const Value &element)
@@ -372,6 +638,7 @@ void ArrayInsert(ArrayObject *left, uint32_t idx, const Value &element)
 
     left->elements = newElements;
     left->len += 1;
+    Allocator::GetInstance()->AdjustObjectBytes(left, sizeof(Value));
 }
 
 void ArrayErase(ArrayObject *left, uint32_t idx)
@@ -382,4 +649,5 @@ void ArrayErase(ArrayObject *left, uint32_t idx)
             left->elements[j++] = left->elements[i];
 
     left->len--;
+    Allocator::GetInstance()->AdjustObjectBytes(left, -(ptrdiff_t)sizeof(Value));
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <unordered_map>
 #include <functional>
 #include <variant>
+#include <vector>
 #include "Utils.h"
 #include "Chunk.h"
 #include "Value.h"
@@ -22,6 +23,7 @@
 #define TO_UPVALUE_OBJ(obj) (static_cast<UpvalueObject *>(obj))
 #define TO_CLOSURE_OBJ(obj) (static_cast<ClosureObject *>(obj))
 #define TO_BUILTIN_OBJ(obj) (static_cast<BuiltinObject *>(obj))
+#define TO_STR_BUILDER_OBJ(obj) (static_cast<StrBuilderObject *>(obj))
 
 #define IS_STR_OBJ(obj) (obj->type == ObjectType::STR)
 #define IS_ARRAY_OBJ(obj) (obj->type == ObjectType::ARRAY)
@@ -31,6 +33,7 @@
 #define IS_UPVALUE_OBJ(obj) (obj->type == ObjectType::UPVALUE)
 #define IS_CLOSURE_OBJ(obj) (obj->type == ObjectType::CLOSURE)
 #define IS_BUILTIN_OBJ(obj) (obj->type == ObjectType::BUILTIN)
+#define IS_STR_BUILDER_OBJ(obj) (obj->type == ObjectType::STR_BUILDER)
 
 enum ObjectType : uint8_t
 {
@@ -42,34 +45,58 @@ enum ObjectType : uint8_t
     FUNCTION,
     CLOSURE,
     BUILTIN,
+    STR_BUILDER,
 };
 
 struct Object
 {
-    Object(ObjectType type) : type(type), marked(false), next(nullptr) {}
+    Object(ObjectType type) : type(type), remembered(false) {}
     ~Object() = default;
 
+    // the mark bit and the generation live in the side bitmaps of the object pool page,
+    // outside of a collection old objects stay marked(sticky mark bits),see ObjectPool
     ObjectType type;
-    bool marked;
-    Object *next;
+    // young object already in the remembered set
+    bool remembered;
 };
 
+// the characters of equal strings are interned in one StrObject,
+// a script string(ALLOCATE_STR_OBJECT/TAKE_STR_OBJECT) is its own object sharing them,
+// so insert/erase can point it to other characters without changing any other string
 struct StrObject : public Object
 {
-    StrObject(char *v) : Object(ObjectType::STR), value(v), len(strlen(value)) { hash = HashString(value); }
-    StrObject(const char *v) : Object(ObjectType::STR), len(strlen(v))
+    // an interned string,takes the ownership of v
+    StrObject(char *v, size_t len, uint32_t hash) : Object(ObjectType::STR), value(v), len(len), hash(hash), interned(this) {}
+    // a script string
+    StrObject(StrObject *interned) : Object(ObjectType::STR), value(interned->value), len(interned->len), hash(interned->hash), interned(interned) {}
+    ~StrObject()
     {
-        value = new char[len + 1];
-        strcpy(value, v);
-        value[len] = '\0';
-
-        hash = HashString(value);
+        if (IsInterned())
+            SAFE_DELETE_ARRAY(value);
     }
-    ~StrObject() { SAFE_DELETE_ARRAY(value); }
+
+    bool IsInterned() const { return interned == this; }
 
     char *value;
     size_t len;
     size_t hash;
+    // owns value,equal strings share it
+    StrObject *interned;
+};
+
+// the first buffer of a string builder,it doubles from then on
+constexpr size_t STR_BUILDER_MIN_CAPACITY = 16;
+
+// a string that is changed in place,its buffer grows geometrically so appending n chars costs O(n) amortized.
+// unlike StrObject it is never interned,StrBuilderToString copies the content into an interned string
+struct StrBuilderObject : public Object
+{
+    StrBuilderObject() : Object(ObjectType::STR_BUILDER), value(nullptr), len(0), capacity(0) {}
+    ~StrBuilderObject() { SAFE_DELETE_ARRAY(value); }
+
+    char *value;
+    size_t len;
+    size_t capacity;
 };
 
 struct ArrayObject : public Object
@@ -91,16 +118,24 @@ struct RefObject : public Object
 
 struct FunctionObject : public Object
 {
-    FunctionObject(Chunk chunk, uint8_t localVarCount = 0, uint8_t parameterCount = 0)
-        : Object(ObjectType::FUNCTION), chunk(chunk), localVarCount(localVarCount), parameterCount(parameterCount)
+    FunctionObject(Chunk chunk, uint8_t localVarCount = 0, uint8_t parameterCount = 0, uint64_t escapingParamMask = UINT64_MAX)
+        : Object(ObjectType::FUNCTION), chunk(chunk), localVarCount(localVarCount), parameterCount(parameterCount), escapingParamMask(escapingParamMask)
     {
     }
 
     ~FunctionObject() = default;
 
+    // whether a ref passed as the parameter may outlive the call,parameters from the 64th on always may
+    bool IsParamEscaping(uint8_t index) const
+    {
+        return index >= 64 || ((escapingParamMask >> index) & 1);
+    }
+
     Chunk chunk;
     uint8_t localVarCount;
     uint8_t parameterCount;
+    // one bit per parameter,set by the escape analysis of the compiler
+    uint64_t escapingParamMask;
 };
 
 struct UpvalueObject : public Object
@@ -113,15 +148,18 @@ struct UpvalueObject : public Object
     UpvalueObject *nextUpvalue{nullptr};
 };
 
+// the upvalue pointers follow the closure in the same allocation,see Allocator::AllocateClosureObject
 struct ClosureObject : public Object
 {
-    ClosureObject(FunctionObject *fn) : Object(ObjectType::CLOSURE), function(fn)
+    ClosureObject(FunctionObject *fn, UpvalueObject *const *capturedUpvalues, uint8_t upvalueCount)
+        : Object(ObjectType::CLOSURE), function(fn), upvalues(reinterpret_cast<UpvalueObject **>(this + 1)), upvalueCount(upvalueCount)
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
-                                        ,
-                                        callCount(0), uuid(GenerateUUID())
+          ,
+          callCount(0), uuid(GenerateUUID())
 #endif
     {
-        memset(upvalues, 0, sizeof(UpvalueObject *) * UPVALUE_COUNT);
+        for (uint8_t i = 0; i < upvalueCount; ++i)
+            upvalues[i] = capturedUpvalues[i];
     }
     ~ClosureObject()
     {
@@ -132,7 +170,8 @@ struct ClosureObject : public Object
     }
 
     FunctionObject *function;
-    UpvalueObject *upvalues[UPVALUE_COUNT]{};
+    UpvalueObject **upvalues;
+    uint8_t upvalueCount;
 
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
     uint32_t callCount;
@@ -142,24 +181,72 @@ struct ClosureObject : public Object
 #endif
 };
 
+// hidden class shared by all struct instances with the same member layout,
+// maps a member name to its slot in StructObject::fields.
+// shapes form a transition tree from the root shape,each child appends one member to its parent
+class COMPUTEDUCK_API Shape
+{
+public:
+    Shape() = default;
+    ~Shape();
+
+    static Shape *GetRoot();
+
+    // the shape with the member appended,or this shape if it already has the member
+    Shape *Transition(StrObject *key);
+    // slot index of the member,-1 if not found
+    int32_t FindSlot(StrObject *key) const;
+
+    uint32_t GetFieldCount() const;
+    const std::string &GetFieldName(uint32_t slot) const;
+
+private:
+    // member names are interned for the lifetime of the vm(see Allocator::AllocateNameStrObject),
+    // so they are compared by pointer
+    std::vector<StrObject *> m_Keys;
+    std::vector<std::string> m_KeyNames;
+    std::vector<Shape *> m_Transitions;
+};
+
 struct StructObject : public Object
 {
-    StructObject(HashTable *membs) : Object(ObjectType::STRUCT), members(membs) {}
-    ~StructObject() { SAFE_DELETE(members); }
+    // copies the field values,they are stored right behind the object in the same pool slot if isInlineFields
+    StructObject(Shape *shape, const Value *fieldValues, bool isInlineFields);
+    StructObject(HashTable *membs);
+    ~StructObject()
+    {
+        if (fields != reinterpret_cast<Value *>(this + 1))
+            SAFE_DELETE_ARRAY(fields);
+        SAFE_DELETE(members);
+    }
+
+    // nullptr if the instance has no such member
+    Value *GetMember(StrObject *name);
 
+    // shaped instances store member values inline in fields,
+    // instances with a dynamic layout(shape == nullptr) keep their own members table instead
+    Shape *shape;
+    Value *fields;
     HashTable *members;
 };
 
-using BuiltinFn = std::function<bool(Value *, uint8_t, Value &)>;
+using BuiltinFn = bool (*)(Value *args, uint8_t argCount, Value &result);
+
+// arity of a builtin function that checks its argument count by itself
+constexpr int16_t BUILTIN_FN_VARIADIC = -1;
 
 struct NativeData
 {
     void *nativeData{nullptr};
     std::function<void(void *nativeData)> destroyFunc;
+    // memory held by the native resource outside of the gc heap,see BuiltinObject::SetExternalBytes
+    size_t externalBytes{0};
 
     template <typename T>
     T *As()
     {
+        if (nativeData == nullptr)
+            ASSERT("The native resource is already disposed.");
         return (T *)nativeData;
     }
 
@@ -181,9 +268,12 @@ struct BuiltinObject : public Object
         data = nd;
     }
 
-    template <typename T>
-    requires(std::is_same_v<T, BuiltinFn> || std::is_same_v<T, Value>)
-        BuiltinObject(const T &v)
+    BuiltinObject(BuiltinFn fn, int16_t arity = BUILTIN_FN_VARIADIC)
+        : Object(ObjectType::BUILTIN), fn(fn), arity(arity)
+    {
+    }
+
+    BuiltinObject(const Value &v)
         : Object(ObjectType::BUILTIN)
     {
         data = v;
@@ -191,13 +281,19 @@ struct BuiltinObject : public Object
 
     ~BuiltinObject()
     {
-        if (Is<NativeData>())
+        if (Is<NativeData>() && Get<NativeData>().nativeData)
             Get<NativeData>().destroyFunc(Get<NativeData>().nativeData);
     }
 
+    // bindings report the native memory of the resource,so that large resources make the gc run earlier
+    void SetExternalBytes(size_t bytes);
+
+    // releases the native resource now instead of when the object is collected
+    void Dispose();
+
     template <typename T>
-    requires(std::is_same_v<T, BuiltinFn> || std::is_same_v<T, Value> || std::is_same_v<T, NativeData>)
-        T Get()
+    requires(std::is_same_v<T, Value> || std::is_same_v<T, NativeData>)
+        T &Get()
     {
         return std::get<T>(data);
     }
@@ -205,10 +301,18 @@ struct BuiltinObject : public Object
     template <typename T>
     requires(std::is_same_v<T, BuiltinFn> || std::is_same_v<T, Value> || std::is_same_v<T, NativeData>) bool Is()
     {
-        return std::holds_alternative<T>(data);
+        if constexpr (std::is_same_v<T, BuiltinFn>)
+            return fn != nullptr;
+        else
+            return std::holds_alternative<T>(data);
     }
 
-    std::variant<NativeData, BuiltinFn, Value> data;
+    // a builtin function keeps no data,it is only the fn below
+    std::variant<std::monostate, NativeData, Value> data;
+
+    // the call path reads these directly,fn is nullptr unless the builtin is a function
+    BuiltinFn fn{nullptr};
+    int16_t arity{BUILTIN_FN_VARIADIC};
 };
 
 COMPUTEDUCK_API std::string ObjectStringify(Object *object
@@ -219,7 +323,13 @@ COMPUTEDUCK_API std::string ObjectStringify(Object *object
 );
 
 COMPUTEDUCK_API void MarkObject(Object *object);
+// marks the references of a gray object,returns the amount of work done(in object slots)
+COMPUTEDUCK_API size_t BlackenObject(Object *object);
 COMPUTEDUCK_API void UnMarkObject(Object *object);
+// bytes held by the object,its own size and the buffers it owns
+COMPUTEDUCK_API size_t ObjectBytes(Object *object);
+// runs the destructor in place and returns the object size,the memory is not released
+COMPUTEDUCK_API size_t DestroyObject(Object *object);
 COMPUTEDUCK_API void DeleteObject(Object *object);
 
 extern "C" COMPUTEDUCK_API bool IsObjectEqual(Object *left, Object *right);
@@ -227,6 +337,12 @@ extern "C" COMPUTEDUCK_API bool IsObjectEqual(Object *left, Object *right);
 extern "C" COMPUTEDUCK_API StrObject *StrAdd(StrObject *left, StrObject *right);
 extern "C" COMPUTEDUCK_API void StrInsert(StrObject *left, uint32_t idx, StrObject *right);
 extern "C" COMPUTEDUCK_API void StrErase(StrObject *left, uint32_t idx);
+// joins the strings into one string,the buffer is allocated once for the total length
+COMPUTEDUCK_API StrObject *StrConcat(StrObject *const *strs, size_t count);
+
+COMPUTEDUCK_API void StrBuilderAppend(StrBuilderObject *builder, const char *chars, size_t len);
+COMPUTEDUCK_API void StrBuilderInsert(StrBuilderObject *builder, size_t idx, const char *chars, size_t len);
+COMPUTEDUCK_API StrObject *StrBuilderToString(StrBuilderObject *builder);
 
 extern "C" COMPUTEDUCK_API void ArrayInsert(ArrayObject *left, uint32_t idx, const Value &element);
 extern "C" COMPUTEDUCK_API void ArrayErase(ArrayObject *left, uint32_t idx);
\ No newline at end of file
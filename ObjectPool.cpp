@@ -0,0 +1,210 @@
+#include "ObjectPool.h"
+#include <new>
+#include <cstring>
+
+ObjectPool::~ObjectPool()
+{
+    Destroy();
+}
+
+ObjectPool *ObjectPool::GetInstance()
+{
+    static ObjectPool instance;
+    return &instance;
+}
+
+void *ObjectPool::Allocate(size_t size)
+{
+    auto sizeClass = (uint32_t)((size + POOL_SIZE_CLASS_GRANULARITY - 1) / POOL_SIZE_CLASS_GRANULARITY - 1);
+
+    PoolPage *page = m_AvailablePages[sizeClass];
+    if (page == nullptr)
+        page = AllocatePage(sizeClass);
+
+    void *slot = nullptr;
+    if (page->freeList)
+    {
+        slot = page->freeList;
+        page->freeList = page->freeList->next;
+    }
+    else
+        slot = page->slots + (size_t)page->bumpIndex++ * page->slotSize;
+
+    page->liveCount++;
+
+    auto bit = GetSlotBit(slot);
+    page->youngBits[bit / 64] |= (uint64_t)1 << (bit % 64);
+    if (!page->hasYoungObjects)
+    {
+        page->hasYoungObjects = true;
+        page->nextYoung = m_YoungPages;
+        m_YoungPages = page;
+    }
+
+    // the page is full,take it out of the available list
+    if (page->freeList == nullptr && page->bumpIndex == page->slotCount)
+    {
+        m_AvailablePages[sizeClass] = page->nextAvailable;
+        page->nextAvailable = nullptr;
+        page->isAvailable = false;
+    }
+
+    return slot;
+}
+
+void ObjectPool::Free(void *ptr)
+{
+    PoolPage *page = GetPage(ptr);
+    FreeSlot(page, ptr);
+
+    if (!page->isAvailable)
+    {
+        page->nextAvailable = m_AvailablePages[page->sizeClass];
+        m_AvailablePages[page->sizeClass] = page;
+        page->isAvailable = true;
+    }
+}
+
+void ObjectPool::FreeSlot(PoolPage *page, void *ptr)
+{
+    auto bit = GetSlotBit(ptr);
+    auto mask = ~((uint64_t)1 << (bit % 64));
+    page->youngBits[bit / 64] &= mask;
+    page->oldBits[bit / 64] &= mask;
+    page->markBits[bit / 64] &= mask;
+
+    auto slot = static_cast<PoolFreeSlot *>(ptr);
+    slot->next = page->freeList;
+    page->freeList = slot;
+    page->liveCount--;
+}
+
+void ObjectPool::ReleaseEmptyPages()
+{
+    for (uint32_t i = 0; i < POOL_SIZE_CLASS_COUNT; ++i)
+    {
+        // rebuild the available list,keep one empty page per size class to avoid page churn
+        m_AvailablePages[i] = nullptr;
+        bool keptEmptyPage = false;
+
+        PoolPage *page = m_Pages[i];
+        while (page)
+        {
+            PoolPage *next = page->next;
+            // a page on the young list is released after its young objects were swept
+            if (page->liveCount == 0 && keptEmptyPage && !page->hasYoungObjects)
+                FreePage(page);
+            else
+            {
+                if (page->liveCount == 0)
+                    keptEmptyPage = true;
+
+                page->isAvailable = page->liveCount < page->slotCount;
+                if (page->isAvailable)
+                {
+                    page->nextAvailable = m_AvailablePages[i];
+                    m_AvailablePages[i] = page;
+                }
+                else
+                    page->nextAvailable = nullptr;
+            }
+            page = next;
+        }
+    }
+}
+
+void ObjectPool::Destroy()
+{
+    for (uint32_t i = 0; i < POOL_SIZE_CLASS_COUNT; ++i)
+    {
+        while (m_Pages[i])
+            FreePage(m_Pages[i]);
+        m_AvailablePages[i] = nullptr;
+    }
+    m_YoungPages = nullptr;
+}
+
+size_t ObjectPool::GetPageCount() const
+{
+    return m_PageCount;
+}
+
+PoolPage *ObjectPool::GetPages(uint32_t sizeClass) const
+{
+    return m_Pages[sizeClass];
+}
+
+PoolPage *ObjectPool::TakeYoungPages()
+{
+    PoolPage *pages = m_YoungPages;
+    m_YoungPages = nullptr;
+    return pages;
+}
+
+void ObjectPool::ClearMarks()
+{
+    for (uint32_t i = 0; i < POOL_SIZE_CLASS_COUNT; ++i)
+        for (PoolPage *page = m_Pages[i]; page; page = page->next)
+            memset(page->markBits, 0, sizeof(page->markBits));
+}
+
+PoolPage *ObjectPool::AllocateUnmanagedPage(uint32_t slotSize)
+{
+    void *memory = ::operator new(POOL_PAGE_SIZE, std::align_val_t(POOL_PAGE_SIZE));
+
+    auto page = new (memory) PoolPage();
+    page->slotSize = slotSize;
+
+    auto headerSize = (sizeof(PoolPage) + POOL_SIZE_CLASS_GRANULARITY - 1) & ~(POOL_SIZE_CLASS_GRANULARITY - 1);
+    page->slots = static_cast<uint8_t *>(memory) + headerSize;
+    page->slotCount = (uint32_t)((POOL_PAGE_SIZE - headerSize) / slotSize);
+
+    memset(page->markBits, 0xff, sizeof(page->markBits));
+    return page;
+}
+
+void ObjectPool::FreeUnmanagedPage(PoolPage *page)
+{
+    page->~PoolPage();
+    ::operator delete(page, std::align_val_t(POOL_PAGE_SIZE));
+}
+
+PoolPage *ObjectPool::AllocatePage(uint32_t sizeClass)
+{
+    // pages are aligned to their size,so the page of a slot is found by masking the slot address
+    void *memory = ::operator new(POOL_PAGE_SIZE, std::align_val_t(POOL_PAGE_SIZE));
+
+    auto page = new (memory) PoolPage();
+    page->sizeClass = sizeClass;
+    page->slotSize = (uint32_t)((sizeClass + 1) * POOL_SIZE_CLASS_GRANULARITY);
+
+    auto headerSize = (sizeof(PoolPage) + POOL_SIZE_CLASS_GRANULARITY - 1) & ~(POOL_SIZE_CLASS_GRANULARITY - 1);
+    page->slots = static_cast<uint8_t *>(memory) + headerSize;
+    page->slotCount = (uint32_t)((POOL_PAGE_SIZE - headerSize) / page->slotSize);
+
+    page->next = m_Pages[sizeClass];
+    if (m_Pages[sizeClass])
+        m_Pages[sizeClass]->prev = page;
+    m_Pages[sizeClass] = page;
+
+    page->nextAvailable = m_AvailablePages[sizeClass];
+    m_AvailablePages[sizeClass] = page;
+    page->isAvailable = true;
+
+    m_PageCount++;
+    return page;
+}
+
+void ObjectPool::FreePage(PoolPage *page)
+{
+    if (page->prev)
+        page->prev->next = page->next;
+    else
+        m_Pages[page->sizeClass] = page->next;
+    if (page->next)
+        page->next->prev = page->prev;
+
+    page->~PoolPage();
+    ::operator delete(page, std::align_val_t(POOL_PAGE_SIZE));
+    m_PageCount--;
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <bit>
+#include "Utils.h"
+
+// gc objects are carved out of fixed size pages,one page serves one size class.
+// each page keeps its own free list,so a page whose objects are all swept can be released as a whole
+constexpr size_t POOL_PAGE_SIZE = 64 * 1024;
+constexpr size_t POOL_SIZE_CLASS_GRANULARITY = 16;
+constexpr size_t POOL_SIZE_CLASS_COUNT = 32; // 16,32,...,512 bytes
+constexpr size_t POOL_MAX_OBJECT_SIZE = POOL_SIZE_CLASS_GRANULARITY * POOL_SIZE_CLASS_COUNT;
+
+// the side bitmaps of a page have one bit per granule,a slot owns the bit of its first granule
+constexpr size_t POOL_BITMAP_WORD_COUNT = POOL_PAGE_SIZE / POOL_SIZE_CLASS_GRANULARITY / 64;
+
+struct PoolFreeSlot
+{
+    PoolFreeSlot *next;
+};
+
+struct PoolPage
+{
+    // all pages of the size class
+    PoolPage *prev{nullptr};
+    PoolPage *next{nullptr};
+    // pages of the size class that still have free slots
+    PoolPage *nextAvailable{nullptr};
+    bool isAvailable{false};
+    // pages with objects allocated since the last collection
+    PoolPage *nextYoung{nullptr};
+    bool hasYoungObjects{false};
+
+    uint32_t sizeClass{0};
+    uint32_t slotSize{0};
+    uint32_t slotCount{0};
+    uint32_t liveCount{0};
+    // slots from bumpIndex on were never handed out
+    uint32_t bumpIndex{0};
+    PoolFreeSlot *freeList{nullptr};
+    uint8_t *slots{nullptr};
+
+    // the gc state of the objects lives here instead of in their headers,
+    // so marking writes no object and a sweep scans bitmaps instead of chasing a list
+    // objects allocated since the last collection
+    uint64_t youngBits[POOL_BITMAP_WORD_COUNT]{};
+    // objects that survived a collection
+    uint64_t oldBits[POOL_BITMAP_WORD_COUNT]{};
+    uint64_t markBits[POOL_BITMAP_WORD_COUNT]{};
+};
+
+class COMPUTEDUCK_API ObjectPool
+{
+public:
+    static ObjectPool *GetInstance();
+
+    // size is at most POOL_MAX_OBJECT_SIZE
+    void *Allocate(size_t size);
+    void Free(void *ptr);
+
+    // hands the slot back to its page only,the available lists are rebuilt by ReleaseEmptyPages.
+    // pages do not share state,so slots of different pages may be freed on different threads
+    static void FreeSlot(PoolPage *page, void *ptr);
+
+    // release pages without live objects,called after each sweep
+    void ReleaseEmptyPages();
+    void Destroy();
+
+    size_t GetPageCount() const;
+    PoolPage *GetPages(uint32_t sizeClass) const;
+
+    // pages with young objects,the list is handed over to the caller and starts empty again
+    PoolPage *TakeYoungPages();
+
+    void ClearMarks();
+
+    // a page outside of the size class lists,the gc never sweeps it and its slots always read as marked,
+    // so objects placed into it are not managed by the gc
+    static PoolPage *AllocateUnmanagedPage(uint32_t slotSize);
+    static void FreeUnmanagedPage(PoolPage *page);
+
+    static PoolPage *GetPage(const void *ptr)
+    {
+        return reinterpret_cast<PoolPage *>(reinterpret_cast<uintptr_t>(ptr) & ~(uintptr_t)(POOL_PAGE_SIZE - 1));
+    }
+
+    static uint32_t GetSlotBit(const void *ptr)
+    {
+        return (uint32_t)((reinterpret_cast<uintptr_t>(ptr) & (POOL_PAGE_SIZE - 1)) / POOL_SIZE_CLASS_GRANULARITY);
+    }
+
+    static bool IsMarked(const void *ptr)
+    {
+        auto bit = GetSlotBit(ptr);
+        return (GetPage(ptr)->markBits[bit / 64] >> (bit % 64)) & 1;
+    }
+
+    // returns false if the slot was marked already
+    static bool Mark(const void *ptr)
+    {
+        auto bit = GetSlotBit(ptr);
+        uint64_t &word = GetPage(ptr)->markBits[bit / 64];
+        uint64_t mask = (uint64_t)1 << (bit % 64);
+        if (word & mask)
+            return false;
+        word |= mask;
+        return true;
+    }
+
+    // threads race for the mark bit,only one of them gets true
+    static bool AtomicMark(const void *ptr)
+    {
+        auto bit = GetSlotBit(ptr);
+        std::atomic_ref<uint64_t> word(GetPage(ptr)->markBits[bit / 64]);
+        uint64_t mask = (uint64_t)1 << (bit % 64);
+        if (word.load(std::memory_order_relaxed) & mask)
+            return false;
+        return (word.fetch_or(mask, std::memory_order_relaxed) & mask) == 0;
+    }
+
+    static void Unmark(const void *ptr)
+    {
+        auto bit = GetSlotBit(ptr);
+        GetPage(ptr)->markBits[bit / 64] &= ~((uint64_t)1 << (bit % 64));
+    }
+
+    static bool IsOld(const void *ptr)
+    {
+        auto bit = GetSlotBit(ptr);
+        return (GetPage(ptr)->oldBits[bit / 64] >> (bit % 64)) & 1;
+    }
+
+    // calls fn with the slot of every set bit in word,word is a copy so fn may free the slot
+    template <typename Fn>
+    static void ForEachSlot(PoolPage *page, size_t wordIndex, uint64_t word, Fn &&fn)
+    {
+        while (word)
+        {
+            size_t bit = wordIndex * 64 + std::countr_zero(word);
+            word &= word - 1;
+            fn(reinterpret_cast<uint8_t *>(page) + bit * POOL_SIZE_CLASS_GRANULARITY);
+        }
+    }
+
+private:
+    ObjectPool() = default;
+    ~ObjectPool();
+
+    PoolPage *AllocatePage(uint32_t sizeClass);
+    void FreePage(PoolPage *page);
+
+    PoolPage *m_Pages[POOL_SIZE_CLASS_COUNT]{};
+    PoolPage *m_AvailablePages[POOL_SIZE_CLASS_COUNT]{};
+    PoolPage *m_YoungPages{nullptr};
+    size_t m_PageCount{0};
+};
@@ -1,4 +1,6 @@
 #include "Parser.h"
+#include <charconv>
+#include "Value.h"
 
 std::unordered_map<TokenType, UnaryFn> Parser::m_UnaryFunctions =
 	{
@@ -221,7 +223,16 @@ Expr *Parser::ParseIdentifierExpr()
 
 Expr *Parser::ParseNumExpr()
 {
-	return new NumExpr(std::stod(Consume(TokenType::NUMBER, "Expect a number literal.").literal));
+	auto literal = Consume(TokenType::NUMBER, "Expect a number literal.").literal;
+	if (literal.find('.') == std::string::npos)
+	{
+		int64_t integer = 0;
+		auto result = std::from_chars(literal.data(), literal.data() + literal.size(), integer);
+		// a larger integer is a double at runtime too
+		if (result.ec == std::errc() && Value::IsInIntRange(integer))
+			return new NumExpr(integer);
+	}
+	return new NumExpr(std::stod(literal));
 }
 
 Expr *Parser::ParseStrExpr()
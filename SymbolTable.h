@@ -1,9 +1,12 @@
 #pragma once
 #include <string>
+#include <algorithm>
 #include <unordered_map>
 #include "Utils.h"
 #include "Value.h"
 
+struct StructObject;
+
 enum class SymbolScope
 {
     GLOBAL,
@@ -16,6 +19,8 @@ struct Symbol
 {
     std::string_view name;
     bool isStructSymbol{false};
+    // set if every member default is a literal,loading the symbol instantiates the prototype then
+    StructObject *structPrototype{nullptr};
     SymbolScope scope{SymbolScope::GLOBAL};
     uint8_t index{0};
     uint8_t scopeDepth{0};
@@ -39,7 +44,7 @@ public:
         m_Upper = nullptr;
     }
 
-    Symbol Define(std::string_view name, bool isStructSymbol = false)
+    Symbol Define(std::string_view name, bool isStructSymbol = false, StructObject *structPrototype = nullptr)
     {
         if (m_VarCount == UINT8_COUNT)
             ASSERT("Too many variable definitions, max is %d", UINT8_COUNT);
@@ -58,12 +63,19 @@ public:
         else
         {
             symbol.scope = SymbolScope::LOCAL;
-            symbol.index = m_LocalVarCount++;
+            // a local of register-based bytecode takes the register its value was compiled to,the first free one
+            symbol.index = std::max(m_LocalVarCount, m_RegisterTop);
+            if (symbol.index == UINT8_MAX)
+                ASSERT("Too many registers in one function, max is %d", UINT8_MAX);
+            m_LocalVarCount = symbol.index + 1;
+            m_RegisterTop = m_LocalVarCount;
+            m_RegisterCount = std::max(m_RegisterCount, m_RegisterTop);
         }
 
         symbol.name = name;
         symbol.scopeDepth = m_ScopeDepth;
         symbol.isStructSymbol = isStructSymbol;
+        symbol.structPrototype = structPrototype;
 
         m_VarList[m_VarCount++] = symbol;
         return symbol;
@@ -99,7 +111,8 @@ public:
         {
             if (!GetUpper()->Resolve(name, symbol))
                 return false;
-            if (symbol.scope == SymbolScope::GLOBAL || symbol.scope == SymbolScope::BUILTIN)
+            // a struct prototype is a constant,it needs no upvalue
+            if (symbol.scope == SymbolScope::GLOBAL || symbol.scope == SymbolScope::BUILTIN || symbol.structPrototype)
                 return true;
 
             if (m_UpvalueCount == UPVALUE_COUNT)
@@ -119,6 +132,33 @@ public:
         return m_LocalVarCount;
     }
 
+    // registers of register-based bytecode:the locals come first,temporaries are allocated above them
+    // and released once the expression that needed them is compiled
+    uint8_t AcquireRegister()
+    {
+        if (m_RegisterTop == UINT8_MAX)
+            ASSERT("Too many registers in one function, max is %d", UINT8_MAX);
+
+        auto reg = m_RegisterTop++;
+        m_RegisterCount = std::max(m_RegisterCount, m_RegisterTop);
+        return reg;
+    }
+
+    uint8_t GetRegisterTop() const
+    {
+        return m_RegisterTop;
+    }
+
+    void ReleaseRegisters(uint8_t top)
+    {
+        m_RegisterTop = std::max(top, m_LocalVarCount);
+    }
+
+    uint8_t GetRegisterCount() const
+    {
+        return m_RegisterCount;
+    }
+
     uint8_t GetUpvalueCount() const
     {
         return m_UpvalueCount;
@@ -171,6 +211,8 @@ private:
     uint8_t m_VarCount{0};
     uint8_t m_LocalVarCount{0};
     uint8_t m_GlobalVarCount{0};
+    uint8_t m_RegisterTop{0};
+    uint8_t m_RegisterCount{0};
     std::array<Symbol, UPVALUE_COUNT> m_UpvalueList;
     uint8_t m_UpvalueCount{0};
     uint8_t m_ScopeDepth{0};
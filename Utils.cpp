@@ -69,25 +69,26 @@ void RegisterDLLs(std::string rawDllPath)
         RegisterBuiltins();
     }
 #elif __linux__
-    void *handle;
-    double (*cosine)(double);
-    char *error;
-
-    handle = dlopen(rawDllPath.c_str(), RTLD_LAZY);
+    // the compiler and the vm both run a dllimport,like GetModuleHandleA a loaded library registered its builtins already
+    void *handle = dlopen(rawDllPath.c_str(), RTLD_LAZY | RTLD_NOLOAD);
     if (!handle)
-        ASSERT("Failed to load dll library:%s", rawDllPath.c_str());
+    {
+        handle = dlopen(rawDllPath.c_str(), RTLD_LAZY);
+        if (!handle)
+            ASSERT("Failed to load dll library:%s", rawDllPath.c_str());
 
-    RegFn RegisterBuiltins = (RegFn)(dlsym(handle, "RegisterBuiltins"));
-    RegisterBuiltins();
+        RegFn RegisterBuiltins = (RegFn)(dlsym(handle, "RegisterBuiltins"));
+        RegisterBuiltins();
+    }
 #elif __APPLE__
 #error "Apple platform not implement yet"
 #endif
 }
 
-uint32_t HashString(char *str)
+uint32_t HashString(const char *str, size_t len)
 {
     uint32_t hash = 2166136261u;
-    for (size_t i = 0; i < strlen(str); i++)
+    for (size_t i = 0; i < len; i++)
     {
         hash ^= (uint8_t)str[i];
         hash *= 16777619;
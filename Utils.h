@@ -22,12 +22,14 @@
 
 #define BUILTIN_FN(x) cd_builtin_fn_##x
 
-#define REGISTER_BUILTIN_VALUE(x) BuiltinManager::GetInstance()->Register(ALLOCATE_OBJECT(StrObject, #x), Value((uint64_t)x))
-#define REGISTER_BUILTIN_FN(x) BuiltinManager::GetInstance()->Register<BuiltinFn>(ALLOCATE_OBJECT(StrObject, #x), cd_builtin_fn_##x)
+#define REGISTER_BUILTIN_VALUE(x) BuiltinManager::GetInstance()->Register(ALLOCATE_NAME_STR_OBJECT(#x), Value((uint64_t)x))
+#define REGISTER_BUILTIN_FN(x) BuiltinManager::GetInstance()->Register(ALLOCATE_NAME_STR_OBJECT(#x), (BuiltinFn)cd_builtin_fn_##x)
+#define REGISTER_BUILTIN_FN_WITH_ARITY(x, arity) BuiltinManager::GetInstance()->Register(ALLOCATE_NAME_STR_OBJECT(#x), (BuiltinFn)cd_builtin_fn_##x, (int16_t)(arity))
 
 constexpr uint32_t UINT8_COUNT = UINT8_MAX + 1; // 256
 constexpr uint32_t STACK_COUNT = UINT8_COUNT * 2; // 512
 constexpr uint32_t UPVALUE_COUNT = UINT8_COUNT / 8; // 16
+constexpr uint32_t SHAPE_MAX_FIELD_COUNT = UINT8_COUNT / 8; // struct instances with more members fall back to a HashTable
 
 #define SAFE_DELETE(x)   \
     do                   \
@@ -65,4 +67,4 @@ COMPUTEDUCK_API std::string PointerAddressToString(void *pointer);
 
 COMPUTEDUCK_API void RegisterDLLs(std::string rawDllPath);
 
-COMPUTEDUCK_API uint32_t HashString(char *str);
+COMPUTEDUCK_API uint32_t HashString(const char *str, size_t len);
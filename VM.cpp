@@ -14,6 +14,13 @@ VM::~VM()
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
     SAFE_DELETE(m_Jit);
 #endif
+
+    if (Config::GetInstance()->IsDumpInlineCacheStats())
+    {
+        auto total = m_InlineCacheHitCount + m_InlineCacheMissCount;
+        std::cout << "Inline cache hits:" << m_InlineCacheHitCount << ",misses:" << m_InlineCacheMissCount
+                  << ",hit rate:" << (total == 0 ? 0.0 : 100.0 * m_InlineCacheHitCount / total) << "%." << std::endl;
+    }
 }
 
 void VM::Run(FunctionObject *fn)
@@ -28,29 +35,411 @@ void VM::Run(FunctionObject *fn)
 
     Allocator::GetInstance()->ResetStatus();
 
-    auto closure = ALLOCATE_OBJECT(ClosureObject, fn);
+    auto closure = ALLOCATE_CLOSURE_OBJECT(fn, nullptr, 0);
     auto mainCallFrame = CallFrame(closure, GET_STACK_TOP());
     PUSH_CALL_FRAME(mainCallFrame);
     SET_STACK_TOP(mainCallFrame.slot + closure->function->localVarCount);
 
-    Execute();
+    if (IsRegisterOpCode(fn->chunk.opCodeList[0]))
+    {
+        for (auto slot = mainCallFrame.slot; slot < GET_STACK_TOP(); ++slot)
+            *slot = Value();
+        ExecuteRegister();
+    }
+    else
+        Execute();
 }
 
-void VM::Execute()
+Value *VM::GetStructMember(StructObject *instance, StrObject *name, StructInlineCache &cache)
 {
-    while (1)
+    if (instance->shape != nullptr && instance->shape == cache.shape)
     {
-        auto frame = PEEK_CALL_FRAME(1);
+        m_InlineCacheHitCount++;
+        return instance->fields + cache.slot;
+    }
 
-        if (frame->IsEnd())
-            return;
+    m_InlineCacheMissCount++;
+    if (instance->shape == nullptr)
+        return instance->members->Get(name);
 
-        int32_t instruction = *frame->ip++;
-        switch (instruction)
-        {
-        case OP_RETURN:
+    auto slot = instance->shape->FindSlot(name);
+    if (slot == -1)
+        return nullptr;
+
+    cache.shape = instance->shape;
+    cache.slot = slot;
+    return instance->fields + slot;
+}
+
+#if defined(COMPUTEDUCK_BUILD_WITH_COMPUTED_GOTO) && (defined(__GNUC__) || defined(__clang__))
+#define VM_USE_COMPUTED_GOTO
+#endif
+
+// the hot state of the interpreter loop(ip,current frame,constants,stack top) lives in locals,
+// it is written back to the call frame/allocator before anything that may read it(call,return,gc,builtin)
+#define READ_OPCODE() (*ip++)
+#define READ_U8() (*ip++)
+#define READ_U16() ReadOperand<uint16_t>(ip)
+#define READ_I32() ReadOperand<int32_t>(ip)
+
+#define VM_PUSH(x) (*stackTop++ = (x))
+#define VM_POP() (*(--stackTop))
+
+#define SAVE_STACK_TOP() SET_STACK_TOP(stackTop)
+#define LOAD_STACK_TOP() (stackTop = GET_STACK_TOP())
+
+#define SAVE_FRAME() (frame->ip = ip)
+#define LOAD_FRAME()                                               \
+    do                                                             \
+    {                                                              \
+        frame = PEEK_CALL_FRAME(1);                                \
+        ip = frame->ip;                                            \
+        constants = frame->closure->function->chunk.constants.data(); \
+    } while (false)
+
+// the dispatch table of a loop starts at the opcode dispatchBase
+#ifdef VM_USE_COMPUTED_GOTO
+#define VM_DISPATCH() goto *dispatchTable[READ_OPCODE() - dispatchBase];
+#define VM_CASE(op) LABEL_##op:
+#define VM_NEXT() VM_DISPATCH()
+#else
+#define VM_DISPATCH() \
+    while (1)         \
+        switch (READ_OPCODE())
+#define VM_CASE(op) case op:
+#define VM_NEXT() continue
+#endif
+
+#define BINARY(op)                 \
+    do                             \
+    {                              \
+        auto l = VM_POP();         \
+        auto r = VM_POP();         \
+        VM_PUSH(op(l, r));         \
+    } while (false)
+
+// an opcode that saw two numbers is rewritten in place to its number-only variant,
+// which checks the tags inline and falls back to the generic opcode on a mismatch
+#define QUICKEN(opcodeAddr, quickOp) (*(opcodeAddr) = (quickOp))
+#define DEOPTIMIZE(opcodeAddr, genericOp) \
+    do                                    \
+    {                                     \
+        *(opcodeAddr) = (genericOp);      \
+        ip = (opcodeAddr);                \
+    } while (false)
+
+#define QUICKEN_BINARY(op, quickOp)                    \
+    do                                                 \
+    {                                                  \
+        auto l = VM_POP();                             \
+        auto r = VM_POP();                             \
+        if (IS_NUM_VALUE(l) && IS_NUM_VALUE(r))        \
+            QUICKEN(ip - 1, quickOp);                  \
+        VM_PUSH(op(l, r));                             \
+    } while (false)
+
+#define QUICKEN_ARITHMETIC(op, quickOp)                \
+    do                                                 \
+    {                                                  \
+        auto l = VM_POP();                             \
+        auto r = VM_POP();                             \
+        if (IS_NUM_VALUE(l) && IS_NUM_VALUE(r))        \
+            QUICKEN(ip - 1, quickOp);                  \
+        Value ret;                                     \
+        SAVE_STACK_TOP();                              \
+        op(l, r, ret);                                 \
+        VM_PUSH(ret);                                  \
+    } while (false)
+
+// the number-only variants keep two integers in integer registers,
+// a mix of integer and double is computed in double
+#define ARITHMETIC_NUM(intOp, op, genericOp)                       \
+    do                                                             \
+    {                                                              \
+        auto &l = stackTop[-1];                                    \
+        auto &r = stackTop[-2];                                    \
+        if (IS_INT_VALUE(l) && IS_INT_VALUE(r))                    \
+        {                                                          \
+            Value ret = intOp(TO_INT_VALUE(l), TO_INT_VALUE(r));   \
+            stackTop--;                                            \
+            stackTop[-1] = ret;                                    \
+        }                                                          \
+        else if (IS_NUM_VALUE(l) && IS_NUM_VALUE(r))               \
+        {                                                          \
+            Value ret = TO_NUM_VALUE(l) op TO_NUM_VALUE(r);        \
+            stackTop--;                                            \
+            stackTop[-1] = ret;                                    \
+        }                                                          \
+        else                                                       \
+            DEOPTIMIZE(ip - 1, genericOp);                         \
+    } while (false)
+
+#define COMPARE_NUM(op, genericOp)                                 \
+    do                                                             \
+    {                                                              \
+        auto &l = stackTop[-1];                                    \
+        auto &r = stackTop[-2];                                    \
+        if (IS_INT_VALUE(l) && IS_INT_VALUE(r))                    \
+        {                                                          \
+            Value ret = TO_INT_VALUE(l) op TO_INT_VALUE(r);        \
+            stackTop--;                                            \
+            stackTop[-1] = ret;                                    \
+        }                                                          \
+        else if (IS_NUM_VALUE(l) && IS_NUM_VALUE(r))               \
+        {                                                          \
+            Value ret = TO_NUM_VALUE(l) op TO_NUM_VALUE(r);        \
+            stackTop--;                                            \
+            stackTop[-1] = ret;                                    \
+        }                                                          \
+        else                                                       \
+            DEOPTIMIZE(ip - 1, genericOp);                         \
+    } while (false)
+
+// two integers are combined inline,anything else goes through the value function
+#define BIT_BINARY(op, fn)                                       \
+    do                                                           \
+    {                                                            \
+        auto &l = stackTop[-1];                                  \
+        auto &r = stackTop[-2];                                  \
+        if (IS_INT_VALUE(l) && IS_INT_VALUE(r))                  \
+        {                                                        \
+            Value ret = TO_INT_VALUE(l) op TO_INT_VALUE(r);      \
+            stackTop--;                                          \
+            stackTop[-1] = ret;                                  \
+        }                                                        \
+        else                                                     \
+            BINARY(fn);                                          \
+    } while (false)
+
+#define BINARY_NUM(op, genericOp)                                  \
+    do                                                             \
+    {                                                              \
+        auto &l = stackTop[-1];                                    \
+        auto &r = stackTop[-2];                                    \
+        if (IS_NUM_VALUE(l) && IS_NUM_VALUE(r))                    \
+        {                                                          \
+            Value ret = TO_NUM_VALUE(l) op TO_NUM_VALUE(r);        \
+            stackTop--;                                            \
+            stackTop[-1] = ret;                                    \
+        }                                                          \
+        else                                                       \
+            DEOPTIMIZE(ip - 1, genericOp);                         \
+    } while (false)
+
+// jump offsets are relative to the jump opcode
+#ifdef COMPUTEDUCK_BUILD_WITH_LLVM
+#define READ_JUMP_OPERANDS()      \
+    auto offset = READ_I32();     \
+    auto mode = READ_U8()
+#else
+#define READ_JUMP_OPERANDS() \
+    auto offset = READ_I32()
+#endif
+
+#define COMPARE_JUMP(cond, quickOp)                                           \
+    do                                                                        \
+    {                                                                         \
+        auto opcodeAddr = ip - 1;                                             \
+        READ_JUMP_OPERANDS();                                                 \
+        auto l = VM_POP();                                                    \
+        auto r = VM_POP();                                                    \
+        if (IS_NUM_VALUE(l) && IS_NUM_VALUE(r))                               \
+            QUICKEN(opcodeAddr, quickOp);                                     \
+        if (cond)                                                             \
+            ip = opcodeAddr + offset;                                         \
+    } while (false)
+
+#define COMPARE_JUMP_NUM(cond, genericOp)                                         \
+    do                                                                            \
+    {                                                                             \
+        auto opcodeAddr = ip - 1;                                                 \
+        READ_JUMP_OPERANDS();                                                     \
+        if (IS_INT_VALUE(stackTop[-1]) && IS_INT_VALUE(stackTop[-2]))             \
+        {                                                                         \
+            auto l = TO_INT_VALUE(stackTop[-1]);                                  \
+            auto r = TO_INT_VALUE(stackTop[-2]);                                  \
+            stackTop -= 2;                                                        \
+            if (cond)                                                             \
+                ip = opcodeAddr + offset;                                         \
+        }                                                                         \
+        else if (IS_NUM_VALUE(stackTop[-1]) && IS_NUM_VALUE(stackTop[-2]))        \
+        {                                                                         \
+            auto l = TO_NUM_VALUE(stackTop[-1]);                                  \
+            auto r = TO_NUM_VALUE(stackTop[-2]);                                  \
+            stackTop -= 2;                                                        \
+            if (cond)                                                             \
+                ip = opcodeAddr + offset;                                         \
+        }                                                                         \
+        else                                                                      \
+            DEOPTIMIZE(opcodeAddr, genericOp);                                    \
+    } while (false)
+
+#ifdef COMPUTEDUCK_BUILD_WITH_LLVM
+#define RUN_JIT(callFrame)    \
+    do                        \
+    {                         \
+        SAVE_STACK_TOP();     \
+        RunJit(callFrame);    \
+        LOAD_STACK_TOP();     \
+    } while (false)
+#else
+#define RUN_JIT(callFrame) \
+    do                     \
+    {                      \
+    } while (false)
+#endif
+
+#define CALL_VALUE(argCount)                                                                                                                                          \
+    do                                                                                                                                                                \
+    {                                                                                                                                                                 \
+        auto value = *(stackTop - (argCount) - 1);                                                                                                                    \
+        if (IS_CLOSURE_VALUE(value))                                                                                                                                  \
+        {                                                                                                                                                             \
+            auto closure = TO_CLOSURE_VALUE(value);                                                                                                                   \
+                                                                                                                                                                      \
+            if ((argCount) != closure->function->parameterCount)                                                                                                      \
+                ASSERT("Non matching function parameters for calling arguments,parameter count:%d,argument count:%d", closure->function->parameterCount, (argCount)); \
+                                                                                                                                                                      \
+            SAVE_FRAME();                                                                                                                                             \
+                                                                                                                                                                      \
+            auto callFrame = CallFrame(closure, stackTop - (argCount));                                                                                               \
+            PUSH_CALL_FRAME(callFrame);                                                                                                                               \
+            stackTop = callFrame.slot + closure->function->localVarCount;                                                                                             \
+                                                                                                                                                                      \
+            RUN_JIT(callFrame);                                                                                                                                       \
+            LOAD_FRAME();                                                                                                                                             \
+        }                                                                                                                                                             \
+        else if (IS_BUILTIN_VALUE(value))                                                                                                                             \
+        {                                                                                                                                                             \
+            auto builtin = TO_BUILTIN_VALUE(value);                                                                                                                   \
+                                                                                                                                                                      \
+            if (!builtin->fn)                                                                                                                                         \
+                ASSERT("Invalid builtin function");                                                                                                                   \
+            if (builtin->arity != BUILTIN_FN_VARIADIC && builtin->arity != (argCount))                                                                                \
+                ASSERT("Non matching builtin function arguments,expect %d,got %d", builtin->arity, (argCount));                                                       \
+                                                                                                                                                                      \
+            Value *slot = stackTop - (argCount);                                                                                                                      \
+                                                                                                                                                                      \
+            SAVE_STACK_TOP();                                                                                                                                         \
+                                                                                                                                                                      \
+            Value returnValue;                                                                                                                                        \
+            auto hasRet = builtin->fn(slot, (argCount), returnValue);                                                                                                 \
+                                                                                                                                                                      \
+            stackTop = slot - 1;                                                                                                                                      \
+                                                                                                                                                                      \
+            if (hasRet)                                                                                                                                               \
+                VM_PUSH(returnValue);                                                                                                                                 \
+        }                                                                                                                                                             \
+        else                                                                                                                                                          \
+            ASSERT("Calling not a function or a builtinFn");                                                                                                          \
+    } while (false)
+
+void VM::Execute()
+{
+#ifdef VM_USE_COMPUTED_GOTO
+    // must keep the same order as enum OpCode
+    static void *dispatchTable[] = {
+        &&LABEL_OP_CONSTANT,
+        &&LABEL_OP_ADD,
+        &&LABEL_OP_SUB,
+        &&LABEL_OP_MUL,
+        &&LABEL_OP_DIV,
+        &&LABEL_OP_EQUAL,
+        &&LABEL_OP_GREATER,
+        &&LABEL_OP_LESS,
+        &&LABEL_OP_NOT,
+        &&LABEL_OP_MINUS,
+        &&LABEL_OP_AND,
+        &&LABEL_OP_OR,
+        &&LABEL_OP_BIT_AND,
+        &&LABEL_OP_BIT_OR,
+        &&LABEL_OP_BIT_NOT,
+        &&LABEL_OP_BIT_XOR,
+        &&LABEL_OP_JUMP_IF_FALSE,
+        &&LABEL_OP_JUMP,
+        &&LABEL_OP_DEF_GLOBAL,
+        &&LABEL_OP_SET_GLOBAL,
+        &&LABEL_OP_GET_GLOBAL,
+        &&LABEL_OP_DEF_LOCAL,
+        &&LABEL_OP_SET_LOCAL,
+        &&LABEL_OP_GET_LOCAL,
+        &&LABEL_OP_GET_UPVALUE,
+        &&LABEL_OP_SET_UPVALUE,
+        &&LABEL_OP_ARRAY,
+        &&LABEL_OP_GET_INDEX,
+        &&LABEL_OP_SET_INDEX,
+        &&LABEL_OP_CLOSURE,
+        &&LABEL_OP_FUNCTION_CALL,
+        &&LABEL_OP_TAIL_CALL,
+        &&LABEL_OP_RETURN,
+        &&LABEL_OP_GET_BUILTIN,
+        &&LABEL_OP_STRUCT,
+        &&LABEL_OP_NEW_STRUCT,
+        &&LABEL_OP_GET_STRUCT,
+        &&LABEL_OP_SET_STRUCT,
+        &&LABEL_OP_REF_GLOBAL,
+        &&LABEL_OP_REF_LOCAL,
+        &&LABEL_OP_REF_UPVALUE,
+        &&LABEL_OP_REF_INDEX_GLOBAL,
+        &&LABEL_OP_REF_INDEX_LOCAL,
+        &&LABEL_OP_REF_INDEX_UPVALUE,
+        &&LABEL_OP_STACK_REF_GLOBAL,
+        &&LABEL_OP_STACK_REF_LOCAL,
+        &&LABEL_OP_STACK_REF_UPVALUE,
+        &&LABEL_OP_STACK_REF_INDEX_GLOBAL,
+        &&LABEL_OP_STACK_REF_INDEX_LOCAL,
+        &&LABEL_OP_STACK_REF_INDEX_UPVALUE,
+        &&LABEL_OP_STACK_REF_CALL,
+        &&LABEL_OP_RELEASE_STACK_REFS,
+        &&LABEL_OP_CONCAT,
+        &&LABEL_OP_DLL_IMPORT,
+        &&LABEL_OP_INC_LOCAL,
+        &&LABEL_OP_INC_GLOBAL,
+        &&LABEL_OP_JUMP_IF_LESS,
+        &&LABEL_OP_JUMP_IF_GREATER,
+        &&LABEL_OP_JUMP_IF_EQUAL,
+        &&LABEL_OP_JUMP_IF_NOT_LESS,
+        &&LABEL_OP_JUMP_IF_NOT_GREATER,
+        &&LABEL_OP_JUMP_IF_NOT_EQUAL,
+        &&LABEL_OP_ADD_NUM,
+        &&LABEL_OP_SUB_NUM,
+        &&LABEL_OP_MUL_NUM,
+        &&LABEL_OP_DIV_NUM,
+        &&LABEL_OP_GREATER_NUM,
+        &&LABEL_OP_LESS_NUM,
+        &&LABEL_OP_EQUAL_NUM,
+        &&LABEL_OP_INC_LOCAL_NUM,
+        &&LABEL_OP_INC_GLOBAL_NUM,
+        &&LABEL_OP_JUMP_IF_LESS_NUM,
+        &&LABEL_OP_JUMP_IF_GREATER_NUM,
+        &&LABEL_OP_JUMP_IF_EQUAL_NUM,
+        &&LABEL_OP_JUMP_IF_NOT_LESS_NUM,
+        &&LABEL_OP_JUMP_IF_NOT_GREATER_NUM,
+        &&LABEL_OP_JUMP_IF_NOT_EQUAL_NUM,
+        &&LABEL_OP_GET_BUILTIN_INDEX,
+#ifdef COMPUTEDUCK_BUILD_WITH_LLVM
+        &&LABEL_OP_JUMP_START,
+        &&LABEL_OP_JUMP_END,
+#endif
+    };
+    static_assert(sizeof(dispatchTable) / sizeof(dispatchTable[0]) == OP_R_MOVE, "dispatch table mismatch with enum OpCode");
+    constexpr uint8_t dispatchBase = 0;
+#endif
+
+    CallFrame *frame;
+    uint8_t *ip;
+    Value *constants;
+    Value *stackTop;
+    Value *globals = GET_GLOBAL_VARIABLE_SLOT(0);
+
+    LOAD_FRAME();
+    LOAD_STACK_TOP();
+
+    VM_DISPATCH()
+    {
+        VM_CASE(OP_RETURN)
         {
-            auto returnCount = *frame->ip++;
+            auto returnCount = READ_U8();
 
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
             if (frame->closure->returnTypeSet == nullptr)
@@ -60,7 +449,7 @@ void VM::Execute()
             Value value;
             if (returnCount == 1)
             {
-                value = POP();
+                value = VM_POP();
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
                 if (IS_OBJECT_VALUE(value))
                 {
@@ -70,7 +459,7 @@ void VM::Execute()
                         frame->closure->returnTypeSet->Insert(TO_OBJECT_VALUE(value)->type);
                 }
                 else
-                    frame->closure->returnTypeSet->Insert(value.type);
+                    frame->closure->returnTypeSet->Insert(IS_NUM_VALUE(value) ? ValueType::NUM : GET_VALUE_TYPE(value)); // the jit returns numbers as double
 #endif
             }
 
@@ -79,225 +468,213 @@ void VM::Execute()
             auto callFrame = POP_CALL_FRAME();
 
             if (Allocator::GetInstance()->IsCallFrameStackEmpty())
+            {
+                SAVE_STACK_TOP();
                 return;
+            }
 
-            SET_STACK_TOP(callFrame->slot - 1);
+            stackTop = callFrame->slot - 1;
 
             if (returnCount == 1)
-                PUSH(value);
-            break;
+                VM_PUSH(value);
+
+            LOAD_FRAME();
+            VM_NEXT();
         }
-        case OP_CONSTANT:
+        VM_CASE(OP_CONSTANT)
         {
-            auto idx = *frame->ip++;
-            auto value = frame->closure->function->chunk.constants[idx];
-            PUSH(value);
-            break;
+            auto idx = READ_U16();
+            VM_PUSH(constants[idx]);
+            VM_NEXT();
         }
-        case OP_ADD:
+        VM_CASE(OP_ADD)
         {
-            auto l = POP();
-            auto r = POP();
-            Value ret;
-            ValueAdd(l, r, ret);
-            PUSH(ret);
-            break;
+            QUICKEN_ARITHMETIC(ValueAdd, OP_ADD_NUM);
+            VM_NEXT();
         }
-        case OP_SUB:
+        VM_CASE(OP_SUB)
         {
-            auto l = POP();
-            auto r = POP();
-            PUSH(ValueSub(l, r));
-            break;
+            QUICKEN_ARITHMETIC(ValueSub, OP_SUB_NUM);
+            VM_NEXT();
         }
-        case OP_MUL:
+        VM_CASE(OP_MUL)
         {
-            auto l = POP();
-            auto r = POP();
-            PUSH(ValueMul(l, r));
-            break;
+            QUICKEN_ARITHMETIC(ValueMul, OP_MUL_NUM);
+            VM_NEXT();
         }
-        case OP_DIV:
+        VM_CASE(OP_DIV)
         {
-            auto l = POP();
-            auto r = POP();
-            PUSH(ValueDiv(l, r));
-            break;
+            QUICKEN_BINARY(ValueDiv, OP_DIV_NUM);
+            VM_NEXT();
         }
-        case OP_GREATER:
+        VM_CASE(OP_GREATER)
         {
-            auto l = POP();
-            auto r = POP();
-            PUSH(ValueGreater(l, r));
-            break;
+            QUICKEN_BINARY(ValueGreater, OP_GREATER_NUM);
+            VM_NEXT();
         }
-        case OP_LESS:
+        VM_CASE(OP_LESS)
         {
-            auto l = POP();
-            auto r = POP();
-            PUSH(ValueLess(l, r));
-            break;
+            QUICKEN_BINARY(ValueLess, OP_LESS_NUM);
+            VM_NEXT();
         }
-        case OP_EQUAL:
+        VM_CASE(OP_EQUAL)
         {
-            auto l = POP();
-            auto r = POP();
-            PUSH(ValueEqual(l, r));
-            break;
+            QUICKEN_BINARY(ValueEqual, OP_EQUAL_NUM);
+            VM_NEXT();
         }
-        case OP_NOT:
+        VM_CASE(OP_NOT)
         {
-            PUSH(ValueLogicNot(POP()));
-            break;
+            auto value = VM_POP();
+            VM_PUSH(ValueLogicNot(value));
+            VM_NEXT();
         }
-        case OP_MINUS:
+        VM_CASE(OP_MINUS)
         {
-            PUSH(ValueMinus(POP()));
-            break;
+            auto value = VM_POP();
+            Value ret;
+            ValueMinus(value, ret);
+            VM_PUSH(ret);
+            VM_NEXT();
         }
-        case OP_AND:
+        VM_CASE(OP_AND)
         {
-            auto l = POP();
-            auto r = POP();
-            PUSH(ValueLogicAnd(l, r));
-            break;
+            BINARY(ValueLogicAnd);
+            VM_NEXT();
         }
-        case OP_OR:
+        VM_CASE(OP_OR)
         {
-            auto l = POP();
-            auto r = POP();
-            PUSH(ValueLogicOr(l, r));
-            break;
+            BINARY(ValueLogicOr);
+            VM_NEXT();
         }
-        case OP_BIT_AND:
+        VM_CASE(OP_BIT_AND)
         {
-            auto l = POP();
-            auto r = POP();
-            PUSH(ValueBitAnd(l, r));
-            break;
+            BIT_BINARY(&, ValueBitAnd);
+            VM_NEXT();
         }
-        case OP_BIT_OR:
+        VM_CASE(OP_BIT_OR)
         {
-            auto l = POP();
-            auto r = POP();
-            PUSH(ValueBitOr(l, r));
-            break;
+            BIT_BINARY(|, ValueBitOr);
+            VM_NEXT();
         }
-        case OP_BIT_XOR:
+        VM_CASE(OP_BIT_XOR)
         {
-            auto l = POP();
-            auto r = POP();
-            PUSH(ValueBitXor(l, r));
-            break;
+            BIT_BINARY(^, ValueBitXor);
+            VM_NEXT();
         }
-        case OP_BIT_NOT:
+        VM_CASE(OP_BIT_NOT)
         {
-            PUSH(ValueBitNot(POP()));
-            break;
+            auto value = VM_POP();
+            if (IS_INT_VALUE(value))
+                VM_PUSH(~TO_INT_VALUE(value));
+            else
+                VM_PUSH(ValueBitNot(value));
+            VM_NEXT();
         }
-        case OP_ARRAY:
+        VM_CASE(OP_ARRAY)
         {
-            auto numElements = *frame->ip++;
+            auto numElements = READ_U16();
             Value *elements = new Value[numElements];
 
             int32_t i = numElements - 1;
-            for (Value *p = GET_STACK_TOP() - 1; p >= GET_STACK_TOP() - numElements && i >= 0; --p, --i)
+            for (Value *p = stackTop - 1; p >= stackTop - numElements && i >= 0; --p, --i)
                 elements[i] = *p;
 
+            SAVE_STACK_TOP();
             auto array = ALLOCATE_OBJECT(ArrayObject, elements, numElements);
 
-            STACK_TOP_JUMP(-numElements);
+            stackTop -= numElements;
 
-            PUSH(array);
-            break;
+            VM_PUSH(array);
+            VM_NEXT();
         }
-        case OP_GET_INDEX:
+        VM_CASE(OP_GET_INDEX)
         {
-            auto index = POP();
-            auto ds = POP();
+            auto index = VM_POP();
+            auto ds = VM_POP();
             Value ret;
             GetArrayObjectElement(ds, index, ret);
-            PUSH(ret);
-            break;
+            VM_PUSH(ret);
+            VM_NEXT();
         }
-        case OP_SET_INDEX:
+        VM_CASE(OP_SET_INDEX)
         {
-            auto index = POP();
-            auto ds = POP();
-            auto v = POP();
+            auto index = VM_POP();
+            auto ds = VM_POP();
+            auto v = VM_POP();
             if (IS_ARRAY_VALUE(ds) && IS_NUM_VALUE(index))
             {
                 auto array = TO_ARRAY_VALUE(ds);
-                auto i = (size_t)TO_NUM_VALUE(index);
-                if (i < 0 || i >= array->len)
+                auto i = IS_INT_VALUE(index) ? TO_INT_VALUE(index) : (int64_t)TO_DOUBLE_VALUE(index);
+                if (i < 0 || static_cast<size_t>(i) >= array->len)
                     ASSERT("Invalid index:%ld outside of array's size:%ld", i, array->len)
                 else
                     SetValue(&array->elements[i], v);
             }
             else
                 ASSERT("Invalid index op: %s[%s]", ds.Stringify().c_str(), index.Stringify().c_str());
-            break;
+            VM_NEXT();
         }
-        case OP_JUMP_IF_FALSE:
+        VM_CASE(OP_JUMP_IF_FALSE)
         {
-            auto address = *frame->ip++;
-#ifdef COMPUTEDUCK_BUILD_WITH_LLVM
-            auto mode = *frame->ip++;
-#endif
-            auto value = POP();
+            auto opcodeAddr = ip - 1;
+            READ_JUMP_OPERANDS();
+            auto value = VM_POP();
             if (!IS_BOOL_VALUE(value))
                 ASSERT("The if condition not a boolean value");
             if (!TO_BOOL_VALUE(value))
-                frame->ip = frame->closure->function->chunk.opCodeList.data() + address;
-            break;
+                ip = opcodeAddr + offset;
+            VM_NEXT();
         }
-        case OP_JUMP:
+        VM_CASE(OP_JUMP)
         {
-            auto address = *frame->ip++;
-#ifdef COMPUTEDUCK_BUILD_WITH_LLVM
-            auto mode = *frame->ip++;
-#endif
-            frame->ip = frame->closure->function->chunk.opCodeList.data() + address;
-            break;
+            auto opcodeAddr = ip - 1;
+            READ_JUMP_OPERANDS();
+            ip = opcodeAddr + offset;
+            VM_NEXT();
         }
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
-        case OP_JUMP_START:
+        VM_CASE(OP_JUMP_START)
         {
-            frame->ip++;
-            break;
+            ip++;
+            VM_NEXT();
         }
-        case OP_JUMP_END:
+        VM_CASE(OP_JUMP_END)
         {
-            break;
+            VM_NEXT();
         }
 #endif
-        case OP_DEF_GLOBAL:
+        VM_CASE(OP_DEF_GLOBAL)
         {
-            auto index = *frame->ip++;
-            auto value = POP();
-            auto slot = GET_GLOBAL_VARIABLE_SLOT(index);
-            *slot = value;
-            break;
+            auto index = READ_U8();
+            globals[index] = VM_POP();
+            VM_NEXT();
         }
-        case OP_SET_GLOBAL:
+        VM_CASE(OP_SET_GLOBAL)
         {
-            auto index = *frame->ip++;
-            auto value = POP();
-            auto slot = GET_GLOBAL_VARIABLE_SLOT(index);
-            SetValue(slot, value);
-            break;
+            auto index = READ_U8();
+            auto value = VM_POP();
+            SetValue(globals + index, value);
+            VM_NEXT();
         }
-        case OP_GET_GLOBAL:
+        VM_CASE(OP_GET_GLOBAL)
         {
-            auto index = *frame->ip++;
-            PUSH(*GET_GLOBAL_VARIABLE_SLOT(index));
-            break;
+            auto index = READ_U8();
+            VM_PUSH(globals[index]);
+            VM_NEXT();
         }
-        case OP_FUNCTION_CALL:
+        VM_CASE(OP_FUNCTION_CALL)
         {
-            auto argCount = (uint8_t)*frame->ip++;
+            auto argCount = READ_U8();
+            CALL_VALUE(argCount);
+            VM_NEXT();
+        }
+        VM_CASE(OP_TAIL_CALL)
+        {
+            auto argCount = READ_U8();
 
-            auto value = *(GET_STACK_TOP() - argCount - 1);
+            auto value = *(stackTop - argCount - 1);
+            // the compiler never emits a tail call in a function that refs one of its locals,
+            // so no value reachable from the arguments refers to the frame being reused
             if (IS_CLOSURE_VALUE(value))
             {
                 auto closure = TO_CLOSURE_VALUE(value);
@@ -305,206 +682,1537 @@ void VM::Execute()
                 if (argCount != closure->function->parameterCount)
                     ASSERT("Non matching function parameters for calling arguments,parameter count:%d,argument count:%d", closure->function->parameterCount, argCount);
 
-                auto callFrame = CallFrame(closure, GET_STACK_TOP() - argCount);
-                PUSH_CALL_FRAME(callFrame);
-                SET_STACK_TOP(callFrame.slot + closure->function->localVarCount);
+                Allocator::GetInstance()->ClosedUpvalues(frame->slot);
 
-#ifdef COMPUTEDUCK_BUILD_WITH_LLVM
-                RunJit(callFrame);
-#endif
+                // move the callee and its arguments down to the window of the current frame and reuse it
+                memmove(frame->slot - 1, stackTop - argCount - 1, sizeof(Value) * (argCount + 1));
+                *frame = CallFrame(closure, frame->slot);
+                stackTop = frame->slot + closure->function->localVarCount;
+                LOAD_FRAME();
             }
-            else if (IS_BUILTIN_VALUE(value))
+            else
             {
-                auto builtin = TO_BUILTIN_VALUE(value);
-
-                if (!builtin->Is<BuiltinFn>())
-                    ASSERT("Invalid builtin function");
-
-                Value *slot = GET_STACK_TOP() - argCount;
-
-                Value returnValue;
-                auto hasRet = builtin->Get<BuiltinFn>()(slot, argCount, returnValue);
-
-                STACK_TOP_JUMP(-(argCount + 1));
-
-                if (hasRet)
-                    PUSH(returnValue);
+                // a builtin callee,call as usual and the following OP_RETURN returns the result
+                CALL_VALUE(argCount);
             }
-            else
-                ASSERT("Calling not a function or a builtinFn");
-            break;
+            VM_NEXT();
         }
-        case OP_CLOSURE:
+        VM_CASE(OP_CLOSURE)
         {
-            auto idx = *frame->ip++;
-            auto upvalueCount = *frame->ip++;
-            auto function = TO_FUNCTION_VALUE(frame->closure->function->chunk.constants[idx]);
-            auto closure = ALLOCATE_OBJECT(ClosureObject, function);
-            PUSH(closure);
+            auto idx = READ_U16();
+            auto upvalueCount = READ_U8();
+            auto function = TO_FUNCTION_VALUE(constants[idx]);
+            SAVE_STACK_TOP();
 
+            // open upvalues are gc roots,so they are captured before the closure is allocated
+            UpvalueObject *upvalues[UPVALUE_COUNT];
             for (uint8_t i = 0; i < upvalueCount; ++i)
             {
-                auto index = *frame->ip++;
-                auto scopeDepth = *frame->ip++;
-
-                auto upvalue = Allocator::GetInstance()->CaptureUpvalue(index, scopeDepth);
-
-                closure->upvalues[i] = upvalue;
+                auto index = READ_U8();
+                auto scopeDepth = READ_U8();
+                upvalues[i] = Allocator::GetInstance()->CaptureUpvalue(index, scopeDepth);
             }
 
-            break;
+            auto closure = ALLOCATE_CLOSURE_OBJECT(function, upvalues, upvalueCount);
+            VM_PUSH(closure);
+            VM_NEXT();
         }
-        case OP_DEF_LOCAL:
+        VM_CASE(OP_DEF_LOCAL)
         {
-            auto index = *frame->ip++;
-            auto value = POP();
-            Value *slot = GET_LOCAL_VARIABLE_SLOT(index);
-            *slot = value;
-            break;
+            auto index = READ_U8();
+            frame->slot[index] = VM_POP();
+            VM_NEXT();
         }
-        case OP_SET_LOCAL:
+        VM_CASE(OP_SET_LOCAL)
         {
-            auto index = *frame->ip++;
-            auto value = POP();
-            Value *slot = GET_LOCAL_VARIABLE_SLOT(index);
-            SetValue(slot, value);
-            break;
+            auto index = READ_U8();
+            auto value = VM_POP();
+            SetValue(frame->slot + index, value);
+            VM_NEXT();
         }
-        case OP_GET_LOCAL:
+        VM_CASE(OP_GET_LOCAL)
         {
-            auto index = *frame->ip++;
-            Value *slot = GET_LOCAL_VARIABLE_SLOT(index);
-            PUSH(*slot);
-            break;
+            auto index = READ_U8();
+            VM_PUSH(frame->slot[index]);
+            VM_NEXT();
         }
-        case OP_GET_UPVALUE:
+        VM_CASE(OP_GET_UPVALUE)
         {
-            auto index = *frame->ip++;
+            auto index = READ_U8();
             auto upvalue = frame->closure->upvalues[index];
-            PUSH(*upvalue->location);
-            break;
+            VM_PUSH(*upvalue->location);
+            VM_NEXT();
         }
-        case OP_SET_UPVALUE:
+        VM_CASE(OP_SET_UPVALUE)
         {
-            auto value = POP();
-            auto index = *frame->ip++;
+            auto value = VM_POP();
+            auto index = READ_U8();
             auto slot = frame->closure->upvalues[index]->location;
             SetValue(slot, value);
-            break;
+            VM_NEXT();
         }
-        case OP_GET_BUILTIN:
+        VM_CASE(OP_GET_BUILTIN)
         {
-            auto idx = *frame->ip++;
-            auto name = TO_STR_VALUE(frame->closure->function->chunk.constants[idx]);
-            auto builtinObj = BuiltinManager::GetInstance()->FindBuiltinObject(name);
-            PUSH(builtinObj);
-            break;
+            auto opcodeAddr = ip - 1;
+            auto idx = READ_U16();
+            auto name = TO_STR_VALUE(constants[idx]);
+            auto index = BuiltinManager::GetInstance()->FindBuiltinIndex(name);
+            if (index < 0)
+                ASSERT("No builtin object:%s", ObjectStringify(name).c_str());
+            // resolve the site on its first execution,the builtin list only grows
+            // so builtins registered later by a dllimport resolve the same way
+            if (index <= UINT16_MAX)
+            {
+                EncodeOperand<uint16_t>(opcodeAddr + 1, static_cast<uint16_t>(index));
+                QUICKEN(opcodeAddr, OP_GET_BUILTIN_INDEX);
+            }
+            VM_PUSH(BuiltinManager::GetInstance()->GetBuiltinObject(index));
+            VM_NEXT();
         }
-        case OP_STRUCT:
+        VM_CASE(OP_STRUCT)
         {
-            HashTable *members = new HashTable();
-            auto memberCount = 2 * (*frame->ip++);
-            for (auto slot = GET_STACK_TOP(); slot > GET_STACK_TOP() - memberCount;)
+            uint32_t memberCount = 2 * READ_U16();
+            StructObject *structInstance = nullptr;
+            SAVE_STACK_TOP();
+            if (static_cast<uint32_t>(memberCount / 2) <= SHAPE_MAX_FIELD_COUNT)
+            {
+                Shape *shape = Shape::GetRoot();
+                Value fields[SHAPE_MAX_FIELD_COUNT];
+                for (auto slot = stackTop - memberCount; slot < stackTop;)
+                {
+                    auto value = *slot++;
+                    auto name = TO_STR_VALUE(*slot++);
+                    shape = shape->Transition(name);
+                    fields[shape->FindSlot(name)] = value;
+                }
+                structInstance = ALLOCATE_STRUCT_OBJECT(shape, fields);
+            }
+            else
             {
-                auto name = TO_STR_VALUE(*--slot);
-                auto value = *--slot;
-                members->Set(name, value);
+                HashTable *members = new HashTable();
+                for (auto slot = stackTop; slot > stackTop - memberCount;)
+                {
+                    auto name = TO_STR_VALUE(*--slot);
+                    auto value = *--slot;
+                    members->Set(name, value);
+                }
+                structInstance = ALLOCATE_OBJECT(StructObject, members);
             }
-            auto structInstance = ALLOCATE_OBJECT(StructObject, members);
 
-            STACK_TOP_JUMP(-memberCount);
+            stackTop -= memberCount;
 
-            PUSH(structInstance);
-            break;
+            VM_PUSH(structInstance);
+            VM_NEXT();
+        }
+        VM_CASE(OP_NEW_STRUCT)
+        {
+            // the prototype already has the shape and the default member values,the instance is a copy of it
+            auto prototype = TO_STRUCT_VALUE(constants[READ_U16()]);
+            SAVE_STACK_TOP();
+            VM_PUSH(ALLOCATE_STRUCT_OBJECT(prototype->shape, prototype->fields));
+            VM_NEXT();
         }
-        case OP_GET_STRUCT:
+        VM_CASE(OP_GET_STRUCT)
         {
-            auto memberName = POP();
+            auto cacheIdx = READ_U16();
+            auto memberName = VM_POP();
             Value instance;
-            GetEndOfRefValue(POP(), instance);
-    
+            GetEndOfRefValue(VM_POP(), instance);
+
             auto structInstance = TO_STRUCT_VALUE(instance);
 
-            Value *value = structInstance->members->Get(TO_STR_VALUE(memberName));
+            Value *value = GetStructMember(structInstance, TO_STR_VALUE(memberName), frame->closure->function->chunk.inlineCaches[cacheIdx]);
             if (!value)
                 ASSERT("no member named:(%s) in struct instance:%s", memberName.Stringify().c_str(), instance.Stringify().c_str());
-            PUSH(*value);
-            break;
+            VM_PUSH(*value);
+            VM_NEXT();
         }
-        case OP_SET_STRUCT:
+        VM_CASE(OP_SET_STRUCT)
         {
-            auto memberName = POP();
+            auto cacheIdx = READ_U16();
+            auto memberName = VM_POP();
             Value instance;
-            GetEndOfRefValue(POP(), instance);
+            GetEndOfRefValue(VM_POP(), instance);
             auto structInstance = TO_STRUCT_VALUE(instance);
-            auto value = POP();
-           
-            bool isSuccess = structInstance->members->Find(TO_STR_VALUE(memberName));
-            if (!isSuccess)
+            auto value = VM_POP();
+
+            Value *structMember = GetStructMember(structInstance, TO_STR_VALUE(memberName), frame->closure->function->chunk.inlineCaches[cacheIdx]);
+            if (!structMember)
                 ASSERT("no member named:(%s) in struct instance:(0x%s)", memberName.Stringify().c_str(), PointerAddressToString(structInstance).c_str());
-            Value *structMember = structInstance->members->Get(TO_STR_VALUE(memberName));
             SetValue(structMember, value);
-            break;
+            VM_NEXT();
         }
-        case OP_REF_GLOBAL:
+        VM_CASE(OP_REF_GLOBAL)
         {
-            auto index = *frame->ip++;
-            auto ptr = GetEndOfRefValuePtr(GET_GLOBAL_VARIABLE_SLOT(index));
-            PUSH(ALLOCATE_OBJECT(RefObject, ptr));
-            break;
+            auto index = READ_U8();
+            auto ptr = GetEndOfRefValuePtr(globals + index);
+            SAVE_STACK_TOP();
+            VM_PUSH(ALLOCATE_OBJECT(RefObject, ptr));
+            VM_NEXT();
         }
-       case OP_REF_LOCAL:
+        VM_CASE(OP_REF_LOCAL)
         {
-            auto index = *frame->ip++;
-            Value *slot = GetEndOfRefValuePtr(GET_LOCAL_VARIABLE_SLOT(index));
-            PUSH(ALLOCATE_OBJECT(RefObject, slot));
-            break;
+            auto index = READ_U8();
+            Value *slot = GetEndOfRefValuePtr(frame->slot + index);
+            SAVE_STACK_TOP();
+            VM_PUSH(ALLOCATE_OBJECT(RefObject, slot));
+            VM_NEXT();
         }
-        case OP_REF_UPVALUE:
+        VM_CASE(OP_REF_UPVALUE)
         {
-            auto index = *frame->ip++;
+            auto index = READ_U8();
             Value *slot = GetEndOfRefValuePtr(frame->closure->upvalues[index]->location);
-            PUSH(ALLOCATE_OBJECT(RefObject, slot));
-            break;
+            SAVE_STACK_TOP();
+            VM_PUSH(ALLOCATE_OBJECT(RefObject, slot));
+            VM_NEXT();
         }
-        case OP_REF_INDEX_GLOBAL:
+        VM_CASE(OP_REF_INDEX_GLOBAL)
         {
-            auto index = *frame->ip++;
-            auto idxValue = POP();
-            auto ptr = GetEndOfRefValuePtr(GET_GLOBAL_VARIABLE_SLOT(index));
-            PUSH(ALLOCATE_INDEX_REF_OBJECT(ptr, idxValue));
-            break;
+            auto index = READ_U8();
+            auto idxValue = VM_POP();
+            auto ptr = GetEndOfRefValuePtr(globals + index);
+            SAVE_STACK_TOP();
+            VM_PUSH(ALLOCATE_INDEX_REF_OBJECT(ptr, idxValue));
+            VM_NEXT();
         }
-        case OP_REF_INDEX_LOCAL:
+        VM_CASE(OP_REF_INDEX_LOCAL)
         {
-            auto index = *frame->ip++;
-            auto idxValue = POP();
-            Value *slot = GetEndOfRefValuePtr(GET_LOCAL_VARIABLE_SLOT(index));
-            PUSH(ALLOCATE_INDEX_REF_OBJECT(slot, idxValue));
-            break;
+            auto index = READ_U8();
+            auto idxValue = VM_POP();
+            Value *slot = GetEndOfRefValuePtr(frame->slot + index);
+            SAVE_STACK_TOP();
+            VM_PUSH(ALLOCATE_INDEX_REF_OBJECT(slot, idxValue));
+            VM_NEXT();
         }
-        case OP_REF_INDEX_UPVALUE:
+        VM_CASE(OP_REF_INDEX_UPVALUE)
         {
-            auto index = *frame->ip++;
-            auto idxValue = POP();
+            auto index = READ_U8();
+            auto idxValue = VM_POP();
             Value *slot = GetEndOfRefValuePtr(frame->closure->upvalues[index]->location);
-            PUSH(ALLOCATE_INDEX_REF_OBJECT(slot, idxValue));
-            break;
+            SAVE_STACK_TOP();
+            VM_PUSH(ALLOCATE_INDEX_REF_OBJECT(slot, idxValue));
+            VM_NEXT();
+        }
+        VM_CASE(OP_STACK_REF_GLOBAL)
+        {
+            auto index = READ_U8();
+            SAVE_STACK_TOP();
+            VM_PUSH(ALLOCATE_STACK_REF_OBJECT(GetEndOfRefValuePtr(globals + index)));
+            VM_NEXT();
+        }
+        VM_CASE(OP_STACK_REF_LOCAL)
+        {
+            auto index = READ_U8();
+            SAVE_STACK_TOP();
+            VM_PUSH(ALLOCATE_STACK_REF_OBJECT(GetEndOfRefValuePtr(frame->slot + index)));
+            VM_NEXT();
+        }
+        VM_CASE(OP_STACK_REF_UPVALUE)
+        {
+            auto index = READ_U8();
+            SAVE_STACK_TOP();
+            VM_PUSH(ALLOCATE_STACK_REF_OBJECT(GetEndOfRefValuePtr(frame->closure->upvalues[index]->location)));
+            VM_NEXT();
+        }
+        VM_CASE(OP_STACK_REF_INDEX_GLOBAL)
+        {
+            auto index = READ_U8();
+            auto idxValue = VM_POP();
+            SAVE_STACK_TOP();
+            VM_PUSH(ALLOCATE_STACK_INDEX_REF_OBJECT(GetEndOfRefValuePtr(globals + index), idxValue));
+            VM_NEXT();
+        }
+        VM_CASE(OP_STACK_REF_INDEX_LOCAL)
+        {
+            auto index = READ_U8();
+            auto idxValue = VM_POP();
+            SAVE_STACK_TOP();
+            VM_PUSH(ALLOCATE_STACK_INDEX_REF_OBJECT(GetEndOfRefValuePtr(frame->slot + index), idxValue));
+            VM_NEXT();
+        }
+        VM_CASE(OP_STACK_REF_INDEX_UPVALUE)
+        {
+            auto index = READ_U8();
+            auto idxValue = VM_POP();
+            SAVE_STACK_TOP();
+            VM_PUSH(ALLOCATE_STACK_INDEX_REF_OBJECT(GetEndOfRefValuePtr(frame->closure->upvalues[index]->location), idxValue));
+            VM_NEXT();
+        }
+        VM_CASE(OP_STACK_REF_CALL)
+        {
+            auto argCount = READ_U8();
+            auto callee = *(stackTop - argCount - 1);
+            SAVE_STACK_TOP();
+            for (uint8_t i = 0; i < argCount; ++i)
+            {
+                // builtin functions may keep any argument
+                Value &arg = *(stackTop - argCount + i);
+                if (IS_REF_VALUE(arg) && IS_STACK_REF_OBJECT(TO_REF_VALUE(arg)) &&
+                    (!IS_CLOSURE_VALUE(callee) || TO_CLOSURE_VALUE(callee)->function->IsParamEscaping(i)))
+                    arg = ALLOCATE_OBJECT(RefObject, TO_REF_VALUE(arg)->pointer);
+            }
+            CALL_VALUE(argCount);
+            VM_NEXT();
+        }
+        VM_CASE(OP_RELEASE_STACK_REFS)
+        {
+            RELEASE_STACK_REF_OBJECTS(READ_U8());
+            VM_NEXT();
         }
-        case OP_DLL_IMPORT:
+        VM_CASE(OP_CONCAT)
         {
-            auto name = TO_STR_VALUE(POP())->value;
+            auto count = READ_U8();
+            Value ret;
+            SAVE_STACK_TOP();
+            ValueConcat(stackTop - count, count, ret);
+            stackTop -= count;
+            VM_PUSH(ret);
+            VM_NEXT();
+        }
+        VM_CASE(OP_DLL_IMPORT)
+        {
+            auto name = TO_STR_VALUE(VM_POP())->value;
+            SAVE_STACK_TOP();
             Allocator::GetInstance()->DisableGC();
             RegisterDLLs(name);
             Allocator::GetInstance()->EnableGC();
-            break;
+            VM_NEXT();
+        }
+        VM_CASE(OP_INC_LOCAL)
+        {
+            auto opcodeAddr = ip - 1;
+            auto index = READ_U8();
+            auto constIdx = READ_U16();
+            if (IS_NUM_VALUE(frame->slot[index]) && IS_NUM_VALUE(constants[constIdx]))
+                QUICKEN(opcodeAddr, OP_INC_LOCAL_NUM);
+            Value ret;
+            SAVE_STACK_TOP();
+            ValueAdd(frame->slot[index], constants[constIdx], ret);
+            SetValue(frame->slot + index, ret);
+            VM_NEXT();
+        }
+        VM_CASE(OP_INC_GLOBAL)
+        {
+            auto opcodeAddr = ip - 1;
+            auto index = READ_U8();
+            auto constIdx = READ_U16();
+            if (IS_NUM_VALUE(globals[index]) && IS_NUM_VALUE(constants[constIdx]))
+                QUICKEN(opcodeAddr, OP_INC_GLOBAL_NUM);
+            Value ret;
+            SAVE_STACK_TOP();
+            ValueAdd(globals[index], constants[constIdx], ret);
+            SetValue(globals + index, ret);
+            VM_NEXT();
+        }
+        // the fused jumps keep the OP_JUMP_IF_FALSE semantics:branch when the original condition is false
+        VM_CASE(OP_JUMP_IF_LESS)
+        {
+            COMPARE_JUMP(ValueLess(l, r), OP_JUMP_IF_LESS_NUM);
+            VM_NEXT();
         }
+        VM_CASE(OP_JUMP_IF_GREATER)
+        {
+            COMPARE_JUMP(ValueGreater(l, r), OP_JUMP_IF_GREATER_NUM);
+            VM_NEXT();
+        }
+        VM_CASE(OP_JUMP_IF_EQUAL)
+        {
+            COMPARE_JUMP(ValueEqual(l, r), OP_JUMP_IF_EQUAL_NUM);
+            VM_NEXT();
+        }
+        VM_CASE(OP_JUMP_IF_NOT_LESS)
+        {
+            COMPARE_JUMP(!ValueLess(l, r), OP_JUMP_IF_NOT_LESS_NUM);
+            VM_NEXT();
+        }
+        VM_CASE(OP_JUMP_IF_NOT_GREATER)
+        {
+            COMPARE_JUMP(!ValueGreater(l, r), OP_JUMP_IF_NOT_GREATER_NUM);
+            VM_NEXT();
+        }
+        VM_CASE(OP_JUMP_IF_NOT_EQUAL)
+        {
+            COMPARE_JUMP(!ValueEqual(l, r), OP_JUMP_IF_NOT_EQUAL_NUM);
+            VM_NEXT();
+        }
+        VM_CASE(OP_ADD_NUM)
+        {
+            ARITHMETIC_NUM(IntAdd, +, OP_ADD);
+            VM_NEXT();
+        }
+        VM_CASE(OP_SUB_NUM)
+        {
+            ARITHMETIC_NUM(IntSub, -, OP_SUB);
+            VM_NEXT();
+        }
+        VM_CASE(OP_MUL_NUM)
+        {
+            ARITHMETIC_NUM(IntMul, *, OP_MUL);
+            VM_NEXT();
+        }
+        VM_CASE(OP_DIV_NUM)
+        {
+            BINARY_NUM(/, OP_DIV);
+            VM_NEXT();
+        }
+        VM_CASE(OP_GREATER_NUM)
+        {
+            COMPARE_NUM(>, OP_GREATER);
+            VM_NEXT();
+        }
+        VM_CASE(OP_LESS_NUM)
+        {
+            COMPARE_NUM(<, OP_LESS);
+            VM_NEXT();
+        }
+        VM_CASE(OP_EQUAL_NUM)
+        {
+            COMPARE_NUM(==, OP_EQUAL);
+            VM_NEXT();
+        }
+        VM_CASE(OP_INC_LOCAL_NUM)
+        {
+            auto opcodeAddr = ip - 1;
+            auto index = READ_U8();
+            auto constIdx = READ_U16();
+            if (IS_INT_VALUE(frame->slot[index]) && IS_INT_VALUE(constants[constIdx]))
+                frame->slot[index] = IntAdd(TO_INT_VALUE(frame->slot[index]), TO_INT_VALUE(constants[constIdx]));
+            else if (IS_NUM_VALUE(frame->slot[index]) && IS_NUM_VALUE(constants[constIdx]))
+                frame->slot[index] = TO_NUM_VALUE(frame->slot[index]) + TO_NUM_VALUE(constants[constIdx]);
+            else
+                DEOPTIMIZE(opcodeAddr, OP_INC_LOCAL);
+            VM_NEXT();
+        }
+        VM_CASE(OP_INC_GLOBAL_NUM)
+        {
+            auto opcodeAddr = ip - 1;
+            auto index = READ_U8();
+            auto constIdx = READ_U16();
+            if (IS_INT_VALUE(globals[index]) && IS_INT_VALUE(constants[constIdx]))
+                globals[index] = IntAdd(TO_INT_VALUE(globals[index]), TO_INT_VALUE(constants[constIdx]));
+            else if (IS_NUM_VALUE(globals[index]) && IS_NUM_VALUE(constants[constIdx]))
+                globals[index] = TO_NUM_VALUE(globals[index]) + TO_NUM_VALUE(constants[constIdx]);
+            else
+                DEOPTIMIZE(opcodeAddr, OP_INC_GLOBAL);
+            VM_NEXT();
+        }
+        VM_CASE(OP_JUMP_IF_LESS_NUM)
+        {
+            COMPARE_JUMP_NUM(l < r, OP_JUMP_IF_LESS);
+            VM_NEXT();
+        }
+        VM_CASE(OP_JUMP_IF_GREATER_NUM)
+        {
+            COMPARE_JUMP_NUM(l > r, OP_JUMP_IF_GREATER);
+            VM_NEXT();
+        }
+        VM_CASE(OP_JUMP_IF_EQUAL_NUM)
+        {
+            COMPARE_JUMP_NUM(l == r, OP_JUMP_IF_EQUAL);
+            VM_NEXT();
+        }
+        VM_CASE(OP_JUMP_IF_NOT_LESS_NUM)
+        {
+            COMPARE_JUMP_NUM(!(l < r), OP_JUMP_IF_NOT_LESS);
+            VM_NEXT();
+        }
+        VM_CASE(OP_JUMP_IF_NOT_GREATER_NUM)
+        {
+            COMPARE_JUMP_NUM(!(l > r), OP_JUMP_IF_NOT_GREATER);
+            VM_NEXT();
+        }
+        VM_CASE(OP_JUMP_IF_NOT_EQUAL_NUM)
+        {
+            COMPARE_JUMP_NUM(!(l == r), OP_JUMP_IF_NOT_EQUAL);
+            VM_NEXT();
+        }
+        VM_CASE(OP_GET_BUILTIN_INDEX)
+        {
+            auto index = READ_U16();
+            VM_PUSH(BuiltinManager::GetInstance()->GetBuiltinObject(index));
+            VM_NEXT();
+        }
+#ifndef VM_USE_COMPUTED_GOTO
         default:
+            SAVE_STACK_TOP();
             return;
+#endif
+    }
+}
+
+// register-based bytecode:the operands of an instruction are registers of the frame(frame->slot[R]),constants and globals.
+// a call copies the callee and its arguments to the end of the registers of the caller,so frames never overlap
+// and the end of the registers of the top frame is the stack top the gc scans,it is updated on every call and return
+#define LOAD_REGISTERS()                                                      \
+    do                                                                        \
+    {                                                                         \
+        registers = frame->slot;                                              \
+        stackTop = registers + frame->closure->function->localVarCount;       \
+        SAVE_STACK_TOP();                                                     \
+    } while (false)
+
+// the registers above the arguments of a new frame may hold values of a frame returned before
+#define CLEAR_REGISTERS(begin)                         \
+    do                                                 \
+    {                                                  \
+        for (Value *p = (begin); p < stackTop; ++p)    \
+            *p = Value();                              \
+    } while (false)
+
+#define REGISTER_QUICKEN_BINARY(op, quickOp)      \
+    do                                            \
+    {                                             \
+        auto opcodeAddr = ip - 1;                 \
+        auto dst = READ_U8();                     \
+        auto &l = registers[READ_U8()];           \
+        auto &r = registers[READ_U8()];           \
+        if (IS_NUM_VALUE(l) && IS_NUM_VALUE(r))   \
+            QUICKEN(opcodeAddr, quickOp);         \
+        registers[dst] = op(l, r);                \
+    } while (false)
+
+#define REGISTER_QUICKEN_ARITHMETIC(op, quickOp, readRight) \
+    do                                                      \
+    {                                                       \
+        auto opcodeAddr = ip - 1;                           \
+        auto dst = READ_U8();                               \
+        auto &l = registers[READ_U8()];                     \
+        auto &r = readRight;                                \
+        if (IS_NUM_VALUE(l) && IS_NUM_VALUE(r))             \
+            QUICKEN(opcodeAddr, quickOp);                   \
+        Value ret;                                          \
+        op(l, r, ret);                                      \
+        registers[dst] = ret;                               \
+    } while (false)
+
+// the operands are read in place,a deoptimized instruction is executed again from its opcode
+#define REGISTER_ARITHMETIC_NUM(intOp, op, genericOp, rightSize, right)       \
+    do                                                                        \
+    {                                                                         \
+        auto opcodeAddr = ip - 1;                                             \
+        auto &l = registers[ip[1]];                                           \
+        auto &r = right;                                                      \
+        if (IS_INT_VALUE(l) && IS_INT_VALUE(r))                               \
+            registers[ip[0]] = intOp(TO_INT_VALUE(l), TO_INT_VALUE(r));       \
+        else if (IS_NUM_VALUE(l) && IS_NUM_VALUE(r))                          \
+            registers[ip[0]] = TO_NUM_VALUE(l) op TO_NUM_VALUE(r);            \
+        else                                                                  \
+        {                                                                     \
+            DEOPTIMIZE(opcodeAddr, genericOp);                                \
+            VM_NEXT();                                                        \
+        }                                                                     \
+        ip += 2 + (rightSize);                                                \
+    } while (false)
+
+#define REGISTER_COMPARE_NUM(op, genericOp)                                      \
+    do                                                                           \
+    {                                                                            \
+        auto opcodeAddr = ip - 1;                                                \
+        auto &l = registers[ip[1]];                                              \
+        auto &r = registers[ip[2]];                                              \
+        if (IS_INT_VALUE(l) && IS_INT_VALUE(r))                                  \
+            registers[ip[0]] = TO_INT_VALUE(l) op TO_INT_VALUE(r);               \
+        else if (IS_NUM_VALUE(l) && IS_NUM_VALUE(r))                             \
+            registers[ip[0]] = TO_NUM_VALUE(l) op TO_NUM_VALUE(r);               \
+        else                                                                     \
+        {                                                                        \
+            DEOPTIMIZE(opcodeAddr, genericOp);                                   \
+            VM_NEXT();                                                           \
+        }                                                                        \
+        ip += 3;                                                                 \
+    } while (false)
+
+#define REGISTER_BIT_BINARY(op, fn)                              \
+    do                                                           \
+    {                                                            \
+        auto dst = READ_U8();                                    \
+        auto &l = registers[READ_U8()];                          \
+        auto &r = registers[READ_U8()];                          \
+        if (IS_INT_VALUE(l) && IS_INT_VALUE(r))                  \
+            registers[dst] = TO_INT_VALUE(l) op TO_INT_VALUE(r); \
+        else                                                     \
+            registers[dst] = fn(l, r);                           \
+    } while (false)
+
+#define REGISTER_COMPARE_JUMP(cond, quickOp, readRight) \
+    do                                                  \
+    {                                                   \
+        auto opcodeAddr = ip - 1;                       \
+        auto &l = registers[READ_U8()];                 \
+        auto &r = readRight;                            \
+        READ_JUMP_OPERANDS();                           \
+        if (IS_NUM_VALUE(l) && IS_NUM_VALUE(r))         \
+            QUICKEN(opcodeAddr, quickOp);               \
+        if (cond)                                       \
+            ip = opcodeAddr + offset;                   \
+    } while (false)
+
+#define REGISTER_COMPARE_JUMP_NUM(cond, genericOp, readRight) \
+    do                                                        \
+    {                                                         \
+        auto opcodeAddr = ip - 1;                             \
+        auto &lv = registers[READ_U8()];                      \
+        auto &rv = readRight;                                 \
+        READ_JUMP_OPERANDS();                                 \
+        if (IS_INT_VALUE(lv) && IS_INT_VALUE(rv))             \
+        {                                                     \
+            auto l = TO_INT_VALUE(lv);                        \
+            auto r = TO_INT_VALUE(rv);                        \
+            if (cond)                                         \
+                ip = opcodeAddr + offset;                     \
+        }                                                     \
+        else if (IS_NUM_VALUE(lv) && IS_NUM_VALUE(rv))        \
+        {                                                     \
+            auto l = TO_NUM_VALUE(lv);                        \
+            auto r = TO_NUM_VALUE(rv);                        \
+            if (cond)                                         \
+                ip = opcodeAddr + offset;                     \
+        }                                                     \
+        else                                                  \
+            DEOPTIMIZE(opcodeAddr, genericOp);                \
+    } while (false)
+
+#define READ_REGISTER() registers[READ_U8()]
+#define READ_CONSTANT() constants[READ_U16()]
+
+#define REGISTER_CALL_VALUE(base, argCount)                                                                                                                           \
+    do                                                                                                                                                                \
+    {                                                                                                                                                                 \
+        Value *window = registers + (base);                                                                                                                           \
+        auto value = *window;                                                                                                                                         \
+        if (IS_CLOSURE_VALUE(value))                                                                                                                                  \
+        {                                                                                                                                                             \
+            auto closure = TO_CLOSURE_VALUE(value);                                                                                                                   \
+                                                                                                                                                                      \
+            if ((argCount) != closure->function->parameterCount)                                                                                                      \
+                ASSERT("Non matching function parameters for calling arguments,parameter count:%d,argument count:%d", closure->function->parameterCount, (argCount)); \
+                                                                                                                                                                      \
+            SAVE_FRAME();                                                                                                                                             \
+                                                                                                                                                                      \
+            std::copy(window, window + (argCount) + 1, stackTop);                                                                                                     \
+            PUSH_CALL_FRAME(CallFrame(closure, stackTop + 1));                                                                                                        \
+            LOAD_FRAME();                                                                                                                                             \
+            LOAD_REGISTERS();                                                                                                                                         \
+            CLEAR_REGISTERS(registers + (argCount));                                                                                                                  \
+        }                                                                                                                                                             \
+        else if (IS_BUILTIN_VALUE(value))                                                                                                                             \
+        {                                                                                                                                                             \
+            auto builtin = TO_BUILTIN_VALUE(value);                                                                                                                   \
+                                                                                                                                                                      \
+            if (!builtin->fn)                                                                                                                                         \
+                ASSERT("Invalid builtin function");                                                                                                                   \
+            if (builtin->arity != BUILTIN_FN_VARIADIC && builtin->arity != (argCount))                                                                                \
+                ASSERT("Non matching builtin function arguments,expect %d,got %d", builtin->arity, (argCount));                                                       \
+                                                                                                                                                                      \
+            Value returnValue;                                                                                                                                        \
+            if (!builtin->fn(window + 1, (argCount), returnValue))                                                                                                    \
+                returnValue = Value();                                                                                                                                \
+            *window = returnValue;                                                                                                                                    \
+        }                                                                                                                                                             \
+        else                                                                                                                                                          \
+            ASSERT("Calling not a function or a builtinFn");                                                                                                          \
+    } while (false)
+
+void VM::ExecuteRegister()
+{
+#ifdef VM_USE_COMPUTED_GOTO
+    // must keep the same order as the register opcodes of enum OpCode
+    static void *dispatchTable[] = {
+        &&LABEL_OP_R_MOVE,
+        &&LABEL_OP_R_CONSTANT,
+        &&LABEL_OP_R_ADD,
+        &&LABEL_OP_R_SUB,
+        &&LABEL_OP_R_MUL,
+        &&LABEL_OP_R_DIV,
+        &&LABEL_OP_R_EQUAL,
+        &&LABEL_OP_R_GREATER,
+        &&LABEL_OP_R_LESS,
+        &&LABEL_OP_R_NOT,
+        &&LABEL_OP_R_MINUS,
+        &&LABEL_OP_R_AND,
+        &&LABEL_OP_R_OR,
+        &&LABEL_OP_R_BIT_AND,
+        &&LABEL_OP_R_BIT_OR,
+        &&LABEL_OP_R_BIT_NOT,
+        &&LABEL_OP_R_BIT_XOR,
+        &&LABEL_OP_R_ADD_CONSTANT,
+        &&LABEL_OP_R_SUB_CONSTANT,
+        &&LABEL_OP_R_MUL_CONSTANT,
+        &&LABEL_OP_R_JUMP,
+        &&LABEL_OP_R_JUMP_IF_FALSE,
+        &&LABEL_OP_R_DEF_GLOBAL,
+        &&LABEL_OP_R_SET_GLOBAL,
+        &&LABEL_OP_R_GET_GLOBAL,
+        &&LABEL_OP_R_SET_LOCAL,
+        &&LABEL_OP_R_GET_UPVALUE,
+        &&LABEL_OP_R_SET_UPVALUE,
+        &&LABEL_OP_R_ARRAY,
+        &&LABEL_OP_R_GET_INDEX,
+        &&LABEL_OP_R_SET_INDEX,
+        &&LABEL_OP_R_CLOSURE,
+        &&LABEL_OP_R_FUNCTION_CALL,
+        &&LABEL_OP_R_TAIL_CALL,
+        &&LABEL_OP_R_RETURN,
+        &&LABEL_OP_R_GET_BUILTIN,
+        &&LABEL_OP_R_STRUCT,
+        &&LABEL_OP_R_NEW_STRUCT,
+        &&LABEL_OP_R_GET_STRUCT,
+        &&LABEL_OP_R_SET_STRUCT,
+        &&LABEL_OP_R_REF_GLOBAL,
+        &&LABEL_OP_R_REF_LOCAL,
+        &&LABEL_OP_R_REF_UPVALUE,
+        &&LABEL_OP_R_REF_INDEX_GLOBAL,
+        &&LABEL_OP_R_REF_INDEX_LOCAL,
+        &&LABEL_OP_R_REF_INDEX_UPVALUE,
+        &&LABEL_OP_R_STACK_REF_GLOBAL,
+        &&LABEL_OP_R_STACK_REF_LOCAL,
+        &&LABEL_OP_R_STACK_REF_UPVALUE,
+        &&LABEL_OP_R_STACK_REF_INDEX_GLOBAL,
+        &&LABEL_OP_R_STACK_REF_INDEX_LOCAL,
+        &&LABEL_OP_R_STACK_REF_INDEX_UPVALUE,
+        &&LABEL_OP_R_STACK_REF_CALL,
+        &&LABEL_OP_R_RELEASE_STACK_REFS,
+        &&LABEL_OP_R_CONCAT,
+        &&LABEL_OP_R_DLL_IMPORT,
+        &&LABEL_OP_R_INC_LOCAL,
+        &&LABEL_OP_R_INC_GLOBAL,
+        &&LABEL_OP_R_JUMP_IF_LESS,
+        &&LABEL_OP_R_JUMP_IF_GREATER,
+        &&LABEL_OP_R_JUMP_IF_EQUAL,
+        &&LABEL_OP_R_JUMP_IF_NOT_LESS,
+        &&LABEL_OP_R_JUMP_IF_NOT_GREATER,
+        &&LABEL_OP_R_JUMP_IF_NOT_EQUAL,
+        &&LABEL_OP_R_JUMP_IF_LESS_CONSTANT,
+        &&LABEL_OP_R_JUMP_IF_GREATER_CONSTANT,
+        &&LABEL_OP_R_JUMP_IF_EQUAL_CONSTANT,
+        &&LABEL_OP_R_JUMP_IF_NOT_LESS_CONSTANT,
+        &&LABEL_OP_R_JUMP_IF_NOT_GREATER_CONSTANT,
+        &&LABEL_OP_R_JUMP_IF_NOT_EQUAL_CONSTANT,
+        &&LABEL_OP_R_ADD_NUM,
+        &&LABEL_OP_R_SUB_NUM,
+        &&LABEL_OP_R_MUL_NUM,
+        &&LABEL_OP_R_DIV_NUM,
+        &&LABEL_OP_R_GREATER_NUM,
+        &&LABEL_OP_R_LESS_NUM,
+        &&LABEL_OP_R_EQUAL_NUM,
+        &&LABEL_OP_R_ADD_CONSTANT_NUM,
+        &&LABEL_OP_R_SUB_CONSTANT_NUM,
+        &&LABEL_OP_R_MUL_CONSTANT_NUM,
+        &&LABEL_OP_R_INC_LOCAL_NUM,
+        &&LABEL_OP_R_INC_GLOBAL_NUM,
+        &&LABEL_OP_R_JUMP_IF_LESS_NUM,
+        &&LABEL_OP_R_JUMP_IF_GREATER_NUM,
+        &&LABEL_OP_R_JUMP_IF_EQUAL_NUM,
+        &&LABEL_OP_R_JUMP_IF_NOT_LESS_NUM,
+        &&LABEL_OP_R_JUMP_IF_NOT_GREATER_NUM,
+        &&LABEL_OP_R_JUMP_IF_NOT_EQUAL_NUM,
+        &&LABEL_OP_R_JUMP_IF_LESS_CONSTANT_NUM,
+        &&LABEL_OP_R_JUMP_IF_GREATER_CONSTANT_NUM,
+        &&LABEL_OP_R_JUMP_IF_EQUAL_CONSTANT_NUM,
+        &&LABEL_OP_R_JUMP_IF_NOT_LESS_CONSTANT_NUM,
+        &&LABEL_OP_R_JUMP_IF_NOT_GREATER_CONSTANT_NUM,
+        &&LABEL_OP_R_JUMP_IF_NOT_EQUAL_CONSTANT_NUM,
+        &&LABEL_OP_R_GET_BUILTIN_INDEX,
+    };
+    static_assert(sizeof(dispatchTable) / sizeof(dispatchTable[0]) == OP_COUNT - OP_R_MOVE, "dispatch table mismatch with the register opcodes of enum OpCode");
+    constexpr uint8_t dispatchBase = OP_R_MOVE;
+#endif
+
+    CallFrame *frame;
+    uint8_t *ip;
+    Value *constants;
+    Value *registers;
+    Value *stackTop;
+    Value *globals = GET_GLOBAL_VARIABLE_SLOT(0);
+
+    LOAD_FRAME();
+    LOAD_REGISTERS();
+
+    VM_DISPATCH()
+    {
+        VM_CASE(OP_R_RETURN)
+        {
+            auto returnCount = READ_U8();
+            auto src = READ_U8();
+            Value value = returnCount == 1 ? registers[src] : Value();
+
+            Allocator::GetInstance()->ClosedUpvalues(frame->slot);
+
+            POP_CALL_FRAME();
+
+            if (Allocator::GetInstance()->IsCallFrameStackEmpty())
+                return;
+
+            LOAD_FRAME();
+            LOAD_REGISTERS();
+
+            // the call returned to holds the register of the callee as its first operand
+            registers[ip[-2]] = value;
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_MOVE)
+        {
+            auto dst = READ_U8();
+            registers[dst] = READ_REGISTER();
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_CONSTANT)
+        {
+            auto dst = READ_U8();
+            registers[dst] = READ_CONSTANT();
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_ADD)
+        {
+            REGISTER_QUICKEN_ARITHMETIC(ValueAdd, OP_R_ADD_NUM, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_SUB)
+        {
+            REGISTER_QUICKEN_ARITHMETIC(ValueSub, OP_R_SUB_NUM, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_MUL)
+        {
+            REGISTER_QUICKEN_ARITHMETIC(ValueMul, OP_R_MUL_NUM, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_DIV)
+        {
+            REGISTER_QUICKEN_BINARY(ValueDiv, OP_R_DIV_NUM);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_EQUAL)
+        {
+            REGISTER_QUICKEN_BINARY(ValueEqual, OP_R_EQUAL_NUM);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_GREATER)
+        {
+            REGISTER_QUICKEN_BINARY(ValueGreater, OP_R_GREATER_NUM);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_LESS)
+        {
+            REGISTER_QUICKEN_BINARY(ValueLess, OP_R_LESS_NUM);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_NOT)
+        {
+            auto dst = READ_U8();
+            registers[dst] = ValueLogicNot(READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_MINUS)
+        {
+            auto dst = READ_U8();
+            Value ret;
+            ValueMinus(READ_REGISTER(), ret);
+            registers[dst] = ret;
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_AND)
+        {
+            auto dst = READ_U8();
+            auto &l = READ_REGISTER();
+            auto &r = READ_REGISTER();
+            registers[dst] = ValueLogicAnd(l, r);
+            VM_NEXT();
         }
+        VM_CASE(OP_R_OR)
+        {
+            auto dst = READ_U8();
+            auto &l = READ_REGISTER();
+            auto &r = READ_REGISTER();
+            registers[dst] = ValueLogicOr(l, r);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_BIT_AND)
+        {
+            REGISTER_BIT_BINARY(&, ValueBitAnd);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_BIT_OR)
+        {
+            REGISTER_BIT_BINARY(|, ValueBitOr);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_BIT_NOT)
+        {
+            auto dst = READ_U8();
+            auto &value = READ_REGISTER();
+            if (IS_INT_VALUE(value))
+                registers[dst] = ~TO_INT_VALUE(value);
+            else
+                registers[dst] = ValueBitNot(value);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_BIT_XOR)
+        {
+            REGISTER_BIT_BINARY(^, ValueBitXor);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_ADD_CONSTANT)
+        {
+            REGISTER_QUICKEN_ARITHMETIC(ValueAdd, OP_R_ADD_CONSTANT_NUM, READ_CONSTANT());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_SUB_CONSTANT)
+        {
+            REGISTER_QUICKEN_ARITHMETIC(ValueSub, OP_R_SUB_CONSTANT_NUM, READ_CONSTANT());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_MUL_CONSTANT)
+        {
+            REGISTER_QUICKEN_ARITHMETIC(ValueMul, OP_R_MUL_CONSTANT_NUM, READ_CONSTANT());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP)
+        {
+            auto opcodeAddr = ip - 1;
+            READ_JUMP_OPERANDS();
+            ip = opcodeAddr + offset;
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_FALSE)
+        {
+            auto opcodeAddr = ip - 1;
+            auto &value = READ_REGISTER();
+            READ_JUMP_OPERANDS();
+            if (!IS_BOOL_VALUE(value))
+                ASSERT("The if condition not a boolean value");
+            if (!TO_BOOL_VALUE(value))
+                ip = opcodeAddr + offset;
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_DEF_GLOBAL)
+        {
+            auto index = READ_U8();
+            globals[index] = READ_REGISTER();
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_SET_GLOBAL)
+        {
+            auto index = READ_U8();
+            SetValue(globals + index, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_GET_GLOBAL)
+        {
+            auto dst = READ_U8();
+            registers[dst] = globals[READ_U8()];
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_SET_LOCAL)
+        {
+            auto dst = READ_U8();
+            SetValue(registers + dst, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_GET_UPVALUE)
+        {
+            auto dst = READ_U8();
+            registers[dst] = *frame->closure->upvalues[READ_U8()]->location;
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_SET_UPVALUE)
+        {
+            auto index = READ_U8();
+            SetValue(frame->closure->upvalues[index]->location, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_ARRAY)
+        {
+            auto dst = READ_U8();
+            auto first = registers + READ_U8();
+            auto numElements = READ_U16();
+            Value *elements = new Value[numElements];
+            std::copy(first, first + numElements, elements);
+            auto array = ALLOCATE_OBJECT(ArrayObject, elements, numElements);
+            registers[dst] = array;
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_GET_INDEX)
+        {
+            auto dst = READ_U8();
+            auto &ds = READ_REGISTER();
+            auto &index = READ_REGISTER();
+            Value ret;
+            GetArrayObjectElement(ds, index, ret);
+            registers[dst] = ret;
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_SET_INDEX)
+        {
+            auto &ds = READ_REGISTER();
+            auto &index = READ_REGISTER();
+            auto &v = READ_REGISTER();
+            if (IS_ARRAY_VALUE(ds) && IS_NUM_VALUE(index))
+            {
+                auto array = TO_ARRAY_VALUE(ds);
+                auto i = IS_INT_VALUE(index) ? TO_INT_VALUE(index) : (int64_t)TO_DOUBLE_VALUE(index);
+                if (i < 0 || static_cast<size_t>(i) >= array->len)
+                    ASSERT("Invalid index:%ld outside of array's size:%ld", i, array->len)
+                else
+                    SetValue(&array->elements[i], v);
+            }
+            else
+                ASSERT("Invalid index op: %s[%s]", ds.Stringify().c_str(), index.Stringify().c_str());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_CLOSURE)
+        {
+            auto dst = READ_U8();
+            auto function = TO_FUNCTION_VALUE(READ_CONSTANT());
+            auto upvalueCount = READ_U8();
+
+            UpvalueObject *upvalues[UPVALUE_COUNT];
+            for (uint8_t i = 0; i < upvalueCount; ++i)
+            {
+                auto index = READ_U8();
+                auto scopeDepth = READ_U8();
+                upvalues[i] = Allocator::GetInstance()->CaptureUpvalue(index, scopeDepth);
+            }
+
+            auto closure = ALLOCATE_CLOSURE_OBJECT(function, upvalues, upvalueCount);
+            registers[dst] = closure;
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_FUNCTION_CALL)
+        {
+            auto base = READ_U8();
+            auto argCount = READ_U8();
+            REGISTER_CALL_VALUE(base, argCount);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_TAIL_CALL)
+        {
+            auto base = READ_U8();
+            auto argCount = READ_U8();
+
+            auto value = registers[base];
+            if (IS_CLOSURE_VALUE(value))
+            {
+                auto closure = TO_CLOSURE_VALUE(value);
+
+                if (argCount != closure->function->parameterCount)
+                    ASSERT("Non matching function parameters for calling arguments,parameter count:%d,argument count:%d", closure->function->parameterCount, argCount);
+
+                Allocator::GetInstance()->ClosedUpvalues(frame->slot);
+
+                // move the callee and its arguments down to the window of the current frame and reuse it
+                memmove(frame->slot - 1, registers + base, sizeof(Value) * (argCount + 1));
+                *frame = CallFrame(closure, frame->slot);
+                LOAD_FRAME();
+                LOAD_REGISTERS();
+                CLEAR_REGISTERS(registers + argCount);
+            }
+            else
+            {
+                // a builtin callee,call as usual and the following OP_R_RETURN returns the result
+                REGISTER_CALL_VALUE(base, argCount);
+            }
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_GET_BUILTIN)
+        {
+            auto opcodeAddr = ip - 1;
+            auto dst = READ_U8();
+            auto name = TO_STR_VALUE(READ_CONSTANT());
+            auto index = BuiltinManager::GetInstance()->FindBuiltinIndex(name);
+            if (index < 0)
+                ASSERT("No builtin object:%s", ObjectStringify(name).c_str());
+            if (index <= UINT16_MAX)
+            {
+                EncodeOperand<uint16_t>(opcodeAddr + 2, static_cast<uint16_t>(index));
+                QUICKEN(opcodeAddr, OP_R_GET_BUILTIN_INDEX);
+            }
+            registers[dst] = BuiltinManager::GetInstance()->GetBuiltinObject(index);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_STRUCT)
+        {
+            auto dst = READ_U8();
+            auto first = registers + READ_U8();
+            auto memberCount = READ_U16();
+            auto names = ip;
+            ip += memberCount * sizeof(uint16_t);
+
+            StructObject *structInstance = nullptr;
+            if (memberCount <= SHAPE_MAX_FIELD_COUNT)
+            {
+                Shape *shape = Shape::GetRoot();
+                Value fields[SHAPE_MAX_FIELD_COUNT];
+                for (uint16_t i = 0; i < memberCount; ++i)
+                {
+                    auto name = TO_STR_VALUE(constants[DecodeOperand<uint16_t>(names + i * sizeof(uint16_t))]);
+                    shape = shape->Transition(name);
+                    fields[shape->FindSlot(name)] = first[i];
+                }
+                structInstance = ALLOCATE_STRUCT_OBJECT(shape, fields);
+            }
+            else
+            {
+                // set in the same order as OP_STRUCT
+                HashTable *members = new HashTable();
+                for (int32_t i = memberCount - 1; i >= 0; --i)
+                    members->Set(TO_STR_VALUE(constants[DecodeOperand<uint16_t>(names + i * sizeof(uint16_t))]), first[i]);
+                structInstance = ALLOCATE_OBJECT(StructObject, members);
+            }
+
+            registers[dst] = structInstance;
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_NEW_STRUCT)
+        {
+            auto dst = READ_U8();
+            auto prototype = TO_STRUCT_VALUE(READ_CONSTANT());
+            auto structInstance = ALLOCATE_STRUCT_OBJECT(prototype->shape, prototype->fields);
+            registers[dst] = structInstance;
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_GET_STRUCT)
+        {
+            auto dst = READ_U8();
+            Value instance;
+            GetEndOfRefValue(READ_REGISTER(), instance);
+            auto memberName = READ_CONSTANT();
+            auto cacheIdx = READ_U16();
+
+            auto structInstance = TO_STRUCT_VALUE(instance);
+
+            Value *value = GetStructMember(structInstance, TO_STR_VALUE(memberName), frame->closure->function->chunk.inlineCaches[cacheIdx]);
+            if (!value)
+                ASSERT("no member named:(%s) in struct instance:%s", memberName.Stringify().c_str(), instance.Stringify().c_str());
+            registers[dst] = *value;
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_SET_STRUCT)
+        {
+            Value instance;
+            GetEndOfRefValue(READ_REGISTER(), instance);
+            auto memberName = READ_CONSTANT();
+            auto cacheIdx = READ_U16();
+            auto &value = READ_REGISTER();
+
+            auto structInstance = TO_STRUCT_VALUE(instance);
+
+            Value *structMember = GetStructMember(structInstance, TO_STR_VALUE(memberName), frame->closure->function->chunk.inlineCaches[cacheIdx]);
+            if (!structMember)
+                ASSERT("no member named:(%s) in struct instance:(0x%s)", memberName.Stringify().c_str(), PointerAddressToString(structInstance).c_str());
+            SetValue(structMember, value);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_REF_GLOBAL)
+        {
+            auto dst = READ_U8();
+            auto ref = ALLOCATE_OBJECT(RefObject, GetEndOfRefValuePtr(globals + READ_U8()));
+            registers[dst] = ref;
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_REF_LOCAL)
+        {
+            auto dst = READ_U8();
+            auto ref = ALLOCATE_OBJECT(RefObject, GetEndOfRefValuePtr(registers + READ_U8()));
+            registers[dst] = ref;
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_REF_UPVALUE)
+        {
+            auto dst = READ_U8();
+            auto ref = ALLOCATE_OBJECT(RefObject, GetEndOfRefValuePtr(frame->closure->upvalues[READ_U8()]->location));
+            registers[dst] = ref;
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_REF_INDEX_GLOBAL)
+        {
+            auto dst = READ_U8();
+            auto ptr = GetEndOfRefValuePtr(globals + READ_U8());
+            auto ref = ALLOCATE_INDEX_REF_OBJECT(ptr, READ_REGISTER());
+            registers[dst] = ref;
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_REF_INDEX_LOCAL)
+        {
+            auto dst = READ_U8();
+            auto ptr = GetEndOfRefValuePtr(registers + READ_U8());
+            auto ref = ALLOCATE_INDEX_REF_OBJECT(ptr, READ_REGISTER());
+            registers[dst] = ref;
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_REF_INDEX_UPVALUE)
+        {
+            auto dst = READ_U8();
+            auto ptr = GetEndOfRefValuePtr(frame->closure->upvalues[READ_U8()]->location);
+            auto ref = ALLOCATE_INDEX_REF_OBJECT(ptr, READ_REGISTER());
+            registers[dst] = ref;
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_STACK_REF_GLOBAL)
+        {
+            auto dst = READ_U8();
+            registers[dst] = ALLOCATE_STACK_REF_OBJECT(GetEndOfRefValuePtr(globals + READ_U8()));
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_STACK_REF_LOCAL)
+        {
+            auto dst = READ_U8();
+            registers[dst] = ALLOCATE_STACK_REF_OBJECT(GetEndOfRefValuePtr(registers + READ_U8()));
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_STACK_REF_UPVALUE)
+        {
+            auto dst = READ_U8();
+            registers[dst] = ALLOCATE_STACK_REF_OBJECT(GetEndOfRefValuePtr(frame->closure->upvalues[READ_U8()]->location));
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_STACK_REF_INDEX_GLOBAL)
+        {
+            auto dst = READ_U8();
+            auto ptr = GetEndOfRefValuePtr(globals + READ_U8());
+            registers[dst] = ALLOCATE_STACK_INDEX_REF_OBJECT(ptr, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_STACK_REF_INDEX_LOCAL)
+        {
+            auto dst = READ_U8();
+            auto ptr = GetEndOfRefValuePtr(registers + READ_U8());
+            registers[dst] = ALLOCATE_STACK_INDEX_REF_OBJECT(ptr, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_STACK_REF_INDEX_UPVALUE)
+        {
+            auto dst = READ_U8();
+            auto ptr = GetEndOfRefValuePtr(frame->closure->upvalues[READ_U8()]->location);
+            registers[dst] = ALLOCATE_STACK_INDEX_REF_OBJECT(ptr, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_STACK_REF_CALL)
+        {
+            auto base = READ_U8();
+            auto argCount = READ_U8();
+            auto callee = registers[base];
+            for (uint8_t i = 0; i < argCount; ++i)
+            {
+                // builtin functions may keep any argument
+                Value &arg = registers[base + 1 + i];
+                if (IS_REF_VALUE(arg) && IS_STACK_REF_OBJECT(TO_REF_VALUE(arg)) &&
+                    (!IS_CLOSURE_VALUE(callee) || TO_CLOSURE_VALUE(callee)->function->IsParamEscaping(i)))
+                    arg = ALLOCATE_OBJECT(RefObject, TO_REF_VALUE(arg)->pointer);
+            }
+            REGISTER_CALL_VALUE(base, argCount);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_RELEASE_STACK_REFS)
+        {
+            auto base = READ_U8();
+            auto argCount = READ_U8();
+            RELEASE_STACK_REF_OBJECTS(READ_U8());
+            // the released refs must not stay reachable from the registers the gc scans
+            std::fill(registers + base + 1, registers + base + 1 + argCount, Value());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_CONCAT)
+        {
+            auto dst = READ_U8();
+            auto first = registers + READ_U8();
+            auto count = READ_U8();
+            Value ret;
+            ValueConcat(first, count, ret);
+            registers[dst] = ret;
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_DLL_IMPORT)
+        {
+            auto name = TO_STR_VALUE(READ_CONSTANT())->value;
+            Allocator::GetInstance()->DisableGC();
+            RegisterDLLs(name);
+            Allocator::GetInstance()->EnableGC();
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_INC_LOCAL)
+        {
+            auto opcodeAddr = ip - 1;
+            auto &slot = READ_REGISTER();
+            auto &constant = READ_CONSTANT();
+            if (IS_NUM_VALUE(slot) && IS_NUM_VALUE(constant))
+                QUICKEN(opcodeAddr, OP_R_INC_LOCAL_NUM);
+            Value ret;
+            ValueAdd(slot, constant, ret);
+            SetValue(&slot, ret);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_INC_GLOBAL)
+        {
+            auto opcodeAddr = ip - 1;
+            auto &slot = globals[READ_U8()];
+            auto &constant = READ_CONSTANT();
+            if (IS_NUM_VALUE(slot) && IS_NUM_VALUE(constant))
+                QUICKEN(opcodeAddr, OP_R_INC_GLOBAL_NUM);
+            Value ret;
+            ValueAdd(slot, constant, ret);
+            SetValue(&slot, ret);
+            VM_NEXT();
+        }
+        // the compare jumps branch when the comparison holds,the compiler picks the negated one for a condition
+        VM_CASE(OP_R_JUMP_IF_LESS)
+        {
+            REGISTER_COMPARE_JUMP(ValueLess(l, r), OP_R_JUMP_IF_LESS_NUM, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_GREATER)
+        {
+            REGISTER_COMPARE_JUMP(ValueGreater(l, r), OP_R_JUMP_IF_GREATER_NUM, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_EQUAL)
+        {
+            REGISTER_COMPARE_JUMP(ValueEqual(l, r), OP_R_JUMP_IF_EQUAL_NUM, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_NOT_LESS)
+        {
+            REGISTER_COMPARE_JUMP(!ValueLess(l, r), OP_R_JUMP_IF_NOT_LESS_NUM, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_NOT_GREATER)
+        {
+            REGISTER_COMPARE_JUMP(!ValueGreater(l, r), OP_R_JUMP_IF_NOT_GREATER_NUM, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_NOT_EQUAL)
+        {
+            REGISTER_COMPARE_JUMP(!ValueEqual(l, r), OP_R_JUMP_IF_NOT_EQUAL_NUM, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_LESS_CONSTANT)
+        {
+            REGISTER_COMPARE_JUMP(ValueLess(l, r), OP_R_JUMP_IF_LESS_CONSTANT_NUM, READ_CONSTANT());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_GREATER_CONSTANT)
+        {
+            REGISTER_COMPARE_JUMP(ValueGreater(l, r), OP_R_JUMP_IF_GREATER_CONSTANT_NUM, READ_CONSTANT());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_EQUAL_CONSTANT)
+        {
+            REGISTER_COMPARE_JUMP(ValueEqual(l, r), OP_R_JUMP_IF_EQUAL_CONSTANT_NUM, READ_CONSTANT());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_NOT_LESS_CONSTANT)
+        {
+            REGISTER_COMPARE_JUMP(!ValueLess(l, r), OP_R_JUMP_IF_NOT_LESS_CONSTANT_NUM, READ_CONSTANT());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_NOT_GREATER_CONSTANT)
+        {
+            REGISTER_COMPARE_JUMP(!ValueGreater(l, r), OP_R_JUMP_IF_NOT_GREATER_CONSTANT_NUM, READ_CONSTANT());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_NOT_EQUAL_CONSTANT)
+        {
+            REGISTER_COMPARE_JUMP(!ValueEqual(l, r), OP_R_JUMP_IF_NOT_EQUAL_CONSTANT_NUM, READ_CONSTANT());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_ADD_NUM)
+        {
+            REGISTER_ARITHMETIC_NUM(IntAdd, +, OP_R_ADD, sizeof(uint8_t), registers[ip[2]]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_SUB_NUM)
+        {
+            REGISTER_ARITHMETIC_NUM(IntSub, -, OP_R_SUB, sizeof(uint8_t), registers[ip[2]]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_MUL_NUM)
+        {
+            REGISTER_ARITHMETIC_NUM(IntMul, *, OP_R_MUL, sizeof(uint8_t), registers[ip[2]]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_DIV_NUM)
+        {
+            auto opcodeAddr = ip - 1;
+            auto &l = registers[ip[1]];
+            auto &r = registers[ip[2]];
+            if (IS_NUM_VALUE(l) && IS_NUM_VALUE(r))
+            {
+                registers[ip[0]] = TO_NUM_VALUE(l) / TO_NUM_VALUE(r);
+                ip += 3;
+            }
+            else
+                DEOPTIMIZE(opcodeAddr, OP_R_DIV);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_GREATER_NUM)
+        {
+            REGISTER_COMPARE_NUM(>, OP_R_GREATER);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_LESS_NUM)
+        {
+            REGISTER_COMPARE_NUM(<, OP_R_LESS);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_EQUAL_NUM)
+        {
+            REGISTER_COMPARE_NUM(==, OP_R_EQUAL);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_ADD_CONSTANT_NUM)
+        {
+            REGISTER_ARITHMETIC_NUM(IntAdd, +, OP_R_ADD_CONSTANT, sizeof(uint16_t), constants[DecodeOperand<uint16_t>(ip + 2)]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_SUB_CONSTANT_NUM)
+        {
+            REGISTER_ARITHMETIC_NUM(IntSub, -, OP_R_SUB_CONSTANT, sizeof(uint16_t), constants[DecodeOperand<uint16_t>(ip + 2)]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_MUL_CONSTANT_NUM)
+        {
+            REGISTER_ARITHMETIC_NUM(IntMul, *, OP_R_MUL_CONSTANT, sizeof(uint16_t), constants[DecodeOperand<uint16_t>(ip + 2)]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_INC_LOCAL_NUM)
+        {
+            auto opcodeAddr = ip - 1;
+            auto &slot = READ_REGISTER();
+            auto &constant = READ_CONSTANT();
+            if (IS_INT_VALUE(slot) && IS_INT_VALUE(constant))
+                slot = IntAdd(TO_INT_VALUE(slot), TO_INT_VALUE(constant));
+            else if (IS_NUM_VALUE(slot) && IS_NUM_VALUE(constant))
+                slot = TO_NUM_VALUE(slot) + TO_NUM_VALUE(constant);
+            else
+                DEOPTIMIZE(opcodeAddr, OP_R_INC_LOCAL);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_INC_GLOBAL_NUM)
+        {
+            auto opcodeAddr = ip - 1;
+            auto &slot = globals[READ_U8()];
+            auto &constant = READ_CONSTANT();
+            if (IS_INT_VALUE(slot) && IS_INT_VALUE(constant))
+                slot = IntAdd(TO_INT_VALUE(slot), TO_INT_VALUE(constant));
+            else if (IS_NUM_VALUE(slot) && IS_NUM_VALUE(constant))
+                slot = TO_NUM_VALUE(slot) + TO_NUM_VALUE(constant);
+            else
+                DEOPTIMIZE(opcodeAddr, OP_R_INC_GLOBAL);
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_LESS_NUM)
+        {
+            REGISTER_COMPARE_JUMP_NUM(l < r, OP_R_JUMP_IF_LESS, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_GREATER_NUM)
+        {
+            REGISTER_COMPARE_JUMP_NUM(l > r, OP_R_JUMP_IF_GREATER, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_EQUAL_NUM)
+        {
+            REGISTER_COMPARE_JUMP_NUM(l == r, OP_R_JUMP_IF_EQUAL, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_NOT_LESS_NUM)
+        {
+            REGISTER_COMPARE_JUMP_NUM(!(l < r), OP_R_JUMP_IF_NOT_LESS, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_NOT_GREATER_NUM)
+        {
+            REGISTER_COMPARE_JUMP_NUM(!(l > r), OP_R_JUMP_IF_NOT_GREATER, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_NOT_EQUAL_NUM)
+        {
+            REGISTER_COMPARE_JUMP_NUM(!(l == r), OP_R_JUMP_IF_NOT_EQUAL, READ_REGISTER());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_LESS_CONSTANT_NUM)
+        {
+            REGISTER_COMPARE_JUMP_NUM(l < r, OP_R_JUMP_IF_LESS_CONSTANT, READ_CONSTANT());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_GREATER_CONSTANT_NUM)
+        {
+            REGISTER_COMPARE_JUMP_NUM(l > r, OP_R_JUMP_IF_GREATER_CONSTANT, READ_CONSTANT());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_EQUAL_CONSTANT_NUM)
+        {
+            REGISTER_COMPARE_JUMP_NUM(l == r, OP_R_JUMP_IF_EQUAL_CONSTANT, READ_CONSTANT());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_NOT_LESS_CONSTANT_NUM)
+        {
+            REGISTER_COMPARE_JUMP_NUM(!(l < r), OP_R_JUMP_IF_NOT_LESS_CONSTANT, READ_CONSTANT());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_NOT_GREATER_CONSTANT_NUM)
+        {
+            REGISTER_COMPARE_JUMP_NUM(!(l > r), OP_R_JUMP_IF_NOT_GREATER_CONSTANT, READ_CONSTANT());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_JUMP_IF_NOT_EQUAL_CONSTANT_NUM)
+        {
+            REGISTER_COMPARE_JUMP_NUM(!(l == r), OP_R_JUMP_IF_NOT_EQUAL_CONSTANT, READ_CONSTANT());
+            VM_NEXT();
+        }
+        VM_CASE(OP_R_GET_BUILTIN_INDEX)
+        {
+            auto dst = READ_U8();
+            registers[dst] = BuiltinManager::GetInstance()->GetBuiltinObject(READ_U16());
+            VM_NEXT();
+        }
+#ifndef VM_USE_COMPUTED_GOTO
+        default:
+            return;
+#endif
     }
 }
 
+#undef REGISTER_CALL_VALUE
+#undef READ_CONSTANT
+#undef READ_REGISTER
+#undef REGISTER_COMPARE_JUMP_NUM
+#undef REGISTER_COMPARE_JUMP
+#undef REGISTER_BIT_BINARY
+#undef REGISTER_COMPARE_NUM
+#undef REGISTER_ARITHMETIC_NUM
+#undef REGISTER_QUICKEN_ARITHMETIC
+#undef REGISTER_QUICKEN_BINARY
+#undef CLEAR_REGISTERS
+#undef LOAD_REGISTERS
+#undef CALL_VALUE
+#undef RUN_JIT
+#undef COMPARE_JUMP_NUM
+#undef COMPARE_JUMP
+#undef READ_JUMP_OPERANDS
+#undef BINARY_NUM
+#undef BIT_BINARY
+#undef COMPARE_NUM
+#undef ARITHMETIC_NUM
+#undef QUICKEN_ARITHMETIC
+#undef QUICKEN_BINARY
+#undef DEOPTIMIZE
+#undef QUICKEN
+#undef BINARY
+#undef VM_NEXT
+#undef VM_CASE
+#undef VM_DISPATCH
+#undef LOAD_FRAME
+#undef SAVE_FRAME
+#undef LOAD_STACK_TOP
+#undef SAVE_STACK_TOP
+#undef VM_POP
+#undef VM_PUSH
+#undef READ_OPCODE
+#undef READ_U8
+#undef READ_U16
+#undef READ_I32
+
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
 void VM::RunJit(const CallFrame &frame)
 {
@@ -560,6 +2268,8 @@ void VM::RunJit(const CallFrame &frame)
             ExecuteJitFunction<void>(frame, fnName);
 
         Allocator::GetInstance()->EnableGC();
+        // jit compiled code stores values without the write barrier
+        Allocator::GetInstance()->RequestMajorGc();
     }
 }
 
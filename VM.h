@@ -25,6 +25,14 @@ public:
     void Run(FunctionObject *fn);
 private:
     void Execute();
+    // the loop of register-based bytecode(-r/--register)
+    void ExecuteRegister();
+
+    // member lookup through the inline cache of the accessing instruction
+    Value *GetStructMember(StructObject *instance, StrObject *name, StructInlineCache &cache);
+
+    uint64_t m_InlineCacheHitCount{0};
+    uint64_t m_InlineCacheMissCount{0};
 
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
     void RunJit(const struct CallFrame& frame);
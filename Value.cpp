@@ -1,16 +1,20 @@
 #include "Value.h"
 #include "Object.h"
+#include "Allocator.h"
 
 std::string Value::Stringify() const
 {
-    switch (type)
+    switch (GET_VALUE_TYPE(*this))
     {
     case ValueType::NUM:
-        return std::to_string(stored);
+        return std::to_string(TO_DOUBLE_VALUE(*this));
+    case ValueType::INT:
+        // same format as a double so integers print the way numbers always have
+        return std::to_string(TO_INT_VALUE(*this)) + ".000000";
     case ValueType::BOOL:
-        return stored == 1.0 ? "true" : "false";
+        return TO_BOOL_VALUE(*this) ? "true" : "false";
     case ValueType::OBJECT:
-        return ObjectStringify(object);
+        return ObjectStringify(TO_OBJECT_VALUE(*this));
     case ValueType::NIL:
     default:
         return "nil";
@@ -19,29 +23,34 @@ std::string Value::Stringify() const
 
 void Value::Mark() const
 {
-    if (type == ValueType::OBJECT)
-        MarkObject(object);
+    if (IS_OBJECT_VALUE(*this))
+        MarkObject(TO_OBJECT_VALUE(*this));
 }
 void Value::UnMark() const
 {
-    if (type == ValueType::OBJECT)
-        UnMarkObject(object);
+    if (IS_OBJECT_VALUE(*this))
+        UnMarkObject(TO_OBJECT_VALUE(*this));
 }
 
 bool operator==(const Value &left, const Value &right)
 {
-    if (left.type != right.type)
+    if (IS_INT_VALUE(left) && IS_INT_VALUE(right))
+        return TO_INT_VALUE(left) == TO_INT_VALUE(right);
+    if (IS_NUM_VALUE(left) && IS_NUM_VALUE(right))
+        return TO_NUM_VALUE(left) == TO_NUM_VALUE(right);
+
+    auto type = GET_VALUE_TYPE(left);
+    if (type != GET_VALUE_TYPE(right))
         return false;
 
-    switch (left.type)
+    switch (type)
     {
     case ValueType::NIL:
-        return IS_NIL_VALUE(right);
-    case ValueType::NUM:
+        return true;
     case ValueType::BOOL:
-        return left.stored == TO_NUM_VALUE(right);
+        return TO_BOOL_VALUE(left) == TO_BOOL_VALUE(right);
     case ValueType::OBJECT:
-        return IsObjectEqual(left.object, TO_OBJECT_VALUE(right));
+        return IsObjectEqual(TO_OBJECT_VALUE(left), TO_OBJECT_VALUE(right));
     default:
         return false;
     }
@@ -79,9 +88,10 @@ void SetValue(Value* slot,const Value& value)
     if(!IS_REF_VALUE(value) && IS_REF_VALUE(*slot))
         slot = GetEndOfRefValuePtr(slot);
     *slot = value;
+    Allocator::GetInstance()->WriteBarrier(slot, value);
 }
 
-//  - * /
+// /
 #define COMMON_BINARY(l, op, r)                                                                               \
     do                                                                                                        \
     {                                                                                                         \
@@ -94,6 +104,21 @@ void SetValue(Value* slot,const Value& value)
             ASSERT("Invalid binary op:%s %s %s", left.Stringify().c_str(), (#op), right.Stringify().c_str()); \
     } while (0);
 
+// + - *,integers stay integers unless the result overflows
+#define ARITHMETIC_BINARY(l, op, intOp, r, result)                                                            \
+    do                                                                                                        \
+    {                                                                                                         \
+        Value left, right;                                                                                    \
+        FindActualValue(l, left);                                                                             \
+        FindActualValue(r, right);                                                                            \
+        if (IS_INT_VALUE(right) && IS_INT_VALUE(left))                                                        \
+            result = intOp(TO_INT_VALUE(left), TO_INT_VALUE(right));                                          \
+        else if (IS_NUM_VALUE(right) && IS_NUM_VALUE(left))                                                   \
+            result = (TO_NUM_VALUE(left) op TO_NUM_VALUE(right));                                             \
+        else                                                                                                  \
+            ASSERT("Invalid binary op:%s %s %s", left.Stringify().c_str(), (#op), right.Stringify().c_str()); \
+    } while (0);
+
 // > >= < <=
 #define COMPARE_BINARY(l, op, r)                                               \
     do                                                                         \
@@ -101,7 +126,9 @@ void SetValue(Value* slot,const Value& value)
         Value left, right;                                                     \
         FindActualValue(l, left);                                              \
         FindActualValue(r, right);                                             \
-        if (IS_NUM_VALUE(right) && IS_NUM_VALUE(left))                         \
+        if (IS_INT_VALUE(right) && IS_INT_VALUE(left))                         \
+            return (TO_INT_VALUE(left) op TO_INT_VALUE(right) ? true : false); \
+        else if (IS_NUM_VALUE(right) && IS_NUM_VALUE(left))                    \
             return (TO_NUM_VALUE(left) op TO_NUM_VALUE(right) ? true : false); \
         else                                                                   \
             return (false);                                                    \
@@ -120,6 +147,9 @@ void SetValue(Value* slot,const Value& value)
             ASSERT("Invalid op:%s %s %s", left.Stringify().c_str(), (#op), right.Stringify().c_str()); \
     } while (0);
 
+// bit ops always work on integers,a double operand is truncated
+#define TO_BIT_OPERAND(v) (IS_INT_VALUE(v) ? TO_INT_VALUE(v) : (int64_t)TO_DOUBLE_VALUE(v))
+
 #define BIT_BINARY(l, op, r)                                                                           \
     do                                                                                                 \
     {                                                                                                  \
@@ -127,7 +157,7 @@ void SetValue(Value* slot,const Value& value)
         FindActualValue(l, left);                                                                      \
         FindActualValue(r, right);                                                                     \
         if (IS_NUM_VALUE(right) && IS_NUM_VALUE(left))                                                 \
-            return ((uint64_t)TO_NUM_VALUE(left) op(uint64_t) TO_NUM_VALUE(right));                    \
+            return (TO_BIT_OPERAND(left) op TO_BIT_OPERAND(right));                                    \
         else                                                                                           \
             ASSERT("Invalid op:%s %s %s", left.Stringify().c_str(), (#op), right.Stringify().c_str()); \
     } while (0);
@@ -137,7 +167,9 @@ COMPUTEDUCK_API void ValueAdd(const Value &l, const Value &r, Value &result)
     Value left, right;
     FindActualValue(l, left);
     FindActualValue(r, right);
-    if (IS_NUM_VALUE(right) && IS_NUM_VALUE(left))
+    if (IS_INT_VALUE(right) && IS_INT_VALUE(left))
+        result = IntAdd(TO_INT_VALUE(left), TO_INT_VALUE(right));
+    else if (IS_NUM_VALUE(right) && IS_NUM_VALUE(left))
         result = (TO_NUM_VALUE(left) + TO_NUM_VALUE(right));
     else if (IS_STR_VALUE(right) && IS_STR_VALUE(left))
         result = (StrAdd(TO_STR_VALUE(left), TO_STR_VALUE(right)));
@@ -145,14 +177,35 @@ COMPUTEDUCK_API void ValueAdd(const Value &l, const Value &r, Value &result)
         ASSERT("Invalid binary op:%s+%s", left.Stringify().c_str(), right.Stringify().c_str());
 }
 
-COMPUTEDUCK_API double ValueSub(const Value &l, const Value &r)
+COMPUTEDUCK_API void ValueConcat(const Value *operands, uint8_t count, Value &result)
+{
+    StrObject *strs[UINT8_MAX];
+    for (uint8_t i = 0; i < count; ++i)
+    {
+        Value operand;
+        FindActualValue(operands[count - 1 - i], operand);
+        if (!IS_STR_VALUE(operand))
+        {
+            // not a chain of strings,add pair by pair like OP_ADD does
+            result = operands[count - 1];
+            for (int32_t j = count - 2; j >= 0; --j)
+                ValueAdd(result, operands[j], result);
+            return;
+        }
+        strs[i] = TO_STR_VALUE(operand);
+    }
+    // one buffer for the whole chain instead of a new string per +
+    result = StrConcat(strs, count);
+}
+
+COMPUTEDUCK_API void ValueSub(const Value &l, const Value &r, Value &result)
 {
-    COMMON_BINARY(l, -, r);
+    ARITHMETIC_BINARY(l, -, IntSub, r, result);
 }
 
-COMPUTEDUCK_API double ValueMul(const Value &l, const Value &r)
+COMPUTEDUCK_API void ValueMul(const Value &l, const Value &r, Value &result)
 {
-    COMMON_BINARY(l, *, r);
+    ARITHMETIC_BINARY(l, *, IntMul, r, result);
 }
 
 COMPUTEDUCK_API double ValueDiv(const Value &l, const Value &r)
@@ -188,17 +241,17 @@ COMPUTEDUCK_API bool ValueLogicOr(const Value &l, const Value &r)
     LOGIC_BINARY(l, ||, r);
 }
 
-COMPUTEDUCK_API double ValueBitAnd(const Value &l, const Value &r)
+COMPUTEDUCK_API int64_t ValueBitAnd(const Value &l, const Value &r)
 {
     BIT_BINARY(l, &, r);
 }
 
-COMPUTEDUCK_API double ValueBitOr(const Value &l, const Value &r)
+COMPUTEDUCK_API int64_t ValueBitOr(const Value &l, const Value &r)
 {
     BIT_BINARY(l, |, r);
 }
 
-COMPUTEDUCK_API double ValueBitXor(const Value &l, const Value &r)
+COMPUTEDUCK_API int64_t ValueBitXor(const Value &l, const Value &r)
 {
     BIT_BINARY(l, ^, r);
 }
@@ -212,22 +265,25 @@ COMPUTEDUCK_API bool ValueLogicNot(const Value &l)
     return (!TO_BOOL_VALUE(value));
 }
 
-COMPUTEDUCK_API double ValueBitNot(const Value &l)
+COMPUTEDUCK_API int64_t ValueBitNot(const Value &l)
 {
     Value value;
     FindActualValue(l, value);
     if (!IS_NUM_VALUE(value))
         ASSERT("Invalid op:~ %s", value.Stringify().c_str());
-    return (~(uint64_t)TO_NUM_VALUE(value));
+    return (~TO_BIT_OPERAND(value));
 }
 
-COMPUTEDUCK_API double ValueMinus(const Value &l)
+COMPUTEDUCK_API void ValueMinus(const Value &l, Value &result)
 {
     Value value;
     FindActualValue(l, value);
-    if (!IS_NUM_VALUE(value))
+    if (IS_INT_VALUE(value))
+        result = IntNeg(TO_INT_VALUE(value));
+    else if (IS_NUM_VALUE(value))
+        result = (-TO_DOUBLE_VALUE(value));
+    else
         ASSERT("Invalid op:'-' %s", value.Stringify().c_str());
-    return (-TO_NUM_VALUE(value));
 }
 
 COMPUTEDUCK_API void GetArrayObjectElement(const Value &ds, const Value &index, Value &result)
@@ -235,8 +291,8 @@ COMPUTEDUCK_API void GetArrayObjectElement(const Value &ds, const Value &index,
     if (IS_ARRAY_VALUE(ds) && IS_NUM_VALUE(index))
     {
         auto array = TO_ARRAY_VALUE(ds);
-        auto i = (size_t)TO_NUM_VALUE(index);
-        if (!(i < 0 || i >= array->len))
+        auto i = IS_INT_VALUE(index) ? TO_INT_VALUE(index) : (int64_t)TO_DOUBLE_VALUE(index);
+        if (!(i < 0 || static_cast<size_t>(i) >= array->len))
             result = array->elements[i];
     }
     else
@@ -2,62 +2,252 @@
 #include <string>
 #include <type_traits>
 #include <cfloat>
+#include <bit>
+#include <cstdint>
 #include "Utils.h"
 
+// integers keep 48 bits in both value representations,so a script prints the same in both,
+// in this range integer arithmetic gives the exact double result,a larger integer is stored as double
+#define VALUE_INT_MAX (((int64_t)1 << 47) - 1)
+#define VALUE_INT_MIN (-((int64_t)1 << 47))
+
+#ifdef COMPUTEDUCK_BUILD_WITH_NAN_BOXING
+// nan boxing:any double that is not a quiet nan with the tag bits set is a number,
+// nil/false/true live in the low bits of the quiet nan,objects set the sign bit and keep the 48-bit pointer in the low bits
+#define NAN_BOXING_SIGN_BIT ((uint64_t)0x8000000000000000)
+#define NAN_BOXING_QNAN ((uint64_t)0x7ffc000000000000)
+#define NAN_BOXING_OBJECT_MASK (NAN_BOXING_SIGN_BIT | NAN_BOXING_QNAN)
+#define NAN_BOXING_TAG_NIL 1
+#define NAN_BOXING_TAG_FALSE 2
+#define NAN_BOXING_TAG_TRUE 3
+#define NAN_BOXING_NIL_BITS ((uint64_t)(NAN_BOXING_QNAN | NAN_BOXING_TAG_NIL))
+#define NAN_BOXING_FALSE_BITS ((uint64_t)(NAN_BOXING_QNAN | NAN_BOXING_TAG_FALSE))
+#define NAN_BOXING_TRUE_BITS ((uint64_t)(NAN_BOXING_QNAN | NAN_BOXING_TAG_TRUE))
+// integers set bit 49 of the quiet nan and keep a 48-bit two's complement payload
+#define NAN_BOXING_INT_TAG ((uint64_t)0x0002000000000000)
+#define NAN_BOXING_INT_BITS (NAN_BOXING_QNAN | NAN_BOXING_INT_TAG)
+#define NAN_BOXING_INT_PAYLOAD_MASK ((uint64_t)0x0000ffffffffffff)
+
+#define IS_NIL_VALUE(v) ((v).bits == NAN_BOXING_NIL_BITS)
+#define IS_DOUBLE_VALUE(v) (((v).bits & NAN_BOXING_QNAN) != NAN_BOXING_QNAN)
+#define IS_INT_VALUE(v) (((v).bits & (NAN_BOXING_OBJECT_MASK | NAN_BOXING_INT_TAG)) == NAN_BOXING_INT_BITS)
+#define IS_BOOL_VALUE(v) (((v).bits | 1) == NAN_BOXING_TRUE_BITS)
+#define IS_OBJECT_VALUE(v) (((v).bits & NAN_BOXING_OBJECT_MASK) == NAN_BOXING_OBJECT_MASK)
+
+#define TO_DOUBLE_VALUE(v) (std::bit_cast<double>((v).bits))
+#define TO_INT_VALUE(v) (((int64_t)((v).bits << 16)) >> 16)
+#define TO_BOOL_VALUE(v) ((v).bits == NAN_BOXING_TRUE_BITS)
+#define TO_OBJECT_VALUE(v) ((struct Object *)(uintptr_t)((v).bits & ~NAN_BOXING_OBJECT_MASK))
+#else
 #define IS_NIL_VALUE(v) ((v).type == ValueType::NIL)
-#define IS_NUM_VALUE(v) ((v).type == ValueType::NUM)
+#define IS_DOUBLE_VALUE(v) ((v).type == ValueType::NUM)
+#define IS_INT_VALUE(v) ((v).type == ValueType::INT)
 #define IS_BOOL_VALUE(v) ((v).type == ValueType::BOOL)
 #define IS_OBJECT_VALUE(v) ((v).type == ValueType::OBJECT)
-#define IS_STR_VALUE(v) (IS_OBJECT_VALUE(v) && IS_STR_OBJ((v).object))
-#define IS_ARRAY_VALUE(v) (IS_OBJECT_VALUE(v) && IS_ARRAY_OBJ((v).object))
-#define IS_REF_VALUE(v) (IS_OBJECT_VALUE(v) && IS_REF_OBJ((v).object))
-#define IS_FUNCTION_VALUE(v) (IS_OBJECT_VALUE(v) && IS_FUNCTION_OBJ((v).object))
-#define IS_CLOSURE_VALUE(v) (IS_OBJECT_VALUE(v) && IS_CLOSURE_OBJ((v).object))
-#define IS_STRUCT_VALUE(v) (IS_OBJECT_VALUE(v) && IS_STRUCT_OBJ((v).object))
-#define IS_BUILTIN_VALUE(v) (IS_OBJECT_VALUE(v) && IS_BUILTIN_OBJ((v).object))
-
-#define TO_NUM_VALUE(v) ((v).stored)
+
+#define TO_DOUBLE_VALUE(v) ((v).stored)
+#define TO_INT_VALUE(v) ((v).integer)
 #define TO_BOOL_VALUE(v) (((v).stored >= DBL_EPSILON) ? true : false)
 #define TO_OBJECT_VALUE(v) ((v).object)
-#define TO_STR_VALUE(v) (TO_STR_OBJ((v).object))
-#define TO_ARRAY_VALUE(v) (TO_ARRAY_OBJ((v).object))
-#define TO_REF_VALUE(v) (TO_REF_OBJ((v).object))
-#define TO_FUNCTION_VALUE(v) (TO_FUNCTION_OBJ((v).object))
-#define TO_CLOSURE_VALUE(v) (TO_CLOSURE_OBJ((v).object))
-#define TO_STRUCT_VALUE(v) (TO_STRUCT_OBJ((v).object))
-#define TO_BUILTIN_VALUE(v) (TO_BUILTIN_OBJ((v).object))
+#endif
+
+// a number is either a double or an integer,TO_NUM_VALUE reads both as double
+#define IS_NUM_VALUE(v) (IS_DOUBLE_VALUE(v) || IS_INT_VALUE(v))
+#define TO_NUM_VALUE(v) (IS_INT_VALUE(v) ? (double)TO_INT_VALUE(v) : TO_DOUBLE_VALUE(v))
 
+#define IS_STR_VALUE(v) (IS_OBJECT_VALUE(v) && IS_STR_OBJ(TO_OBJECT_VALUE(v)))
+#define IS_ARRAY_VALUE(v) (IS_OBJECT_VALUE(v) && IS_ARRAY_OBJ(TO_OBJECT_VALUE(v)))
+#define IS_REF_VALUE(v) (IS_OBJECT_VALUE(v) && IS_REF_OBJ(TO_OBJECT_VALUE(v)))
+#define IS_FUNCTION_VALUE(v) (IS_OBJECT_VALUE(v) && IS_FUNCTION_OBJ(TO_OBJECT_VALUE(v)))
+#define IS_CLOSURE_VALUE(v) (IS_OBJECT_VALUE(v) && IS_CLOSURE_OBJ(TO_OBJECT_VALUE(v)))
+#define IS_STRUCT_VALUE(v) (IS_OBJECT_VALUE(v) && IS_STRUCT_OBJ(TO_OBJECT_VALUE(v)))
+#define IS_BUILTIN_VALUE(v) (IS_OBJECT_VALUE(v) && IS_BUILTIN_OBJ(TO_OBJECT_VALUE(v)))
+#define IS_STR_BUILDER_VALUE(v) (IS_OBJECT_VALUE(v) && IS_STR_BUILDER_OBJ(TO_OBJECT_VALUE(v)))
+
+#define TO_STR_VALUE(v) (TO_STR_OBJ(TO_OBJECT_VALUE(v)))
+#define TO_ARRAY_VALUE(v) (TO_ARRAY_OBJ(TO_OBJECT_VALUE(v)))
+#define TO_REF_VALUE(v) (TO_REF_OBJ(TO_OBJECT_VALUE(v)))
+#define TO_FUNCTION_VALUE(v) (TO_FUNCTION_OBJ(TO_OBJECT_VALUE(v)))
+#define TO_CLOSURE_VALUE(v) (TO_CLOSURE_OBJ(TO_OBJECT_VALUE(v)))
+#define TO_STRUCT_VALUE(v) (TO_STRUCT_OBJ(TO_OBJECT_VALUE(v)))
+#define TO_BUILTIN_VALUE(v) (TO_BUILTIN_OBJ(TO_OBJECT_VALUE(v)))
+#define TO_STR_BUILDER_VALUE(v) (TO_STR_BUILDER_OBJ(TO_OBJECT_VALUE(v)))
+
+#define GET_VALUE_TYPE(v) ((v).Type())
+
+// NUM is a double,INT an integer that integer literals and integer arithmetic produce,
+// an integer result that does not fit in [VALUE_INT_MIN,VALUE_INT_MAX] is promoted to NUM
 enum ValueType : uint8_t
 {
     NIL=0,
     NUM,
+    INT,
     BOOL,
     OBJECT
 };
 
 struct COMPUTEDUCK_API Value
 {
+#ifdef COMPUTEDUCK_BUILD_WITH_NAN_BOXING
+    template <typename T>
+        requires(std::is_floating_point_v<T>)
+    Value(T number) : bits(std::bit_cast<uint64_t>(static_cast<double>(number))) {}
     template <typename T>
-        requires(std::is_integral_v<T> || std::is_floating_point_v<T>)
+        requires(std::is_integral_v<T>)
+    Value(T number)
+    {
+        if (IsInIntRange(number))
+            bits = NAN_BOXING_INT_BITS | ((uint64_t)number & NAN_BOXING_INT_PAYLOAD_MASK);
+        else
+            bits = std::bit_cast<uint64_t>(static_cast<double>(number));
+    }
+    Value() : bits(NAN_BOXING_NIL_BITS) {}
+    Value(bool boolean) : bits(boolean ? NAN_BOXING_TRUE_BITS : NAN_BOXING_FALSE_BITS) {}
+    Value(struct Object *object) : bits(NAN_BOXING_OBJECT_MASK | (uint64_t)(uintptr_t)object) {}
+#else
+    template <typename T>
+        requires(std::is_floating_point_v<T>)
     Value(T number) : stored(static_cast<double>(number)), type(ValueType::NUM) {}
+    template <typename T>
+        requires(std::is_integral_v<T>)
+    Value(T number)
+    {
+        if (IsInIntRange(number))
+        {
+            type = ValueType::INT;
+            integer = static_cast<int64_t>(number);
+        }
+        else
+        {
+            type = ValueType::NUM;
+            stored = static_cast<double>(number);
+        }
+    }
     Value() : type(ValueType::NIL), object(nullptr) {}
     Value(bool boolean) : stored(boolean), type(ValueType::BOOL) {}
     Value(struct Object *object) : object(object), type(ValueType::OBJECT) {}
+#endif
     ~Value() = default;
 
+    template <typename T>
+    static constexpr bool IsInIntRange(T number)
+    {
+        if constexpr (std::is_signed_v<T>)
+            return static_cast<int64_t>(number) >= VALUE_INT_MIN && static_cast<int64_t>(number) <= VALUE_INT_MAX;
+        else
+            return static_cast<uint64_t>(number) <= static_cast<uint64_t>(VALUE_INT_MAX);
+    }
+
+    ValueType Type() const
+    {
+#ifdef COMPUTEDUCK_BUILD_WITH_NAN_BOXING
+        if (IS_DOUBLE_VALUE(*this))
+            return ValueType::NUM;
+        if (IS_INT_VALUE(*this))
+            return ValueType::INT;
+        if (IS_OBJECT_VALUE(*this))
+            return ValueType::OBJECT;
+        if (IS_BOOL_VALUE(*this))
+            return ValueType::BOOL;
+        return ValueType::NIL;
+#else
+        return type;
+#endif
+    }
+
     std::string Stringify() const;
 
     void Mark() const;
     void UnMark() const;
 
+#ifdef COMPUTEDUCK_BUILD_WITH_NAN_BOXING
+    uint64_t bits;
+#else
     ValueType type;
     union
     {
         double stored;
+        int64_t integer;
         struct Object *object{ nullptr };
     };
+#endif
 };
 
+#ifdef COMPUTEDUCK_BUILD_WITH_NAN_BOXING
+static_assert(sizeof(Value) == sizeof(uint64_t), "nan boxed value must be 8 bytes");
+#endif
+
+inline bool IntAddOverflow(int64_t l, int64_t r, int64_t &result)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_add_overflow(l, r, &result);
+#else
+    if ((r > 0 && l > INT64_MAX - r) || (r < 0 && l < INT64_MIN - r))
+        return true;
+    result = l + r;
+    return false;
+#endif
+}
+
+inline bool IntSubOverflow(int64_t l, int64_t r, int64_t &result)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_sub_overflow(l, r, &result);
+#else
+    if ((r < 0 && l > INT64_MAX + r) || (r > 0 && l < INT64_MIN + r))
+        return true;
+    result = l - r;
+    return false;
+#endif
+}
+
+inline bool IntMulOverflow(int64_t l, int64_t r, int64_t &result)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_mul_overflow(l, r, &result);
+#else
+    if (l > 0 ? (r > 0 ? l > INT64_MAX / r : r < INT64_MIN / l) : (r > 0 ? l < INT64_MIN / r : (l != 0 && r < INT64_MAX / l)))
+        return true;
+    result = l * r;
+    return false;
+#endif
+}
+
+// integer arithmetic,an overflowing result is computed in double instead
+inline Value IntAdd(int64_t l, int64_t r)
+{
+    int64_t result;
+    if (IntAddOverflow(l, r, result))
+        return Value((double)l + (double)r);
+    return Value(result);
+}
+
+inline Value IntSub(int64_t l, int64_t r)
+{
+    int64_t result;
+    if (IntSubOverflow(l, r, result))
+        return Value((double)l - (double)r);
+    return Value(result);
+}
+
+inline Value IntMul(int64_t l, int64_t r)
+{
+    int64_t result;
+    if (IntMulOverflow(l, r, result))
+        return Value((double)l * (double)r);
+    // 0 times a negative number is -0,which only a double holds
+    if (result == 0 && (l < 0 || r < 0))
+        return Value(-0.0);
+    return Value(result);
+}
+
+inline Value IntNeg(int64_t v)
+{
+    if (v == 0)
+        return Value(-0.0);
+    return IntSub(0, v);
+}
+
 bool operator==(const Value &left, const Value &right);
 bool operator!=(const Value &left, const Value &right);
 
@@ -67,8 +257,10 @@ extern "C" COMPUTEDUCK_API Value *GetEndOfRefValuePtr(Value *v);
 extern "C" COMPUTEDUCK_API void SetValue(Value* slot,const Value& value);
 
 extern "C" COMPUTEDUCK_API void ValueAdd(const Value &l,const Value& r,Value& result);
-extern "C" COMPUTEDUCK_API double ValueSub(const Value &l, const Value &r);
-extern "C" COMPUTEDUCK_API double ValueMul(const Value &l, const Value &r);
+// adds the operands of a chain of + from left to right,operands[count-1] is the leftmost one(the order they are pushed)
+extern "C" COMPUTEDUCK_API void ValueConcat(const Value *operands, uint8_t count, Value &result);
+extern "C" COMPUTEDUCK_API void ValueSub(const Value &l, const Value &r, Value &result);
+extern "C" COMPUTEDUCK_API void ValueMul(const Value &l, const Value &r, Value &result);
 extern "C" COMPUTEDUCK_API double ValueDiv(const Value &l, const Value &r);
 
 extern "C" COMPUTEDUCK_API bool ValueGreater(const Value &l, const Value &r);
@@ -78,12 +270,12 @@ extern "C" COMPUTEDUCK_API bool ValueEqual(const Value &l, const Value &r);
 extern "C" COMPUTEDUCK_API bool ValueLogicAnd(const Value &l, const Value &r);
 extern "C" COMPUTEDUCK_API bool ValueLogicOr(const Value &l, const Value &r);
 
-extern "C" COMPUTEDUCK_API double ValueBitAnd(const Value &l, const Value &r);
-extern "C" COMPUTEDUCK_API double ValueBitOr(const Value &l, const Value &r);
-extern "C" COMPUTEDUCK_API double ValueBitXor(const Value &l, const Value &r);
+extern "C" COMPUTEDUCK_API int64_t ValueBitAnd(const Value &l, const Value &r);
+extern "C" COMPUTEDUCK_API int64_t ValueBitOr(const Value &l, const Value &r);
+extern "C" COMPUTEDUCK_API int64_t ValueBitXor(const Value &l, const Value &r);
 
 extern "C" COMPUTEDUCK_API bool ValueLogicNot(const Value &l);
-extern "C" COMPUTEDUCK_API double ValueBitNot(const Value &l);
-extern "C" COMPUTEDUCK_API double ValueMinus(const Value &l);
+extern "C" COMPUTEDUCK_API int64_t ValueBitNot(const Value &l);
+extern "C" COMPUTEDUCK_API void ValueMinus(const Value &l, Value &result);
 
 extern "C" COMPUTEDUCK_API void GetArrayObjectElement(const Value& ds, const Value & index,Value& result);
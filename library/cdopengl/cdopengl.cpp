@@ -34,7 +34,7 @@ extern "C" COMPUTEDUCK_API bool BUILTIN_FN(glGenVertexArrays)(Value *args, uint8
     {
         GLuint id = -1;
         glGenVertexArrays(count, &id);
-        ref->stored = id;
+        *ref = Value(id);
         assert(glGetError() == 0);
     }
     else
@@ -65,41 +65,41 @@ extern "C" COMPUTEDUCK_API bool BUILTIN_FN(glVertexAttribPointer)(Value *args, u
     auto arg4 = (GLuint)TO_NUM_VALUE(args[4]);
 
     if (IS_NIL_VALUE(args[5]))
-        glVertexAttribPointer(arg0, arg1, (GLenum)arg2.stored, (GLboolean)arg3.stored, arg4, (void *)0);
+        glVertexAttribPointer(arg0, arg1, (GLenum)TO_NUM_VALUE(arg2), (GLboolean)TO_NUM_VALUE(arg3), arg4, (void *)0);
     else
     {
-        if (arg2.stored == GL_FLOAT)
+        if (TO_NUM_VALUE(arg2) == GL_FLOAT)
         {
             auto arg5 = TO_REF_VALUE(args[5])->pointer;
             auto arrArg5 = TO_ARRAY_VALUE((*arg5));
 
             std::vector<float> rawArg5(arrArg5->len);
             for (int32_t i = 0; i < rawArg5.size(); ++i)
-                rawArg5[i] = (float)arrArg5->elements[i].stored;
+                rawArg5[i] = (float)TO_NUM_VALUE(arrArg5->elements[i]);
 
-            glVertexAttribPointer(arg0, arg1, (GLenum)arg2.stored, (GLboolean)arg3.stored, arg4, (void *)rawArg5.data());
+            glVertexAttribPointer(arg0, arg1, (GLenum)TO_NUM_VALUE(arg2), (GLboolean)TO_NUM_VALUE(arg3), arg4, (void *)rawArg5.data());
         }
-        else if (arg2.stored == GL_UNSIGNED_INT)
+        else if (TO_NUM_VALUE(arg2) == GL_UNSIGNED_INT)
         {
             auto arg5 = TO_REF_VALUE(args[5])->pointer;
             auto arrArg5 = TO_ARRAY_VALUE((*arg5));
 
             std::vector<uint32_t> rawArg5(arrArg5->len);
             for (int32_t i = 0; i < rawArg5.size(); ++i)
-                rawArg5[i] = (uint32_t)arrArg5->elements[i].stored;
+                rawArg5[i] = (uint32_t)TO_NUM_VALUE(arrArg5->elements[i]);
 
-            glVertexAttribPointer(arg0, arg1, (GLenum)arg2.stored, (GLboolean)arg3.stored, arg4, (void *)rawArg5.data());
+            glVertexAttribPointer(arg0, arg1, (GLenum)TO_NUM_VALUE(arg2), (GLboolean)TO_NUM_VALUE(arg3), arg4, (void *)rawArg5.data());
         }
-        else if (arg2.stored == GL_INT)
+        else if (TO_NUM_VALUE(arg2) == GL_INT)
         {
             auto arg5 = TO_REF_VALUE(args[5])->pointer;
             auto arrArg5 = TO_ARRAY_VALUE((*arg5));
 
             std::vector<int32_t> rawArg5(arrArg5->len);
             for (int32_t i = 0; i < rawArg5.size(); ++i)
-                rawArg5[i] = (uint32_t)arrArg5->elements[i].stored;
+                rawArg5[i] = (uint32_t)TO_NUM_VALUE(arrArg5->elements[i]);
 
-            glVertexAttribPointer(arg0, arg1, (GLenum)arg2.stored, (GLboolean)arg3.stored, arg4, (void *)rawArg5.data());
+            glVertexAttribPointer(arg0, arg1, (GLenum)TO_NUM_VALUE(arg2), (GLboolean)TO_NUM_VALUE(arg3), arg4, (void *)rawArg5.data());
         }
     }
     assert(glGetError() == 0);
@@ -139,7 +139,7 @@ extern "C" COMPUTEDUCK_API bool BUILTIN_FN(glGenBuffers)(Value *args, uint8_t ar
     {
         GLuint id = -1;
         glGenBuffers(count, &id);
-        ref->stored = id;
+        *ref = Value(id);
         assert(glGetError() == 0);
     }
     else
@@ -152,7 +152,7 @@ extern "C" COMPUTEDUCK_API bool BUILTIN_FN(glBindBuffer)(Value *args, uint8_t ar
     if (!IS_BUILTIN_VALUE(args[0]) || !IS_NUM_VALUE(args[1]))
         ASSERT("Invalid value of glBindBuffer(args[0],args[1]).");
 
-    auto flag = (GLuint)(TO_BUILTIN_VALUE(args[0])->Get<Value>()).stored;
+    auto flag = (GLuint)TO_NUM_VALUE(TO_BUILTIN_VALUE(args[0])->Get<Value>());
     auto obj = (GLuint)TO_NUM_VALUE(args[1]);
     glBindBuffer(flag, obj);
     assert(glGetError() == 0);
@@ -163,16 +163,16 @@ extern "C" COMPUTEDUCK_API bool BUILTIN_FN(glBufferData)(Value *args, uint8_t ar
     if (!IS_BUILTIN_VALUE(args[0]) || !IS_NUM_VALUE(args[1]) || !IS_ARRAY_VALUE(args[2]) || !IS_BUILTIN_VALUE(args[3]))
         ASSERT("Invalid value of glBufferData(args[0],args[1],args[2],args[3]).");
 
-    auto arg0 = (GLuint)(TO_BUILTIN_VALUE(args[0])->Get<Value>()).stored;
+    auto arg0 = (GLuint)TO_NUM_VALUE(TO_BUILTIN_VALUE(args[0])->Get<Value>());
     auto arg1 = (GLuint)TO_NUM_VALUE(args[1]);
     auto arg2 = TO_ARRAY_VALUE(args[2]);
-    auto arg3 = (GLuint)(TO_BUILTIN_VALUE(args[3])->Get<Value>()).stored;
+    auto arg3 = (GLuint)TO_NUM_VALUE(TO_BUILTIN_VALUE(args[3])->Get<Value>());
 
     if (arg0 == GL_ELEMENT_ARRAY_BUFFER)
     {
         std::vector<uint32_t> rawArg2(arg2->len);
         for (int32_t i = 0; i < rawArg2.size(); ++i)
-            rawArg2[i] = (uint32_t)arg2->elements[i].stored;
+            rawArg2[i] = (uint32_t)TO_NUM_VALUE(arg2->elements[i]);
 
         glBufferData(arg0, arg1, (const void *)rawArg2.data(), arg3);
     }
@@ -180,7 +180,7 @@ extern "C" COMPUTEDUCK_API bool BUILTIN_FN(glBufferData)(Value *args, uint8_t ar
     {
         std::vector<float> rawArg2(arg2->len);
         for (int32_t i = 0; i < rawArg2.size(); ++i)
-            rawArg2[i] = (float)arg2->elements[i].stored;
+            rawArg2[i] = (float)TO_NUM_VALUE(arg2->elements[i]);
 
         glBufferData(arg0, arg1, (const void *)rawArg2.data(), arg3);
     }
@@ -193,7 +193,7 @@ extern "C" COMPUTEDUCK_API bool BUILTIN_FN(glCreateShader)(Value *args, uint8_t
     if (!IS_BUILTIN_VALUE(args[0]))
         ASSERT("Invalid value of glCreateShader(args[0]).");
 
-    auto arg0 = (GLuint)(TO_BUILTIN_VALUE(args[0])->Get<Value>()).stored;
+    auto arg0 = (GLuint)TO_NUM_VALUE(TO_BUILTIN_VALUE(args[0])->Get<Value>());
     result = (double)glCreateShader(arg0);
     assert(glGetError() == 0);
     return true;
@@ -206,9 +206,14 @@ extern "C" COMPUTEDUCK_API bool BUILTIN_FN(glShaderSource)(Value *args, uint8_t
     auto arg0 = (GLuint)TO_NUM_VALUE(args[0]);
     auto arg1 = (GLuint)TO_NUM_VALUE(args[1]);
     auto arg2 = TO_STR_VALUE(*(TO_REF_VALUE(args[2])->pointer))->value;
-    GLint* arg3=nullptr;
-    if(IS_REF_VALUE(args[3]))
-        arg3=(GLint*)&TO_NUM_VALUE(*(TO_REF_VALUE(args[3])->pointer));
+    // the length is a number of the script,it is converted into a GLint that lives through the call
+    GLint length = 0;
+    GLint *arg3 = nullptr;
+    if (IS_REF_VALUE(args[3]))
+    {
+        length = (GLint)TO_NUM_VALUE(*(TO_REF_VALUE(args[3])->pointer));
+        arg3 = &length;
+    }
 
     glShaderSource(arg0, arg1, &arg2, arg3);
     assert(glGetError() == 0);
@@ -293,7 +298,7 @@ extern "C" COMPUTEDUCK_API bool BUILTIN_FN(glClear)(Value *args, uint8_t argCoun
 {
     if (IS_BUILTIN_VALUE(args[0]))
     {
-        auto arg0 = (GLuint)(TO_BUILTIN_VALUE(args[0])->Get<Value>().stored);
+        auto arg0 = (GLuint)TO_NUM_VALUE(TO_BUILTIN_VALUE(args[0])->Get<Value>());
         glClear(arg0);
     }
     else if (IS_NUM_VALUE(args[0]))
@@ -323,9 +328,9 @@ extern "C" COMPUTEDUCK_API bool BUILTIN_FN(glDrawElements)(Value *args, uint8_t
     if (!IS_BUILTIN_VALUE(args[0]) || !IS_NUM_VALUE(args[1]) || !IS_BUILTIN_VALUE(args[2]) || !(IS_REF_VALUE(args[3]) || IS_NIL_VALUE(args[3])))
         ASSERT("Invalid value of glDrawElements(args[0],arg[1],arg[2],arg[3]).");
 
-    auto arg0 = (GLenum)TO_BUILTIN_VALUE(args[0])->Get<Value>().stored;
+    auto arg0 = (GLenum)TO_NUM_VALUE(TO_BUILTIN_VALUE(args[0])->Get<Value>());
     auto arg1 = (GLuint)TO_NUM_VALUE(args[1]);
-    auto arg2 = (GLenum)TO_BUILTIN_VALUE(args[2])->Get<Value>().stored;
+    auto arg2 = (GLenum)TO_NUM_VALUE(TO_BUILTIN_VALUE(args[2])->Get<Value>());
 
     if (IS_NIL_VALUE(args[3]))
         glDrawElements(arg0, arg1, arg2, nullptr);
@@ -336,7 +341,7 @@ extern "C" COMPUTEDUCK_API bool BUILTIN_FN(glDrawElements)(Value *args, uint8_t
 
         std::vector<uint32_t> rawArg3(arrArg3->len);
         for (int32_t i = 0; i < rawArg3.size(); ++i)
-            rawArg3[i] = (uint32_t)arrArg3->elements[i].stored;
+            rawArg3[i] = (uint32_t)TO_NUM_VALUE(arrArg3->elements[i]);
 
         glDrawElements(arg0, arg1, arg2, rawArg3.data());
     }
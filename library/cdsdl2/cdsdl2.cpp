@@ -45,6 +45,7 @@ extern "C" COMPUTEDUCK_API bool BUILTIN_FN(SDL_PollEvent)(Value *args, uint8_t a
         {
             delete (SDL_Event *)nativeData;
         });
+    builtinData->SetExternalBytes(sizeof(SDL_Event));
 
     result = Value(builtinData);
     return true;
@@ -91,7 +92,10 @@ extern "C" COMPUTEDUCK_API bool BUILTIN_FN(SDL_LoadBMP)(Value *args, uint8_t arg
         { SDL_FreeSurface((SDL_Surface *)nativeData); });
 
     if (surface)
+    {
+        resultBuiltinData->SetExternalBytes(sizeof(SDL_Surface) + (size_t)surface->pitch * surface->h);
         result = resultBuiltinData;
+    }
     return true;
 }
 
@@ -108,7 +112,12 @@ extern "C" COMPUTEDUCK_API bool BUILTIN_FN(SDL_CreateTextureFromSurface)(Value *
     BuiltinObject *resultBuiltin = Allocator::GetInstance()->AllocateObject<BuiltinObject>(texture, [](void *nativeData)
         { SDL_DestroyTexture((SDL_Texture *)nativeData); });
 
-    result = resultBuiltin;
+    if (texture)
+    {
+        // the pixels are a copy of the surface
+        resultBuiltin->SetExternalBytes((size_t)surface->pitch * surface->h);
+        result = resultBuiltin;
+    }
     return true;
 }
 
@@ -2,6 +2,8 @@
 #include <string_view>
 #include <filesystem>
 #include <cstring>
+#include <charconv>
+#include <cmath>
 #include "Config.h"
 #include "Allocator.h"
 #include "PreProcessor.h"
@@ -68,6 +70,16 @@ void Repl(std::string_view exePath)
 			return;
 		else if (line == "clear")
 			allLines.clear();
+		else if (line == "-r" || line == "--register")
+			Config::GetInstance()->SetUseRegister(true);
+		else if (line == "-s" || line == "--stack")
+			Config::GetInstance()->SetUseRegister(false);
+		else if (line == "-ics" || line == "--inline-cache-stats")
+			Config::GetInstance()->SetDumpInlineCacheStats(true);
+		else if (line == "-igc" || line == "--incremental-gc")
+			Config::GetInstance()->SetIncrementalGc(true);
+		else if (line == "-gcl" || line == "--gc-log")
+			Config::GetInstance()->SetGcLog(true);
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
 		else if (line == "-nj" || line == "--no-jit")
 			Config::GetInstance()->SetUseJit(false);
@@ -84,6 +96,63 @@ void Repl(std::string_view exePath)
 	}
 }
 
+// the whole string must be a decimal number that fits into uint32_t
+bool ParseUInt32(std::string_view str, uint32_t &value)
+{
+	auto end = str.data() + str.size();
+	auto result = std::from_chars(str.data(), end, value);
+	return result.ec == std::errc() && result.ptr == end;
+}
+
+// the whole string must be a finite decimal number
+bool ParseDouble(std::string_view str, double &value)
+{
+	auto end = str.data() + str.size();
+	auto result = std::from_chars(str.data(), end, value);
+	return result.ec == std::errc() && result.ptr == end && std::isfinite(value);
+}
+
+// a decimal number with an optional K,M or G suffix,like 64M.
+// returns false for any other trailing character or a size that does not fit into size_t
+bool ParseByteSize(std::string_view str, size_t &bytes)
+{
+	auto end = str.data() + str.size();
+	size_t number = 0;
+	auto result = std::from_chars(str.data(), end, number);
+	if (result.ec != std::errc())
+		return false;
+
+	size_t unit = 1;
+	if (result.ptr != end)
+	{
+		if (result.ptr + 1 != end)
+			return false;
+
+		switch (*result.ptr)
+		{
+		case 'k':
+		case 'K':
+			unit = 1024;
+			break;
+		case 'm':
+		case 'M':
+			unit = 1024 * 1024;
+			break;
+		case 'g':
+		case 'G':
+			unit = 1024 * 1024 * 1024;
+			break;
+		default:
+			return false;
+		}
+	}
+
+	if (number > SIZE_MAX / unit)
+		return false;
+	bytes = number * unit;
+	return true;
+}
+
 void RunFile(std::string_view path)
 {
 	SetBasePath(path);
@@ -96,6 +165,17 @@ int32_t PrintUsage()
 	std::cout << "Usage: ComputeDuck [option]:" << std::endl;
 	std::cout << "-h or --help:show usage info." << std::endl;
 	std::cout << "-f or --file:run source file with a valid file path,like : ComputeDuck -f examples/array.cd." << std::endl;
+	std::cout << "-r or --register:compile to register-based bytecode(never jit compiled)" << std::endl;
+	std::cout << "-s or --stack:compile to stack-based bytecode(default)" << std::endl;
+	std::cout << "-ics or --inline-cache-stats:print struct member inline cache hits and misses at exit" << std::endl;
+	std::cout << "-igc or --incremental-gc:collect the old generation in small steps interleaved with allocation" << std::endl;
+	std::cout << "-gcs or --gc-step-budget:work done by one incremental gc step(in object slots,default 256),like : ComputeDuck -igc -gcs 256 -f examples/sdl2.cd" << std::endl;
+	std::cout << "-gct or --gc-threads:threads marking and sweeping during a major collection(default 1,at most the number of cores),like : ComputeDuck -gct 4 -f examples/sdl2.cd" << std::endl;
+	std::cout << "-gcg or --gc-growth:the next major collection runs once the heap grew to the live bytes times this factor(default 2.0)" << std::endl;
+	std::cout << "-gcmin or --gc-min-heap:heap size below which no major collection runs(default 1M),like : ComputeDuck -gcmin 64M -f examples/sdl2.cd" << std::endl;
+	std::cout << "-gcmax or --gc-max-heap:heap cap,exceeding it after a major collection is an out of memory error(default 0:no cap)" << std::endl;
+	std::cout << "-gcl or --gc-log:print one line per gc collection to stderr" << std::endl;
+	std::cout << "-gcj or --gc-stats-json:write gc statistics as json to the file at exit,like : ComputeDuck -gcj gc.json -f examples/sdl2.cd" << std::endl;
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
 	std::cout << "-nj or --no-jit:not use jit compiler" << std::endl;
 	std::cout << "-j or --jit:use jit compiler(default)" << std::endl;
@@ -117,6 +197,74 @@ int32_t main(int argc, const char **argv)
 				return PrintUsage();
 		}
 
+		if (strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--register") == 0)
+			Config::GetInstance()->SetUseRegister(true);
+
+		if (strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--stack") == 0)
+			Config::GetInstance()->SetUseRegister(false);
+
+		if (strcmp(argv[i], "-ics") == 0 || strcmp(argv[i], "--inline-cache-stats") == 0)
+			Config::GetInstance()->SetDumpInlineCacheStats(true);
+
+		if (strcmp(argv[i], "-igc") == 0 || strcmp(argv[i], "--incremental-gc") == 0)
+			Config::GetInstance()->SetIncrementalGc(true);
+
+		if (strcmp(argv[i], "-gcs") == 0 || strcmp(argv[i], "--gc-step-budget") == 0)
+		{
+			uint32_t budget = 0;
+			if (i + 1 < argc && ParseUInt32(argv[++i], budget))
+				Config::GetInstance()->SetGcStepBudget(budget);
+			else
+				return PrintUsage();
+		}
+
+		if (strcmp(argv[i], "-gct") == 0 || strcmp(argv[i], "--gc-threads") == 0)
+		{
+			uint32_t count = 0;
+			if (i + 1 < argc && ParseUInt32(argv[++i], count))
+				Config::GetInstance()->SetGcThreadCount(count);
+			else
+				return PrintUsage();
+		}
+
+		if (strcmp(argv[i], "-gcg") == 0 || strcmp(argv[i], "--gc-growth") == 0)
+		{
+			double factor = 0.0;
+			if (i + 1 < argc && ParseDouble(argv[++i], factor))
+				Config::GetInstance()->SetGcGrowthFactor(factor);
+			else
+				return PrintUsage();
+		}
+
+		if (strcmp(argv[i], "-gcmin") == 0 || strcmp(argv[i], "--gc-min-heap") == 0)
+		{
+			size_t bytes = 0;
+			if (i + 1 < argc && ParseByteSize(argv[++i], bytes))
+				Config::GetInstance()->SetGcMinHeapBytes(bytes);
+			else
+				return PrintUsage();
+		}
+
+		if (strcmp(argv[i], "-gcmax") == 0 || strcmp(argv[i], "--gc-max-heap") == 0)
+		{
+			size_t bytes = 0;
+			if (i + 1 < argc && ParseByteSize(argv[++i], bytes))
+				Config::GetInstance()->SetGcMaxHeapBytes(bytes);
+			else
+				return PrintUsage();
+		}
+
+		if (strcmp(argv[i], "-gcl") == 0 || strcmp(argv[i], "--gc-log") == 0)
+			Config::GetInstance()->SetGcLog(true);
+
+		if (strcmp(argv[i], "-gcj") == 0 || strcmp(argv[i], "--gc-stats-json") == 0)
+		{
+			if (i + 1 < argc)
+				Config::GetInstance()->SetGcStatsPath(argv[++i]);
+			else
+				return PrintUsage();
+		}
+
 #ifdef COMPUTEDUCK_BUILD_WITH_LLVM
 		if (strcmp(argv[i], "-nj") == 0 || strcmp(argv[i], "--no-jit") == 0)
 			Config::GetInstance()->SetUseJit(false);